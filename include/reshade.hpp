@@ -10,7 +10,7 @@
 #include <charconv>
 
 // Current version of the ReShade API
-#define RESHADE_API_VERSION 20
+#define RESHADE_API_VERSION 21
 
 // Optionally import ReShade API functions when 'RESHADE_API_LIBRARY' is defined instead of using header-only mode
 #if defined(RESHADE_API_LIBRARY) || defined(RESHADE_API_LIBRARY_EXPORT)
@@ -651,6 +651,28 @@ namespace reshade::api
 		/// <param name="out_handles">Pointer to the first element of an array (with elements of the size reported by <see cref="device_properties::shader_group_handle_size"/>) that is filled with the handles.</param>
 		/// <returns><see langword="true"/> if the shader group handles were successfully retrieved, <see langword="false"/> otherwise.</returns>
 		virtual bool get_pipeline_shader_group_handles(pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) = 0;
+
+		/// <summary>
+		/// Creates a new pipeline cache, which can be passed to <see cref="create_pipeline"/> via <see cref="pipeline_subobject_type::pipeline_cache"/>.
+		/// </summary>
+		/// <param name="initial_data">Optional pointer to data previously retrieved with <see cref="get_pipeline_cache_data"/> to initialize the cache with. Data that is not compatible with the current driver or device is ignored.</param>
+		/// <param name="initial_data_size">Size of the initial data (in bytes).</param>
+		/// <param name="out_cache">Pointer to a variable that is set to the handle of the created pipeline cache.</param>
+		/// <returns><see langword="true"/> if the pipeline cache was successfully created, <see langword="false"/> otherwise (in which case <paramref name="out_cache"/> is set to zero).</returns>
+		virtual bool create_pipeline_cache(const void *initial_data, size_t initial_data_size, pipeline_cache *out_cache) = 0;
+		/// <summary>
+		/// Instantly destroys a pipeline cache that was previously created via <see cref="create_pipeline_cache"/>.
+		/// </summary>
+		/// <param name="cache">Pipeline cache to destroy.</param>
+		virtual void destroy_pipeline_cache(pipeline_cache cache) = 0;
+		/// <summary>
+		/// Gets the serialized contents of a pipeline cache, so that they can be stored and passed to <see cref="create_pipeline_cache"/> again later.
+		/// </summary>
+		/// <param name="cache">Pipeline cache to query.</param>
+		/// <param name="out_size">Pointer to a variable that is set to the size of the data (in bytes). When <paramref name="out_data"/> is not <see langword="nullptr"/>, this has to be set to the size of that buffer beforehand.</param>
+		/// <param name="out_data">Optional pointer to a buffer that is filled with the data.</param>
+		/// <returns><see langword="true"/> if the data was successfully retrieved, <see langword="false"/> otherwise.</returns>
+		virtual bool get_pipeline_cache_data(pipeline_cache cache, size_t *out_size, void *out_data) = 0;
 	};
 
 	/// <summary>
@@ -1037,6 +1037,12 @@ namespace reshade::api
 		/// Sub-object data is a pointer to a <see cref="pipeline_flags"/> value.
 		/// </summary>
 		flags,
+		/// <summary>
+		/// Pipeline cache to look up the pipeline in before compiling it, and to add it to afterwards.
+		/// Sub-object data is a pointer to a <see cref="pipeline_cache"/> handle.
+		/// </summary>
+		/// <seealso cref="device::create_pipeline_cache"/>
+		pipeline_cache,
 	};
 
 	/// <summary>
@@ -1076,6 +1082,22 @@ namespace reshade::api
 	/// </summary>
 	RESHADE_DEFINE_HANDLE(pipeline);
 
+	/// <summary>
+	/// An opaque handle to a pipeline cache, which holds pipelines compiled by the driver, so that creating them again (possibly in a later session) is faster.
+	/// <para>
+	/// Depending on the graphics API this can be:
+	/// <list type="bullet">
+	/// <item>Direct3D 9: Not supported.</item>
+	/// <item>Direct3D 10: Not supported.</item>
+	/// <item>Direct3D 11: Not supported.</item>
+	/// <item>Direct3D 12: A pointer to a 'ID3D12PipelineLibrary' object.</item>
+	/// <item>OpenGL: Not supported.</item>
+	/// <item>Vulkan: A 'VkPipelineCache' handle.</item>
+	/// </list>
+	/// </para>
+	/// </summary>
+	RESHADE_DEFINE_HANDLE(pipeline_cache);
+
 	/// <summary>
 	/// A constant buffer resource descriptor.
 	/// </summary>
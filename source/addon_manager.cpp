@@ -136,8 +136,9 @@ static const char *addon_event_to_string(reshade::addon_event ev)
 bool reshade::addon_enabled = true;
 #endif
 bool reshade::addon_all_loaded = true;
-std::vector<void *> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
-std::vector<reshade::addon_info> reshade::addon_loaded_info;
+std::vector<reshade::addon_event_callback> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
+uint64_t reshade::addon_event_mask[(static_cast<uint32_t>(reshade::addon_event::max) + 63) / 64] = {};
+std::list<reshade::addon_info> reshade::addon_loaded_info;
 thread_local const reshade::addon_info *reshade::addon_current = nullptr;
 static unsigned long s_reference_count = 0;
 
@@ -190,7 +191,7 @@ void reshade::load_addons()
 #endif
 
 	// Initialize any add-ons that were registered externally
-	const std::vector<addon_info> loaded_info_copy = addon_loaded_info;
+	const std::list<addon_info> loaded_info_copy = addon_loaded_info;
 	for (const addon_info &info : loaded_info_copy)
 	{
 		if (info.handle == nullptr || info.handle == g_module_handle)
@@ -341,7 +342,7 @@ void reshade::unload_addons()
 	// There are no add-ons to unload ...
 #else
 	// Create copy of add-on list before unloading, since add-ons call 'ReShadeUnregisterAddon' during 'FreeLibrary', which modifies the list
-	const std::vector<addon_info> loaded_info_copy = addon_loaded_info;
+	const std::list<addon_info> loaded_info_copy = addon_loaded_info;
 	for (const addon_info &info : loaded_info_copy)
 	{
 		if (info.handle == nullptr || info.handle == g_module_handle)
@@ -382,14 +383,12 @@ void reshade::unload_addons()
 #endif
 
 	// Remove all unloaded add-ons
-	addon_loaded_info.erase(
-		std::remove_if(addon_loaded_info.begin(), addon_loaded_info.end(),
-			[](const addon_info &info) {
-				// There should only be external, disabled and built-in add-ons in the list at this point (any other well behaving add-ons should already have unregistered themselves during unloading)
-				assert(info.external || info.handle == nullptr || info.handle == g_module_handle);
-				return !info.external;
-			}),
-		addon_loaded_info.end());
+	addon_loaded_info.remove_if(
+		[](const addon_info &info) {
+			// There should only be external, disabled and built-in add-ons in the list at this point (any other well behaving add-ons should already have unregistered themselves during unloading)
+			assert(info.external || info.handle == nullptr || info.handle == g_module_handle);
+			return !info.external;
+		});
 }
 
 bool reshade::has_loaded_addons()
@@ -549,7 +548,7 @@ void ReShadeUnregisterAddon(void *module)
 
 	reshade::log::message(reshade::log::level::info, "Unregistered add-on \"%s\".", info->name.c_str());
 
-	reshade::addon_loaded_info.erase(reshade::addon_loaded_info.begin() + (info - reshade::addon_loaded_info.data()));
+	reshade::addon_loaded_info.remove_if([info](const reshade::addon_info &item) { return &item == info; });
 }
 
 void ReShadeRegisterEvent(reshade::addon_event ev, void *callback)
@@ -579,8 +578,10 @@ void ReShadeRegisterEventForAddon(void *module, reshade::addon_event ev, void *c
 	}
 #endif
 
-	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
-	event_list.push_back(callback);
+	// Resolve the owning add-on only once here, so that dispatching events does not have to look it up for every callback invocation
+	std::vector<reshade::addon_event_callback> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
+	event_list.push_back({ callback, info });
+	reshade::addon_event_mask[static_cast<uint32_t>(ev) / 64] |= (1ull << (static_cast<uint32_t>(ev) % 64));
 
 	info->event_callbacks.emplace_back(static_cast<uint32_t>(ev), callback);
 
@@ -608,8 +609,13 @@ void ReShadeUnregisterEventForAddon(void *module, reshade::addon_event ev, void
 		return;
 #endif
 
-	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
-	event_list.erase(std::remove(event_list.begin(), event_list.end(), callback), event_list.end());
+	std::vector<reshade::addon_event_callback> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
+	event_list.erase(std::remove_if(event_list.begin(), event_list.end(),
+		[callback](const reshade::addon_event_callback &item) {
+			return item.callback == callback;
+		}), event_list.end());
+	if (event_list.empty())
+		reshade::addon_event_mask[static_cast<uint32_t>(ev) / 64] &= ~(1ull << (static_cast<uint32_t>(ev) % 64));
 
 	info->event_callbacks.erase(std::remove(info->event_callbacks.begin(), info->event_callbacks.end(), std::make_pair(static_cast<uint32_t>(ev), callback)), info->event_callbacks.end());
 
@@ -7,6 +7,7 @@
 
 #include "addon.hpp"
 #include "reshade_events.hpp"
+#include <list>
 
 #if RESHADE_ADDON
 
@@ -20,15 +21,30 @@ namespace reshade
 #endif
 	extern bool addon_all_loaded;
 
+	/// <summary>
+	/// An add-on event callback together with the add-on that registered it.
+	/// </summary>
+	struct addon_event_callback
+	{
+		void *callback;
+		const addon_info *owner;
+	};
+
 	/// <summary>
 	/// List of add-on event callbacks.
 	/// </summary>
-	extern std::vector<void *> addon_event_list[];
+	extern std::vector<addon_event_callback> addon_event_list[];
+	/// <summary>
+	/// Bit mask of events that have at least one callback registered (one bit per event in <see cref="addon_event_list"/>).
+	/// This is checked before every event invocation in hot paths, so keep it in a few contiguous cache lines instead of touching the individual lists.
+	/// </summary>
+	extern uint64_t addon_event_mask[];
 
 	/// <summary>
 	/// List of currently loaded add-ons.
+	/// This is a linked list, so that pointers to its elements stay valid while add-ons are added or removed (they are referenced by <see cref="addon_event_list"/>).
 	/// </summary>
-	extern std::vector<addon_info> addon_loaded_info;
+	extern std::list<addon_info> addon_loaded_info;
 
 	/// <summary>
 	/// Pointer to the add-on that is currently executing.
@@ -61,7 +77,7 @@ namespace reshade
 	template <addon_event ev>
 	bool has_addon_event()
 	{
-		return !addon_event_list[static_cast<uint32_t>(ev)].empty();
+		return (addon_event_mask[static_cast<uint32_t>(ev) / 64] & (1ull << (static_cast<uint32_t>(ev) % 64))) != 0;
 	}
 
 	/// <summary>
@@ -115,7 +131,7 @@ namespace reshade
 		if (!addon_enabled)
 			return;
 #endif
-		const std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
+		const std::vector<addon_event_callback> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
 		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb) // Generates better code than ranged-based for loop
 		{
 			bool first_invocation = false;
@@ -131,16 +147,16 @@ namespace reshade
 				// Prevent recursive invocation of events
 				if (nullptr == addon_current)
 				{
-					addon_current = find_addon(event_list[cb]);
+					addon_current = event_list[cb].owner;
 					first_invocation = true;
 				}
-				else if (find_addon(event_list[cb]) == addon_current)
+				else if (event_list[cb].owner == addon_current)
 				{
 					continue;
 				}
 			}
 
-			reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...);
+			reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb].callback)(std::forward<Args>(args)...);
 
 			if (first_invocation)
 				addon_current = nullptr;
@@ -179,17 +195,17 @@ namespace reshade
 			return false;
 #endif
 		bool skip = false;
-		const std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
+		const std::vector<addon_event_callback> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
 		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb)
 		{
 			if constexpr (
 				ev == addon_event::begin_render_pass ||
 				ev == addon_event::end_render_pass)
 			{
-				if (find_addon(event_list[cb])->api_version < 20)
+				if (event_list[cb].owner->api_version < 20)
 				{
 					// In older ABI versions these still had a void return type, so ignore and do not skip
-					reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...);
+					reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb].callback)(std::forward<Args>(args)...);
 					continue;
 				}
 			}
@@ -207,16 +223,16 @@ namespace reshade
 				// Prevent recursive invocation of events
 				if (nullptr == addon_current)
 				{
-					addon_current = find_addon(event_list[cb]);
+					addon_current = event_list[cb].owner;
 					first_invocation = true;
 				}
-				else if (find_addon(event_list[cb]) == addon_current)
+				else if (event_list[cb].owner == addon_current)
 				{
 					continue;
 				}
 			}
 
-			if (reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...))
+			if (reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb].callback)(std::forward<Args>(args)...))
 				skip = true;
 
 			if (first_invocation)
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#include "buffer_pool.hpp"
+#include <cassert>
+#include <algorithm> // std::find_if, std::max
+
+reshade::buffer_pool::buffer_pool(size_t max_buffers) :
+	_max_buffers(std::max<size_t>(max_buffers, 1))
+{
+}
+
+size_t reshade::buffer_pool::num_buffers_in_use() const
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	return _num_buffers_in_use;
+}
+
+bool reshade::buffer_pool::try_acquire(size_t size, std::vector<uint8_t> &buffer)
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	return try_acquire_locked(size, buffer);
+}
+void reshade::buffer_pool::acquire(size_t size, std::vector<uint8_t> &buffer)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_released_condition.wait(lock, [this]() { return _num_buffers_in_use < _max_buffers; });
+
+	try_acquire_locked(size, buffer);
+}
+bool reshade::buffer_pool::try_acquire_locked(size_t size, std::vector<uint8_t> &buffer)
+{
+	if (_num_buffers_in_use >= _max_buffers)
+		return false;
+
+	_num_buffers_in_use++;
+
+	// Prefer a buffer that is large enough already, so that it does not have to be reallocated
+	auto buffer_it = std::find_if(_free_buffers.begin(), _free_buffers.end(),
+		[size](const std::vector<uint8_t> &free_buffer) { return free_buffer.capacity() >= size; });
+	if (buffer_it == _free_buffers.end() && !_free_buffers.empty())
+		buffer_it = _free_buffers.begin();
+
+	if (buffer_it != _free_buffers.end())
+	{
+		buffer = std::move(*buffer_it);
+		_free_buffers.erase(buffer_it);
+	}
+	else
+	{
+		buffer.clear();
+	}
+
+	buffer.resize(size);
+
+	return true;
+}
+
+void reshade::buffer_pool::release(std::vector<uint8_t> &buffer)
+{
+	{	const std::lock_guard<std::mutex> lock(_mutex);
+
+		assert(_num_buffers_in_use != 0);
+		_num_buffers_in_use--;
+
+		_free_buffers.push_back(std::move(buffer));
+	}
+	_released_condition.notify_one();
+
+	buffer = {};
+}
+
+void reshade::buffer_pool::trim()
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_free_buffers.clear();
+	_free_buffers.shrink_to_fit();
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// A fixed number of reusable byte buffers, shared between a producer and consumers on other threads.
+	/// Since no more than the maximum number of buffers can be in use at once, this puts an upper bound on the memory used by work queued up for the consumers.
+	/// </summary>
+	class buffer_pool
+	{
+	public:
+		/// <summary>
+		/// Creates a new pool. Buffers are only allocated once they are first acquired.
+		/// </summary>
+		/// <param name="max_buffers">Maximum number of buffers that may be in use at the same time.</param>
+		explicit buffer_pool(size_t max_buffers);
+
+		/// <summary>
+		/// Gets the maximum number of buffers that may be in use at the same time.
+		/// </summary>
+		size_t max_buffers() const { return _max_buffers; }
+		/// <summary>
+		/// Gets the number of buffers that are currently in use.
+		/// </summary>
+		size_t num_buffers_in_use() const;
+
+		/// <summary>
+		/// Takes a buffer out of the pool, without blocking.
+		/// </summary>
+		/// <param name="size">Size in bytes the buffer is resized to. Contents of reused buffers are not cleared.</param>
+		/// <param name="buffer">Receives the buffer, which has to be passed to <see cref="release"/> again once it is no longer needed.</param>
+		/// <returns><see langword="true"/> if a buffer was available, <see langword="false"/> if all buffers are in use.</returns>
+		bool try_acquire(size_t size, std::vector<uint8_t> &buffer);
+		/// <summary>
+		/// Takes a buffer out of the pool, blocking until another thread releases one if all buffers are in use.
+		/// </summary>
+		/// <param name="size">Size in bytes the buffer is resized to. Contents of reused buffers are not cleared.</param>
+		/// <param name="buffer">Receives the buffer, which has to be passed to <see cref="release"/> again once it is no longer needed.</param>
+		void acquire(size_t size, std::vector<uint8_t> &buffer);
+		/// <summary>
+		/// Returns a buffer that was previously acquired to the pool, so that its memory can be reused.
+		/// </summary>
+		void release(std::vector<uint8_t> &buffer);
+
+		/// <summary>
+		/// Frees the memory of all buffers that are currently not in use.
+		/// </summary>
+		void trim();
+
+	private:
+		bool try_acquire_locked(size_t size, std::vector<uint8_t> &buffer);
+
+		const size_t _max_buffers;
+		size_t _num_buffers_in_use = 0;
+		std::vector<std::vector<uint8_t>> _free_buffers;
+		mutable std::mutex _mutex;
+		std::condition_variable _released_condition;
+	};
+}
@@ -1127,6 +1127,8 @@ bool reshade::d3d11::device_impl::create_pipeline(api::pipeline_layout, uint32_t
 						state != api::dynamic_state::back_stencil_reference_value)
 						goto exit_failure;
 				break;
+			case api::pipeline_subobject_type::pipeline_cache:
+				break; // Ignored, since pipelines cannot be cached
 			case api::pipeline_subobject_type::max_vertex_count:
 				assert(subobjects[i].count == 1);
 				break; // Ignored
@@ -1669,3 +1671,18 @@ bool reshade::d3d11::device_impl::get_pipeline_shader_group_handles(api::pipelin
 {
 	return false;
 }
+
+bool reshade::d3d11::device_impl::create_pipeline_cache(const void *, size_t, api::pipeline_cache *out_cache)
+{
+	*out_cache = { 0 };
+	return false;
+}
+void reshade::d3d11::device_impl::destroy_pipeline_cache(api::pipeline_cache cache)
+{
+	assert(cache == 0);
+}
+bool reshade::d3d11::device_impl::get_pipeline_cache_data(api::pipeline_cache, size_t *out_size, void *)
+{
+	*out_size = 0;
+	return false;
+}
@@ -92,5 +92,9 @@ namespace reshade::d3d11
 		void get_acceleration_structure_size(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, uint64_t *out_size, uint64_t *out_build_scratch_size, uint64_t *out_update_scratch_size) const final;
 
 		bool get_pipeline_shader_group_handles(api::pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) final;
+
+		bool create_pipeline_cache(const void *initial_data, size_t initial_data_size, api::pipeline_cache *out_cache) final;
+		void destroy_pipeline_cache(api::pipeline_cache cache) final;
+		bool get_pipeline_cache_data(api::pipeline_cache cache, size_t *out_size, void *out_data) final;
 	};
 }
@@ -63,6 +63,46 @@ static auto adapter_from_device(ID3D12Device *device, DXGI_ADAPTER_DESC *adapter
 	return dxgi_adapter;
 }
 
+static void hash_pipeline_data(uint64_t &hash, const void *data, size_t size)
+{
+	// FNV-1a hash
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ static_cast<const uint8_t *>(data)[i]) * 1099511628211ull;
+}
+static std::wstring pipeline_library_name(D3D12_SHADER_BYTECODE shader)
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash_pipeline_data(hash, shader.pShaderBytecode, shader.BytecodeLength);
+
+	return L"Compute" + std::to_wstring(hash);
+}
+static std::wstring pipeline_library_name(D3D12_GRAPHICS_PIPELINE_STATE_DESC desc)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (D3D12_SHADER_BYTECODE *const shader : { &desc.VS, &desc.PS, &desc.DS, &desc.HS, &desc.GS })
+	{
+		hash_pipeline_data(hash, shader->pShaderBytecode, shader->BytecodeLength);
+		shader->pShaderBytecode = nullptr;
+	}
+	for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+	{
+		D3D12_INPUT_ELEMENT_DESC element = desc.InputLayout.pInputElementDescs[i];
+		hash_pipeline_data(hash, element.SemanticName, std::strlen(element.SemanticName));
+		element.SemanticName = nullptr;
+		hash_pipeline_data(hash, &element, sizeof(element));
+	}
+
+	// Pointers are different every run, so exclude them (the pipeline library validates that the description used to load a pipeline matches the stored one, including the root signature)
+	desc.pRootSignature = nullptr;
+	desc.InputLayout.pInputElementDescs = nullptr;
+	desc.StreamOutput.pSODeclaration = nullptr;
+	desc.StreamOutput.pBufferStrides = nullptr;
+	desc.CachedPSO = {};
+	hash_pipeline_data(hash, &desc, sizeof(desc));
+
+	return L"Graphics" + std::to_wstring(hash);
+}
+
 reshade::d3d12::device_impl::device_impl(ID3D12Device *device) :
 	api_object_impl(device),
 	_view_heaps {
@@ -850,6 +890,7 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 	uint32_t max_attribute_size = 2 * sizeof(float); // Default triangle attributes
 	uint32_t max_recursion_depth = 1;
 	api::pipeline_flags flags = api::pipeline_flags::none;
+	api::pipeline_cache cache = { 0 };
 	bool ray_tracing = false;
 
 	for (uint32_t i = 0; i < subobject_count; ++i)
@@ -1002,12 +1043,18 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 			assert(subobjects[i].count == 1);
 			flags = *static_cast<const api::pipeline_flags *>(subobjects[i].data);
 			break;
+		case api::pipeline_subobject_type::pipeline_cache:
+			assert(subobjects[i].count == 1);
+			cache = *static_cast<const api::pipeline_cache *>(subobjects[i].data);
+			break;
 		default:
 			assert(false);
 			goto exit_failure;
 		}
 	}
 
+	const auto library = reinterpret_cast<ID3D12PipelineLibrary *>(cache.handle);
+
 	if (ray_tracing || !raygen_desc.empty() || !shader_groups.empty())
 	{
 		com_ptr<ID3D12Device5> device5;
@@ -1187,9 +1234,16 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 		internal_desc.pRootSignature = reinterpret_cast<ID3D12RootSignature *>(layout.handle);
 		convert_shader_desc(cs_desc, internal_desc.CS);
 
+		const std::wstring library_name = library != nullptr ? pipeline_library_name(internal_desc.CS) : std::wstring();
+
 		if (com_ptr<ID3D12PipelineState> pipeline;
+			(library != nullptr && SUCCEEDED(library->LoadComputePipeline(library_name.c_str(), &internal_desc, IID_PPV_ARGS(&pipeline)))) ||
 			SUCCEEDED(_orig->CreateComputePipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
 		{
+			// Storing fails if a pipeline with the same name already exists in the library, which is fine to ignore
+			if (library != nullptr)
+				library->StorePipeline(library_name.c_str(), pipeline.get());
+
 			*out_pipeline = to_handle(pipeline.release());
 			return true;
 		}
@@ -1290,9 +1344,15 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 
 		internal_desc.SampleDesc.Count = sample_count;
 
+		const std::wstring library_name = library != nullptr ? pipeline_library_name(internal_desc) : std::wstring();
+
 		if (com_ptr<ID3D12PipelineState> pipeline;
+			(library != nullptr && SUCCEEDED(library->LoadGraphicsPipeline(library_name.c_str(), &internal_desc, IID_PPV_ARGS(&pipeline)))) ||
 			SUCCEEDED(_orig->CreateGraphicsPipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
 		{
+			if (library != nullptr)
+				library->StorePipeline(library_name.c_str(), pipeline.get());
+
 			pipeline_extra_data extra_data;
 			extra_data.topology = convert_primitive_topology(topology);
 			std::copy_n(blend_desc.blend_constant, 4, extra_data.blend_constant);
@@ -2103,6 +2163,85 @@ bool reshade::d3d12::device_impl::get_pipeline_shader_group_handles(api::pipelin
 	return true;
 }
 
+bool reshade::d3d12::device_impl::create_pipeline_cache(const void *initial_data, size_t initial_data_size, api::pipeline_cache *out_cache)
+{
+	*out_cache = { 0 };
+
+	com_ptr<ID3D12Device1> device1;
+	if (FAILED(_orig->QueryInterface(&device1)))
+		return false;
+
+	// The pipeline library references the serialized data for its entire lifetime, so keep a copy of it around
+	pipeline_cache_extra_data extra_data;
+	extra_data.serialized_data = nullptr;
+	if (initial_data_size != 0)
+	{
+		extra_data.serialized_data = new uint8_t[initial_data_size];
+		std::memcpy(extra_data.serialized_data, initial_data, initial_data_size);
+	}
+
+	com_ptr<ID3D12PipelineLibrary> library;
+	HRESULT hr = device1->CreatePipelineLibrary(extra_data.serialized_data, initial_data_size, IID_PPV_ARGS(&library));
+	if (FAILED(hr) && initial_data_size != 0)
+	{
+		// Serialized data is invalidated by driver updates or when switching adapters, so start over with an empty library in that case
+		delete[] extra_data.serialized_data;
+		extra_data.serialized_data = nullptr;
+
+		hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library));
+	}
+
+	if (FAILED(hr))
+	{
+		delete[] extra_data.serialized_data;
+		return false;
+	}
+
+	library->SetPrivateData(extra_data_guid, sizeof(extra_data), &extra_data);
+
+	*out_cache = to_handle(library.release());
+	return true;
+}
+void reshade::d3d12::device_impl::destroy_pipeline_cache(api::pipeline_cache cache)
+{
+	if (cache == 0)
+		return;
+
+	const auto library = reinterpret_cast<ID3D12PipelineLibrary *>(cache.handle);
+
+	pipeline_cache_extra_data extra_data;
+	UINT extra_data_size = sizeof(extra_data);
+	if (FAILED(library->GetPrivateData(extra_data_guid, &extra_data_size, &extra_data)))
+		extra_data.serialized_data = nullptr;
+
+	library->Release();
+
+	delete[] extra_data.serialized_data;
+}
+bool reshade::d3d12::device_impl::get_pipeline_cache_data(api::pipeline_cache cache, size_t *out_size, void *out_data)
+{
+	assert(cache != 0 && out_size != nullptr);
+
+	const auto library = reinterpret_cast<ID3D12PipelineLibrary *>(cache.handle);
+
+	const size_t size = library->GetSerializedSize();
+
+	if (out_data == nullptr)
+	{
+		*out_size = size;
+		return true;
+	}
+
+	if (*out_size < size)
+	{
+		*out_size = size;
+		return false;
+	}
+
+	*out_size = size;
+	return SUCCEEDED(library->Serialize(out_data, size));
+}
+
 void reshade::d3d12::device_impl::register_resource(ID3D12Resource *resource, [[maybe_unused]] bool acceleration_structure)
 {
 	assert(resource != nullptr);
@@ -33,6 +33,11 @@ namespace reshade::d3d12
 		const std::pair<D3D12_DESCRIPTOR_HEAP_TYPE, UINT> *ranges;
 	};
 
+	struct pipeline_cache_extra_data
+	{
+		uint8_t *serialized_data;
+	};
+
 	struct query_heap_extra_data
 	{
 		UINT count;
@@ -184,6 +189,7 @@ namespace reshade::d3d12
 	inline auto to_handle(ID3D12PipelineState *ptr) { return api::pipeline { reinterpret_cast<uintptr_t>(ptr) }; }
 	inline auto to_handle(ID3D12StateObject *ptr) { return api::pipeline { reinterpret_cast<uintptr_t>(ptr) }; }
 	inline auto to_handle(ID3D12RootSignature *ptr) { return api::pipeline_layout { reinterpret_cast<uintptr_t>(ptr) }; }
+	inline auto to_handle(ID3D12PipelineLibrary *ptr) { return api::pipeline_cache { reinterpret_cast<uintptr_t>(ptr) }; }
 	inline auto to_handle(ID3D12QueryHeap *ptr) { return api::query_heap { reinterpret_cast<uintptr_t>(ptr) }; }
 	inline auto to_handle(ID3D12DescriptorHeap *ptr) { return api::descriptor_heap { reinterpret_cast<uintptr_t>(ptr) }; }
 	inline auto to_handle(ID3D12Fence *ptr) { return api::fence { reinterpret_cast<uintptr_t>(ptr) }; }
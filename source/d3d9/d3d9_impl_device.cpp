@@ -1345,6 +1345,8 @@ bool reshade::d3d9::device_impl::create_pipeline(api::pipeline_layout, uint32_t
 				break;
 			case api::pipeline_subobject_type::dynamic_pipeline_states:
 				break; // Ignored
+			case api::pipeline_subobject_type::pipeline_cache:
+				break; // Ignored, since pipelines cannot be cached
 			case api::pipeline_subobject_type::max_vertex_count:
 				max_vertices = *static_cast<const uint32_t *>(subobjects[i].data);
 				break;
@@ -1841,6 +1843,21 @@ bool reshade::d3d9::device_impl::get_pipeline_shader_group_handles(api::pipeline
 	return false;
 }
 
+bool reshade::d3d9::device_impl::create_pipeline_cache(const void *, size_t, api::pipeline_cache *out_cache)
+{
+	*out_cache = { 0 };
+	return false;
+}
+void reshade::d3d9::device_impl::destroy_pipeline_cache(api::pipeline_cache cache)
+{
+	assert(cache == 0);
+}
+bool reshade::d3d9::device_impl::get_pipeline_cache_data(api::pipeline_cache, size_t *out_size, void *)
+{
+	*out_size = 0;
+	return false;
+}
+
 HRESULT reshade::d3d9::device_impl::create_surface_replacement(const D3DSURFACE_DESC &desc, IDirect3DSurface9 **out_surface, HANDLE *out_shared_handle)
 {
 	// Cannot create multisampled textures
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_cache_index.hpp"
+#include "effect_file_cache.hpp"
+#include <mutex>
+#include <cstdio> // fclose, fopen, fread, fseek, fwrite
+#include <cstdlib> // std::strtoll, std::strtoull
+
+#ifndef _WIN32
+	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
+	#define u8path(p) path(p)
+	#define u8string() string()
+#endif
+
+static bool read_file(const std::filesystem::path &path, std::string &file_data)
+{
+#ifndef _WIN32
+	FILE *const file = fopen(path.c_str(), "rb");
+#else
+	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYWR);
+#endif
+	if (file == nullptr)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	const size_t file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	file_data.resize(file_size);
+	const size_t file_size_read = fread(file_data.data(), 1, file_size, file);
+
+	fclose(file);
+
+	return file_size_read == file_size;
+}
+
+bool reshadefx::effect_cache_index::load(const std::filesystem::path &path)
+{
+	std::string data;
+	if (!read_file(path, data))
+		return false;
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_entries.clear();
+	_modified = false;
+
+	entry *current_entry = nullptr;
+
+	for (size_t offset = 0, next; offset < data.size(); offset = next + 1)
+	{
+		next = data.find('\n', offset);
+		if (next == std::string::npos)
+			next = data.size();
+
+		std::string_view line(data.data() + offset, next - offset);
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+
+		if (line.empty() || line[0] == ';')
+			continue;
+
+		if (line[0] == '[' && line.back() == ']')
+		{
+			current_entry = &_entries[std::string(line.substr(1, line.size() - 2))];
+			continue;
+		}
+
+		if (current_entry == nullptr)
+			continue;
+
+		if (line.compare(0, 5, "file=") == 0)
+		{
+			// Format is "file=<content hash>,<file size>,<last write time>,<path>", with the path last so that it may contain commas
+			line.remove_prefix(5);
+
+			std::string fields(line);
+			char *next_field = fields.data();
+
+			dependency &dependency = current_entry->dependencies.emplace_back();
+			dependency.content_hash = static_cast<size_t>(std::strtoull(next_field, &next_field, 16));
+			if (*next_field++ != ',')
+				goto invalid_entry;
+			dependency.file_size = static_cast<uintmax_t>(std::strtoull(next_field, &next_field, 10));
+			if (*next_field++ != ',')
+				goto invalid_entry;
+			dependency.last_write_time = static_cast<int64_t>(std::strtoll(next_field, &next_field, 10));
+			if (*next_field++ != ',')
+				goto invalid_entry;
+			dependency.path = std::filesystem::u8path(next_field);
+			continue;
+
+		invalid_entry:
+			// Drop the entire entry, which forces the effect to be recompiled
+			current_entry->dependencies.clear();
+			current_entry->definitions.clear();
+			current_entry = nullptr;
+		}
+		else if (line.compare(0, 7, "define=") == 0)
+		{
+			line.remove_prefix(7);
+
+			if (const size_t equals_index = line.find('=');
+				equals_index != std::string_view::npos)
+				current_entry->definitions.emplace_back(line.substr(0, equals_index), line.substr(equals_index + 1));
+		}
+	}
+
+	// Remove entries that were dropped because they were invalid
+	for (auto it = _entries.begin(); it != _entries.end();)
+	{
+		if (it->second.dependencies.empty())
+			it = _entries.erase(it);
+		else
+			++it;
+	}
+
+	return true;
+}
+bool reshadefx::effect_cache_index::save(const std::filesystem::path &path)
+{
+	std::string data;
+
+	{	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+		// Clear the flag while holding the lock, so that changes made after the snapshot was taken mark the index as modified again
+		_modified = false;
+
+		data += "; ReShade effect cache index, generated automatically\n";
+
+		for (const std::pair<const std::string, entry> &entry : _entries)
+		{
+			data += '[' + entry.first + "]\n";
+
+			for (const dependency &dependency : entry.second.dependencies)
+			{
+				char hash_string[17];
+				std::snprintf(hash_string, sizeof(hash_string), "%llx", static_cast<unsigned long long>(dependency.content_hash));
+
+				data += "file=";
+				data += hash_string;
+				data += ',' + std::to_string(dependency.file_size);
+				data += ',' + std::to_string(dependency.last_write_time);
+				data += ',' + dependency.path.u8string() + '\n';
+			}
+
+			for (const std::pair<std::string, std::string> &definition : entry.second.definitions)
+			{
+				data += "define=" + definition.first + '=' + definition.second + '\n';
+			}
+		}
+	}
+
+#ifndef _WIN32
+	FILE *const file = fopen(path.c_str(), "wb");
+#else
+	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYWR);
+#endif
+	if (file == nullptr)
+	{
+		_modified = true;
+		return false;
+	}
+
+	const size_t data_size_written = fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+
+	if (data_size_written != data.size())
+	{
+		_modified = true;
+		return false;
+	}
+
+	return true;
+}
+
+void reshadefx::effect_cache_index::clear()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_modified = !_entries.empty();
+	_entries.clear();
+}
+
+bool reshadefx::effect_cache_index::validate(const std::string &key, size_t &dependencies_hash, std::vector<std::pair<std::string, std::string>> *definitions, std::vector<std::filesystem::path> *files)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	const auto it = _entries.find(key);
+	if (it == _entries.end())
+		return false;
+
+	entry &entry = it->second;
+
+	for (dependency &recorded_dependency : entry.dependencies)
+	{
+		std::error_code ec;
+		const int64_t last_write_time = std::filesystem::last_write_time(recorded_dependency.path, ec).time_since_epoch().count();
+		if (ec)
+			return false; // File no longer exists
+		const uintmax_t file_size = std::filesystem::file_size(recorded_dependency.path, ec);
+		if (ec)
+			return false;
+
+		if (last_write_time == recorded_dependency.last_write_time && file_size == recorded_dependency.file_size)
+			continue;
+
+		// File was touched, so check whether its contents actually changed
+		dependency current_dependency = { recorded_dependency.path };
+		if (!read_dependency(current_dependency) || current_dependency.content_hash != recorded_dependency.content_hash)
+			return false;
+
+		recorded_dependency = std::move(current_dependency);
+		_modified = true;
+	}
+
+	dependencies_hash = combine_hashes(entry);
+
+	if (definitions != nullptr)
+		*definitions = entry.definitions;
+
+	if (files != nullptr)
+	{
+		files->clear();
+		for (const dependency &dependency : entry.dependencies)
+			files->push_back(dependency.path);
+	}
+
+	return true;
+}
+
+size_t reshadefx::effect_cache_index::update(const std::string &key, const std::vector<std::filesystem::path> &files, const std::vector<std::pair<std::string, std::string>> &definitions)
+{
+	entry new_entry;
+	new_entry.dependencies.reserve(files.size());
+	for (const std::filesystem::path &file : files)
+	{
+		dependency &dependency = new_entry.dependencies.emplace_back();
+		dependency.path = file;
+		// Keep entry even if reading failed, in which case the hash will simply not match next time around
+		read_dependency(dependency);
+	}
+
+	for (const std::pair<std::string, std::string> &definition : definitions)
+	{
+		// Skip definitions that cannot be represented in the line-based manifest format
+		if (definition.first.find_first_of("=\n") != std::string::npos || definition.second.find('\n') != std::string::npos)
+			continue;
+
+		new_entry.definitions.push_back(definition);
+	}
+
+	const size_t dependencies_hash = combine_hashes(new_entry);
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_entries[key] = std::move(new_entry);
+	_modified = true;
+
+	return dependencies_hash;
+}
+
+size_t reshadefx::effect_cache_index::combine_hashes(const entry &entry)
+{
+	size_t hash = entry.dependencies.size();
+	for (const dependency &dependency : entry.dependencies)
+		hash ^= dependency.content_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+bool reshadefx::effect_cache_index::read_dependency(dependency &dependency)
+{
+	std::error_code ec;
+	dependency.last_write_time = std::filesystem::last_write_time(dependency.path, ec).time_since_epoch().count();
+	if (ec)
+		return false;
+	// Record the size on disk, since the cached contents are normalized and would therefore never match it during validation
+	dependency.file_size = std::filesystem::file_size(dependency.path, ec);
+	if (ec)
+		return false;
+
+	// Dependencies are usually read by the pre-processor right afterwards (or were just before), so share the contents with it
+	const std::shared_ptr<const std::string> file_data = file_cache::instance().read(dependency.path);
+	if (file_data == nullptr)
+		return false;
+
+	dependency.content_hash = std::hash<std::string>()(*file_data);
+	return true;
+}
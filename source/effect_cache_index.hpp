@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace reshadefx
+{
+	/// <summary>
+	/// A persistent index of the files and macros each compiled effect permutation depends on, used to decide whether cached compilation results are still valid.
+	/// </summary>
+	class effect_cache_index
+	{
+	public:
+		/// <summary>
+		/// A single file an effect depends on, identified by a hash of its contents.
+		/// </summary>
+		struct dependency
+		{
+			std::filesystem::path path;
+			int64_t last_write_time = 0;
+			uintmax_t file_size = 0;
+			size_t content_hash = 0;
+		};
+
+		/// <summary>
+		/// Dependency information recorded for a single effect permutation.
+		/// </summary>
+		struct entry
+		{
+			std::vector<dependency> dependencies;
+			std::vector<std::pair<std::string, std::string>> definitions;
+		};
+
+		/// <summary>
+		/// Reads the index from the specified manifest file, replacing all current entries.
+		/// </summary>
+		/// <param name="path">Path to the manifest file to read.</param>
+		/// <returns><see langword="true"/> if the file was read successfully, <see langword="false"/> otherwise.</returns>
+		bool load(const std::filesystem::path &path);
+		/// <summary>
+		/// Writes the index to the specified manifest file.
+		/// </summary>
+		/// <param name="path">Path to the manifest file to write.</param>
+		/// <returns><see langword="true"/> if the file was written successfully, <see langword="false"/> otherwise.</returns>
+		bool save(const std::filesystem::path &path);
+
+		/// <summary>
+		/// Removes all entries from the index.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Gets a boolean indicating whether the index was changed since it was last loaded or saved.
+		/// </summary>
+		bool is_modified() const { return _modified; }
+
+		/// <summary>
+		/// Checks whether all files recorded for the specified key are unchanged since they were recorded.
+		/// Files whose modification time changed are hashed again, so that touching a file without changing its contents does not invalidate anything.
+		/// </summary>
+		/// <param name="key">Key identifying the effect permutation.</param>
+		/// <param name="dependencies_hash">Set to a hash of the contents of all dependencies on success.</param>
+		/// <param name="definitions">Optional pointer set to the macro definitions recorded for this key on success.</param>
+		/// <param name="files">Optional pointer set to the paths of all files recorded for this key on success.</param>
+		/// <returns><see langword="true"/> if an entry exists and all its dependencies are unchanged, <see langword="false"/> otherwise.</returns>
+		bool validate(const std::string &key, size_t &dependencies_hash, std::vector<std::pair<std::string, std::string>> *definitions = nullptr, std::vector<std::filesystem::path> *files = nullptr);
+
+		/// <summary>
+		/// Records the dependencies of the specified key, replacing any previous entry.
+		/// </summary>
+		/// <param name="key">Key identifying the effect permutation.</param>
+		/// <param name="files">List of all files that were read while pre-processing the effect (including the effect file itself).</param>
+		/// <param name="definitions">List of macro definitions the effect made use of (see <see cref="preprocessor::used_macro_definitions"/>).</param>
+		/// <returns>A hash of the contents of all dependencies.</returns>
+		size_t update(const std::string &key, const std::vector<std::filesystem::path> &files, const std::vector<std::pair<std::string, std::string>> &definitions);
+
+	private:
+		static size_t combine_hashes(const entry &entry);
+		static bool read_dependency(dependency &dependency);
+
+		std::shared_mutex _mutex;
+		std::unordered_map<std::string, entry> _entries;
+		std::atomic<bool> _modified = false;
+	};
+}
@@ -10,6 +10,7 @@
 #include <charconv> // std::from_chars
 #include <algorithm> // std::find_if, std::max, std::sort
 #include <unordered_set>
+#include <memory_resource>
 
 // Use the C++ variant of the SPIR-V headers
 #include <spirv.hpp>
@@ -25,6 +26,19 @@ inline uint32_t align_up(uint32_t size, uint32_t alignment)
 	return ((size + alignment) & ~alignment);
 }
 
+inline void hash_combine(size_t &hash, size_t value)
+{
+	hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+inline size_t hash_type(const type &info)
+{
+	// Only hash the fields that are compared in 'operator==' of the type structure (qualifiers are ignored)
+	size_t hash = static_cast<size_t>(info.base) | (static_cast<size_t>(info.rows) << 8) | (static_cast<size_t>(info.cols) << 12);
+	hash_combine(hash, info.array_length);
+	hash_combine(hash, info.struct_definition);
+	return hash;
+}
+
 /// <summary>
 /// A single instruction in a SPIR-V module
 /// </summary>
@@ -33,9 +47,9 @@ struct spirv_instruction
 	spv::Op op;
 	spv::Id type;
 	spv::Id result;
-	std::vector<spv::Id> operands;
+	std::pmr::vector<spv::Id> operands;
 
-	explicit spirv_instruction(spv::Op op = spv::OpNop) : op(op), type(0), result(0) {}
+	explicit spirv_instruction(spv::Op op = spv::OpNop, std::pmr::memory_resource *arena = std::pmr::get_default_resource()) : op(op), type(0), result(0), operands(arena) {}
 	spirv_instruction(spv::Op op, spv::Id result) : op(op), type(result), result(0) {}
 	spirv_instruction(spv::Op op, spv::Id type, spv::Id result) : op(op), type(type), result(result) {}
 
@@ -89,26 +103,38 @@ struct spirv_instruction
 		// ...           | ...
 		// WordCount - 1 | Operand N (N is determined by WordCount minus the 1 to 3 words used for the opcode, instruction type <id>, and instruction Result <id>).
 
-		const uint32_t word_count = 1 + (type != 0) + (result != 0) + static_cast<uint32_t>(operands.size());
+		uint32_t words[3];
+		uint32_t num_words = 0;
+
+		const uint32_t word_count = this->word_count();
 		assert(word_count <= 0xFFFF);
-		write_word(output, (word_count << spv::WordCountShift) | op);
+		words[num_words++] = (word_count << spv::WordCountShift) | op;
 
 		// Optional instruction type ID
 		if (type != 0)
-			write_word(output, type);
+			words[num_words++] = type;
 
 		// Optional instruction result ID
 		if (result != 0)
-			write_word(output, result);
+			words[num_words++] = result;
+
+		output.append(reinterpret_cast<const char *>(words), num_words * sizeof(uint32_t));
 
 		// Write out the operands
-		for (const uint32_t operand : operands)
-			write_word(output, operand);
+		output.append(reinterpret_cast<const char *>(operands.data()), operands.size() * sizeof(uint32_t));
 	}
 
 	static void write_word(std::basic_string<char> &output, uint32_t word)
 	{
-		output.insert(output.end(), reinterpret_cast<const char *>(&word), reinterpret_cast<const char *>(&word + 1));
+		output.append(reinterpret_cast<const char *>(&word), sizeof(word));
+	}
+
+	/// <summary>
+	/// Gets the number of words this instruction occupies in a SPIR-V module.
+	/// </summary>
+	uint32_t word_count() const
+	{
+		return 1 + (type != 0) + (result != 0) + static_cast<uint32_t>(operands.size());
 	}
 
 	operator uint32_t() const
@@ -127,11 +153,24 @@ struct spirv_basic_block
 	std::vector<spirv_instruction> instructions;
 
 	/// <summary>
-	/// Append another basic block the end of this one.
+	/// Move all instructions of another basic block to the end of this one.
+	/// This does not copy any operands, since instructions keep their operand storage when moved.
 	/// </summary>
-	void append(const spirv_basic_block &block)
+	void append(spirv_basic_block &&block)
 	{
-		instructions.insert(instructions.end(), block.instructions.begin(), block.instructions.end());
+		instructions.insert(instructions.end(), std::make_move_iterator(block.instructions.begin()), std::make_move_iterator(block.instructions.end()));
+		block.instructions.clear();
+	}
+
+	/// <summary>
+	/// Gets the number of words all instructions in this basic block occupy in a SPIR-V module.
+	/// </summary>
+	size_t word_count() const
+	{
+		size_t word_count = 0;
+		for (const spirv_instruction &inst : instructions)
+			word_count += inst.word_count();
+		return word_count;
 	}
 };
 
@@ -162,6 +201,47 @@ private:
 		{
 			return lhs.type == rhs.type && lhs.is_ptr == rhs.is_ptr && lhs.array_stride == rhs.array_stride && lhs.storage == rhs.storage;
 		}
+
+		struct hash
+		{
+			size_t operator()(const type_lookup &lookup) const
+			{
+				size_t hash = hash_type(lookup.type);
+				hash_combine(hash, lookup.is_ptr);
+				hash_combine(hash, lookup.array_stride);
+				hash_combine(hash, (static_cast<size_t>(lookup.storage.first) << 16) | static_cast<size_t>(lookup.storage.second));
+				return hash;
+			}
+		};
+	};
+	struct constant_lookup
+	{
+		reshadefx::type type;
+		reshadefx::constant data;
+
+		friend bool operator==(const constant_lookup &lhs, const constant_lookup &rhs)
+		{
+			if (!(lhs.type == rhs.type && std::memcmp(&lhs.data.as_uint[0], &rhs.data.as_uint[0], sizeof(uint32_t) * 16) == 0 && lhs.data.array_data.size() == rhs.data.array_data.size()))
+				return false;
+			for (size_t i = 0; i < lhs.data.array_data.size(); ++i)
+				if (std::memcmp(&lhs.data.array_data[i].as_uint[0], &rhs.data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
+					return false;
+			return true;
+		}
+
+		struct hash
+		{
+			size_t operator()(const constant_lookup &lookup) const
+			{
+				size_t hash = hash_type(lookup.type);
+				for (uint32_t value : lookup.data.as_uint)
+					hash_combine(hash, value);
+				for (const reshadefx::constant &elem : lookup.data.array_data)
+					for (uint32_t value : elem.as_uint)
+						hash_combine(hash, value);
+				return hash;
+			}
+		};
 	};
 	struct function_blocks
 	{
@@ -180,8 +260,23 @@ private:
 					return false;
 			return lhs.return_type == rhs.return_type;
 		}
+
+		struct hash
+		{
+			size_t operator()(const function_blocks &info) const
+			{
+				size_t hash = hash_type(info.return_type);
+				for (const reshadefx::type &param_type : info.param_types)
+					hash_combine(hash, hash_type(param_type));
+				return hash;
+			}
+		};
 	};
 
+	// Operands of all instructions are allocated from this arena, which is only released when the code generator is destroyed
+	// This has to be declared before any of the instruction lists, so that it outlives them
+	std::pmr::monotonic_buffer_resource _operand_arena;
+
 	bool _debug_info = false;
 	bool _vulkan_semantics = false;
 	bool _uniforms_to_spec_constants = false;
@@ -206,9 +301,9 @@ private:
 	std::vector<spv::Id> _global_ubo_types;
 	function_blocks *_current_function_blocks = nullptr;
 
-	std::vector<std::pair<type_lookup, spv::Id>> _type_lookup;
-	std::vector<std::tuple<type, constant, spv::Id>> _constant_lookup;
-	std::vector<std::pair<function_blocks, spv::Id>> _function_type_lookup;
+	std::unordered_map<type_lookup, spv::Id, type_lookup::hash> _type_lookup;
+	std::unordered_map<constant_lookup, spv::Id, constant_lookup::hash> _constant_lookup;
+	std::unordered_map<function_blocks, spv::Id, function_blocks::hash> _function_type_lookup;
 	std::unordered_map<std::string, spv::Id> _string_lookup;
 	std::unordered_map<spv::Id, std::pair<spv::StorageClass, spv::ImageFormat>> _storage_lookup;
 	std::unordered_map<std::string, uint32_t> _semantic_to_location;
@@ -299,7 +394,7 @@ private:
 	}
 	spirv_instruction &add_instruction_without_result(spv::Op op, spirv_basic_block &block)
 	{
-		return block.instructions.emplace_back(op);
+		return block.instructions.emplace_back(op, &_operand_arena);
 	}
 
 	void finalize_header_section(std::basic_string<char> &spirv) const
@@ -346,14 +441,13 @@ private:
 				inst.write(spirv);
 		}
 	}
-	void finalize_type_and_constants_section(std::basic_string<char> &spirv) const
+	void finalize_type_and_constants_section(std::basic_string<char> &spirv, const std::vector<bool> &live_ids) const
 	{
 		// All type declarations
-		for (const spirv_instruction &inst : _types_and_constants.instructions)
-			inst.write(spirv);
+		write_live_instructions(spirv, _types_and_constants, live_ids);
 
 		// Initialize the UBO type now that all member types are known
-		if (_global_ubo_type == 0 || _global_ubo_variable == 0)
+		if (_global_ubo_type == 0 || _global_ubo_variable == 0 || !live_ids[_global_ubo_variable])
 			return;
 
 		const id global_ubo_type_ptr = _global_ubo_type + 1;
@@ -371,6 +465,152 @@ private:
 			.write(spirv);
 	}
 
+	/// <summary>
+	/// Writes all instructions of a block whose result is in the live set, together with their preceding debug line instructions.
+	/// </summary>
+	static void write_live_instructions(std::basic_string<char> &spirv, const spirv_basic_block &block, const std::vector<bool> &live_ids)
+	{
+		const spirv_instruction *line_inst = nullptr;
+
+		for (const spirv_instruction &inst : block.instructions)
+		{
+			if (inst.op == spv::OpLine)
+			{
+				line_inst = &inst;
+				continue;
+			}
+
+			if (inst.result == 0 || live_ids[inst.result])
+			{
+				if (line_inst != nullptr)
+					line_inst->write(spirv);
+				inst.write(spirv);
+			}
+
+			line_inst = nullptr;
+		}
+	}
+
+	static spv::Id function_definition_id(const function_blocks &function)
+	{
+		// Declaration may start with a debug line instruction
+		const spirv_instruction &function_inst = function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0];
+		assert(function_inst.op == spv::OpFunction);
+		return function_inst.result;
+	}
+
+	/// <summary>
+	/// Builds the set of all IDs reachable from the specified entry point, by following the call graph and every ID referenced by the instructions of called functions and global definitions.
+	/// </summary>
+	std::vector<bool> find_live_ids(const function &entry_point, const spirv_instruction &entry_point_inst) const
+	{
+		std::vector<bool> live_ids(_next_id, false);
+
+		std::unordered_map<spv::Id, const spirv_instruction *> global_definitions;
+		for (const spirv_instruction &inst : _types_and_constants.instructions)
+			if (inst.result != 0)
+				global_definitions.emplace(inst.result, &inst);
+		for (const spirv_instruction &inst : _variables.instructions)
+			if (inst.result != 0)
+				global_definitions.emplace(inst.result, &inst);
+
+		std::unordered_map<spv::Id, const function_blocks *> function_definitions;
+		for (const function_blocks &function : _functions_blocks)
+			if (!function.definition.instructions.empty())
+				function_definitions.emplace(function_definition_id(function), &function);
+
+		std::vector<spv::Id> worklist;
+		// Literal operands are not distinguished from IDs here, which may keep a few more definitions alive than necessary, but never too few
+		const auto mark_live = [&live_ids, &worklist](spv::Id id) {
+			if (id != 0 && id < live_ids.size() && !live_ids[id])
+			{
+				live_ids[id] = true;
+				worklist.push_back(id);
+			}
+		};
+		const auto mark_live_instruction = [&mark_live](const spirv_instruction &inst) {
+			mark_live(inst.type);
+			mark_live(inst.result);
+			for (const spv::Id operand : inst.operands)
+				mark_live(operand);
+		};
+
+		mark_live(entry_point.id);
+		for (const uint32_t referenced_function : entry_point.referenced_functions)
+			mark_live(referenced_function);
+
+		// Interface variables follow the entry point name in the entry point instruction
+		for (uint32_t k = 2 + static_cast<uint32_t>((std::strlen(reinterpret_cast<const char *>(&entry_point_inst.operands[2])) + 4) / 4); k < entry_point_inst.operands.size(); ++k)
+			mark_live(entry_point_inst.operands[k]);
+
+		while (!worklist.empty())
+		{
+			const spv::Id id = worklist.back();
+			worklist.pop_back();
+
+			if (const auto global_it = global_definitions.find(id);
+				global_it != global_definitions.end())
+			{
+				mark_live_instruction(*global_it->second);
+			}
+			else
+			if (const auto function_it = function_definitions.find(id);
+				function_it != function_definitions.end())
+			{
+				for (const spirv_instruction &inst : function_it->second->declaration.instructions)
+					mark_live_instruction(inst);
+				for (const spirv_instruction &inst : function_it->second->variables.instructions)
+					mark_live_instruction(inst);
+				for (const spirv_instruction &inst : function_it->second->definition.instructions)
+					mark_live_instruction(inst);
+			}
+			else
+			if (_global_ubo_type != 0 && id == _global_ubo_variable)
+			{
+				// The global uniform buffer is only defined during finalization, see 'finalize_type_and_constants_section'
+				mark_live(_global_ubo_type);
+				mark_live(_global_ubo_type + 1);
+				for (const spv::Id member_type : _global_ubo_types)
+					mark_live(member_type);
+			}
+		}
+
+		return live_ids;
+	}
+	/// <summary>
+	/// Builds the set of all result IDs that are actually written to the module for the specified live set.
+	/// The live set may contain IDs of definitions that are not emitted (e.g. locals of a stripped function whose ID happens to equal a literal operand), so names and decorations are filtered against this instead.
+	/// </summary>
+	std::vector<bool> find_emitted_ids(const std::vector<bool> &live_ids) const
+	{
+		std::vector<bool> emitted_ids(live_ids.size(), false);
+
+		for (const spirv_basic_block *const block : { &_types_and_constants, &_variables })
+			for (const spirv_instruction &inst : block->instructions)
+				if (inst.result != 0 && live_ids[inst.result])
+					emitted_ids[inst.result] = true;
+
+		if (_global_ubo_type != 0 && _global_ubo_variable != 0 && live_ids[_global_ubo_variable])
+		{
+			emitted_ids[_global_ubo_type] = true;
+			emitted_ids[_global_ubo_type + 1] = true;
+			emitted_ids[_global_ubo_variable] = true;
+		}
+
+		for (const function_blocks &function : _functions_blocks)
+		{
+			if (function.definition.instructions.empty() || !live_ids[function_definition_id(function)])
+				continue;
+
+			for (const spirv_basic_block *const block : { &function.declaration, &function.variables, &function.definition })
+				for (const spirv_instruction &inst : block->instructions)
+					if (inst.result != 0)
+						emitted_ids[inst.result] = true;
+		}
+
+		return emitted_ids;
+	}
+
 	std::string finalize_code() const override
 	{
 		// There is no high-level text representation
@@ -384,31 +624,26 @@ private:
 
 		spirv.clear();
 
-		finalize_header_section(spirv);
+		// Reserve space for all instructions up front (this over-estimates, since unreachable instructions are skipped below)
+		size_t num_words = 64 + _entries.word_count() + _execution_modes.word_count() + _debug_a.word_count() + _debug_b.word_count() + _annotations.word_count() + _types_and_constants.word_count() + _variables.word_count();
+		for (const function_blocks &function : _functions_blocks)
+			num_words += function.declaration.word_count() + function.variables.word_count() + function.definition.word_count();
+		spirv.reserve(num_words * sizeof(uint32_t));
 
-		// Build list of IDs to remove
-		std::vector<spv::Id> variables_to_remove;
-		std::vector<spv::Id> functions_to_remove;
+		const auto entry_point_inst = std::find_if(_entries.instructions.begin(), _entries.instructions.end(),
+			[entry_point](const spirv_instruction &inst) { return inst.operands[1] == entry_point->id; });
+		if (entry_point_inst == _entries.instructions.end())
+			return false;
 
-		// The entry point and execution mode declaration
-		for (const spirv_instruction &inst : _entries.instructions)
-		{
-			assert(inst.op == spv::OpEntryPoint);
+		// Strip everything that is not reachable from this entry point (other entry points, unused functions, variables, types and constants)
+		const std::vector<bool> live_ids = find_live_ids(*entry_point, *entry_point_inst);
+		const std::vector<bool> emitted_ids = find_emitted_ids(live_ids);
 
-			// Only add the matching entry point
-			if (inst.operands[1] == entry_point->id)
-			{
-				inst.write(spirv);
-			}
-			else
-			{
-				functions_to_remove.push_back(inst.operands[1]);
+		finalize_header_section(spirv);
 
-				// Add interface variables to list of variables to remove
-				for (uint32_t k = 2 + static_cast<uint32_t>((std::strlen(reinterpret_cast<const char *>(&inst.operands[2])) + 4) / 4); k < inst.operands.size(); ++k)
-					variables_to_remove.push_back(inst.operands[k]);
-			}
-		}
+		// The entry point and execution mode declaration
+		assert(entry_point_inst->op == spv::OpEntryPoint);
+		entry_point_inst->write(spirv);
 
 		for (const spirv_instruction &inst : _execution_modes.instructions)
 		{
@@ -425,60 +660,51 @@ private:
 
 		for (const spirv_instruction &inst : _debug_b.instructions)
 		{
-			// Remove all names of interface variables and functions for non-matching entry points
-			if (std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.operands[0]) != variables_to_remove.end() ||
-				std::find(functions_to_remove.begin(), functions_to_remove.end(), inst.operands[0]) != functions_to_remove.end())
+			// Remove all names of stripped definitions
+			if (!emitted_ids[inst.operands[0]])
 				continue;
 
 			inst.write(spirv);
 		}
 
 		// All annotation instructions
-		for (spirv_instruction inst : _annotations.instructions)
+		for (const spirv_instruction &inst : _annotations.instructions)
 		{
+			// Remove all decorations targeting stripped definitions
+			if (!emitted_ids[inst.operands[0]])
+				continue;
+
 			if (inst.op == spv::OpDecorate)
 			{
-				// Remove all decorations targeting any of the interface variables for non-matching entry points
-				if (std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.operands[0]) != variables_to_remove.end())
-					continue;
-
-				// Replace bindings
+				// Replace bindings (on a copy, since this may be called for multiple entry points)
 				if (inst.operands[1] == spv::DecorationBinding)
 				{
+					spirv_instruction binding_inst = inst;
+
 					if (const auto referenced_sampler_it = std::find(entry_point->referenced_samplers.begin(), entry_point->referenced_samplers.end(), inst.operands[0]);
 						referenced_sampler_it != entry_point->referenced_samplers.end())
-						inst.operands[2] = static_cast<uint32_t>(referenced_sampler_it - entry_point->referenced_samplers.begin());
+						binding_inst.operands[2] = static_cast<uint32_t>(referenced_sampler_it - entry_point->referenced_samplers.begin());
 					else
 					if (const auto referenced_storage_it = std::find(entry_point->referenced_storages.begin(), entry_point->referenced_storages.end(), inst.operands[0]);
 						referenced_storage_it != entry_point->referenced_storages.end())
-						inst.operands[2] = static_cast<uint32_t>(referenced_storage_it - entry_point->referenced_storages.begin());
+						binding_inst.operands[2] = static_cast<uint32_t>(referenced_storage_it - entry_point->referenced_storages.begin());
+
+					binding_inst.write(spirv);
+					continue;
 				}
 			}
 
 			inst.write(spirv);
 		}
 
-		finalize_type_and_constants_section(spirv);
+		finalize_type_and_constants_section(spirv, live_ids);
 
-		for (const spirv_instruction &inst : _variables.instructions)
-		{
-			// Remove all declarations of the interface variables for non-matching entry points
-			if (inst.op == spv::OpVariable && std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.result) != variables_to_remove.end())
-				continue;
-
-			inst.write(spirv);
-		}
+		write_live_instructions(spirv, _variables, live_ids);
 
 		// All referenced function definitions
 		for (const function_blocks &function : _functions_blocks)
 		{
-			if (function.definition.instructions.empty())
-				continue;
-
-			assert(function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0].op == spv::OpFunction);
-			const spv::Id definition = function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0].result;
-
-			if (std::find(functions_to_remove.begin(), functions_to_remove.end(), definition) != functions_to_remove.end())
+			if (function.definition.instructions.empty() || !live_ids[function_definition_id(function)])
 				continue;
 
 			for (const spirv_instruction &inst : function.declaration.instructions)
@@ -519,8 +745,7 @@ private:
 
 		const type_lookup lookup { info, is_ptr, array_stride, { storage, format } };
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -688,14 +913,13 @@ private:
 			}
 		}
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
 	spv::Id convert_type(const function_blocks &info)
 	{
-		if (const auto lookup_it = std::find_if(_function_type_lookup.begin(), _function_type_lookup.end(),
-				[&lookup = info](const std::pair<function_blocks, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _function_type_lookup.find(info);
 			lookup_it != _function_type_lookup.end())
 			return lookup_it->second;
 
@@ -711,7 +935,7 @@ private:
 			.add(return_type_id)
 			.add(param_type_ids.begin(), param_type_ids.end());
 
-		_function_type_lookup.push_back({ info, inst });
+		_function_type_lookup.emplace(info, inst);
 
 		return inst;
 	}
@@ -739,8 +963,7 @@ private:
 			lookup.type.struct_definition = static_cast<uint32_t>(elem_info.base);
 		}
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -755,7 +978,7 @@ private:
 				.add(info.is_storage() ? 2 : 1) // Used with a sampler or as storage
 				.add(format);
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
@@ -1005,10 +1228,17 @@ private:
 	{
 		if (_uniforms_to_spec_constants && info.has_initializer_value)
 		{
+			const size_t first_constant_index = _types_and_constants.instructions.size();
+
 			const id res = emit_constant(info.type, info.initializer_value, true);
 
 			add_name(res, info.unique_name.c_str());
 
+			// Specialization constants never reuse other constants, so all their components were just added after 'first_constant_index'
+			std::unordered_map<spv::Id, size_t> component_lookup;
+			for (size_t i = first_constant_index; i < _types_and_constants.instructions.size(); ++i)
+				component_lookup.emplace(_types_and_constants.instructions[i].result, i);
+
 			const auto add_spec_constant = [this](const spirv_instruction &inst, const uniform &info, const constant &initializer_value, size_t initializer_offset) {
 				assert(inst.op == spv::OpSpecConstant || inst.op == spv::OpSpecConstantTrue || inst.op == spv::OpSpecConstantFalse);
 
@@ -1046,17 +1276,22 @@ private:
 
 					if (info.type.is_array())
 					{
-						elem_inst = *std::find_if(_types_and_constants.instructions.rbegin(), _types_and_constants.instructions.rend(),
-							[operand_id = base_inst.operands[i]](const spirv_instruction &inst) { return inst == operand_id; });
+						elem_inst = _types_and_constants.instructions[component_lookup.at(base_inst.operands[i])];
 
 						assert(initializer_value.array_data.size() == base_inst.operands.size());
 						initializer_value = initializer_value.array_data[i];
+
+						// Elements of scalar arrays have no further components (their operand is the literal value)
+						if (elem_inst.op != spv::OpSpecConstantComposite)
+						{
+							add_spec_constant(elem_inst, info, initializer_value, 0);
+							continue;
+						}
 					}
 
 					for (size_t row = 0; row < elem_inst.operands.size(); ++row)
 					{
-						const spirv_instruction &row_inst = *std::find_if(_types_and_constants.instructions.rbegin(), _types_and_constants.instructions.rend(),
-							[operand_id = elem_inst.operands[row]](const spirv_instruction &inst) { return inst == operand_id; });
+						const spirv_instruction &row_inst = _types_and_constants.instructions[component_lookup.at(elem_inst.operands[row])];
 
 						if (row_inst.op != spv::OpSpecConstantComposite)
 						{
@@ -1066,8 +1301,7 @@ private:
 
 						for (size_t col = 0; col < row_inst.operands.size(); ++col)
 						{
-							const spirv_instruction &col_inst = *std::find_if(_types_and_constants.instructions.rbegin(), _types_and_constants.instructions.rend(),
-								[operand_id = row_inst.operands[col]](const spirv_instruction &inst) { return inst == operand_id; });
+							const spirv_instruction &col_inst = _types_and_constants.instructions[component_lookup.at(row_inst.operands[col])];
 
 							add_spec_constant(col_inst, info, initializer_value, row * info.type.cols + col);
 						}
@@ -1992,17 +2226,9 @@ private:
 	{
 		if (!spec_constant) // Specialization constants cannot reuse other constants
 		{
-			if (const auto it = std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-					[&data_type, &data](std::tuple<type, constant, spv::Id> &x) {
-						if (!(std::get<0>(x) == data_type && std::memcmp(&std::get<1>(x).as_uint[0], &data.as_uint[0], sizeof(uint32_t) * 16) == 0 && std::get<1>(x).array_data.size() == data.array_data.size()))
-							return false;
-						for (size_t i = 0; i < data.array_data.size(); ++i)
-							if (std::memcmp(&std::get<1>(x).array_data[i].as_uint[0], &data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
-								return false;
-						return true;
-					});
+			if (const auto it = _constant_lookup.find({ data_type, data });
 				it != _constant_lookup.end())
-				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
+				return it->second; // Reuse existing constant instead of duplicating the definition
 		}
 
 		spv::Id result;
@@ -2082,7 +2308,7 @@ private:
 		if (spec_constant) // Keep track of all specialization constants
 			_spec_constants.insert(result);
 		else
-			_constant_lookup.push_back({ data_type, data, result });
+			_constant_lookup.emplace(constant_lookup { data_type, data }, result);
 
 		return result;
 	}
@@ -2348,14 +2574,14 @@ private:
 
 	void emit_if(const location &loc, id, id condition_block, id true_statement_block, id false_statement_block, unsigned int selection_control) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		_current_block_data->append(std::move(_block_data[condition_block]));
 
-		spirv_instruction branch_inst = _current_block_data->instructions.back();
+		spirv_instruction branch_inst = std::move(_current_block_data->instructions.back());
 		assert(branch_inst.op == spv::OpBranchConditional);
 		_current_block_data->instructions.pop_back();
 
@@ -2366,27 +2592,27 @@ private:
 			.add(selection_control & 0x3); // 'SelectionControl' happens to match the flags produced by the parser
 
 		// Append all blocks belonging to the branch
-		_current_block_data->instructions.push_back(branch_inst);
-		_current_block_data->append(_block_data[true_statement_block]);
-		_current_block_data->append(_block_data[false_statement_block]);
+		_current_block_data->instructions.push_back(std::move(branch_inst));
+		_current_block_data->append(std::move(_block_data[true_statement_block]));
+		_current_block_data->append(std::move(_block_data[false_statement_block]));
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 	id   emit_phi(const location &loc, id, id condition_block, id true_value, id true_statement_block, id false_value, id false_statement_block, const type &res_type) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		_current_block_data->append(std::move(_block_data[condition_block]));
 
 		if (true_statement_block != condition_block)
-			_current_block_data->append(_block_data[true_statement_block]);
+			_current_block_data->append(std::move(_block_data[true_statement_block]));
 		if (false_statement_block != condition_block)
-			_current_block_data->append(_block_data[false_statement_block]);
+			_current_block_data->append(std::move(_block_data[false_statement_block]));
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 
 		add_location(loc, *_current_block_data);
 
@@ -2401,16 +2627,16 @@ private:
 	}
 	void emit_loop(const location &loc, id, id prev_block, id header_block, id condition_block, id loop_block, id continue_block, unsigned int loop_control) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block first
-		_current_block_data->append(_block_data[prev_block]);
+		_current_block_data->append(std::move(_block_data[prev_block]));
 
 		// Fill header block
 		assert(_block_data[header_block].instructions.size() == 2);
-		_current_block_data->instructions.push_back(_block_data[header_block].instructions[0]);
+		_current_block_data->instructions.push_back(std::move(_block_data[header_block].instructions[0]));
 		assert(_current_block_data->instructions.back().op == spv::OpLabel);
 
 		// Add structured control flow instruction
@@ -2420,31 +2646,31 @@ private:
 			.add(continue_block)
 			.add(loop_control & 0x3); // 'LoopControl' happens to match the flags produced by the parser
 
-		_current_block_data->instructions.push_back(_block_data[header_block].instructions[1]);
+		_current_block_data->instructions.push_back(std::move(_block_data[header_block].instructions[1]));
 		assert(_current_block_data->instructions.back().op == spv::OpBranch);
 
 		// Add condition block if it exists
 		if (condition_block != 0)
-			_current_block_data->append(_block_data[condition_block]);
+			_current_block_data->append(std::move(_block_data[condition_block]));
 
 		// Append loop body block before continue block
-		_current_block_data->append(_block_data[loop_block]);
-		_current_block_data->append(_block_data[continue_block]);
+		_current_block_data->append(std::move(_block_data[loop_block]));
+		_current_block_data->append(std::move(_block_data[continue_block]));
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 	void emit_switch(const location &loc, id, id selector_block, id default_label, id default_block, const std::vector<id> &case_literal_and_labels, const std::vector<id> &case_blocks, unsigned int selection_control) override
 	{
 		assert(case_blocks.size() == case_literal_and_labels.size() / 2);
 
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the selector value first
-		_current_block_data->append(_block_data[selector_block]);
+		_current_block_data->append(std::move(_block_data[selector_block]));
 
-		spirv_instruction switch_inst = _current_block_data->instructions.back();
+		spirv_instruction switch_inst = std::move(_current_block_data->instructions.back());
 		assert(switch_inst.op == spv::OpSwitch);
 		_current_block_data->instructions.pop_back();
 
@@ -2459,7 +2685,7 @@ private:
 		switch_inst.add(case_literal_and_labels.begin(), case_literal_and_labels.end());
 
 		// Append all blocks belonging to the switch
-		_current_block_data->instructions.push_back(switch_inst);
+		_current_block_data->instructions.push_back(std::move(switch_inst));
 
 		std::vector<id> blocks = case_blocks;
 		if (default_label != merge_label)
@@ -2468,9 +2694,9 @@ private:
 		std::sort(blocks.begin(), blocks.end());
 		blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
 		for (const id case_block : blocks)
-			_current_block_data->append(_block_data[case_block]);
+			_current_block_data->append(std::move(_block_data[case_block]));
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 
 	void emit_pragma(const std::string &) override
@@ -2576,7 +2802,7 @@ private:
 	{
 		assert(is_in_function()); // Can only leave if there was a function to begin with
 
-		_current_function_blocks->definition = _block_data[_last_block];
+		_current_function_blocks->definition = std::move(_block_data[_last_block]);
 
 		// Append function end instruction
 		add_instruction_without_result(spv::OpFunctionEnd, _current_function_blocks->definition);
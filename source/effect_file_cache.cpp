@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_file_cache.hpp"
+#include <mutex>
+#include <cstdio> // fclose, fopen, fread, fseek
+
+#ifndef _WIN32
+	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
+	#define u8string() string()
+#endif
+
+static bool read_file(const std::filesystem::path &path, std::string &file_data)
+{
+#ifndef _WIN32
+	FILE *const file = fopen(path.c_str(), "rb");
+#else
+	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYWR);
+#endif
+	if (file == nullptr)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	const size_t file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	file_data.reserve(file_size + 1);
+	file_data.resize(file_size);
+	const size_t file_size_read = fread(file_data.data(), 1, file_size, file);
+
+	// No longer need to have a handle open to the file, since all data was read, so can safely close it
+	fclose(file);
+
+	return file_size_read == file_size;
+}
+
+reshadefx::file_cache &reshadefx::file_cache::instance()
+{
+	static file_cache s_instance;
+	return s_instance;
+}
+
+std::shared_ptr<const std::string> reshadefx::file_cache::read(const std::filesystem::path &path)
+{
+	std::error_code ec;
+	const int64_t last_write_time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+	if (ec)
+		return nullptr;
+	const uintmax_t file_size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return nullptr;
+
+	std::string key = path.u8string();
+
+	// Readers only ever take a shared lock, so concurrent pre-processors looking up the same headers do not block each other
+	{	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+		if (const auto it = _entries.find(key);
+			it != _entries.end() && it->second.last_write_time == last_write_time && it->second.file_size == file_size)
+			return it->second.contents;
+	}
+
+	// Read and normalize the file outside the lock, so that other files can still be looked up in the meantime
+	std::string file_data;
+	if (!read_file(path, file_data))
+		return nullptr;
+
+	// Remove UTF-8 BOM (0xEFBBBF is the UTF-8 byte sequence for the character 0xFEFF)
+	if (file_data.size() >= 3 &&
+		static_cast<unsigned char>(file_data[0]) == 0xEF &&
+		static_cast<unsigned char>(file_data[1]) == 0xBB &&
+		static_cast<unsigned char>(file_data[2]) == 0xBF)
+		file_data.erase(0, 3);
+
+	// Append a new line feed to the end of the input string to avoid issues with parsing
+	file_data.push_back('\n');
+
+	entry new_entry;
+	new_entry.last_write_time = last_write_time;
+	new_entry.file_size = file_size;
+	new_entry.contents = std::make_shared<const std::string>(std::move(file_data));
+
+	const std::shared_ptr<const std::string> contents = new_entry.contents;
+
+	// If another thread read the same file concurrently, simply replace its result, since the contents are the same
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	_entries.insert_or_assign(std::move(key), std::move(new_entry));
+
+	return contents;
+}
+
+void reshadefx::file_cache::clear()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_entries.clear();
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <string>
+#include <memory> // std::shared_ptr
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace reshadefx
+{
+	/// <summary>
+	/// A process-wide cache of source file contents, shared by all pre-processor instances (including those running concurrently on different threads).
+	/// Contents are stored normalized (UTF-8 BOM removed and terminated with a line feed) and are read again whenever the modification time or size of a file changes.
+	/// </summary>
+	class file_cache
+	{
+	public:
+		/// <summary>
+		/// Gets the process-wide cache instance.
+		/// </summary>
+		static file_cache &instance();
+
+		/// <summary>
+		/// Gets the normalized contents of the specified file, reading it from disk only if it is not cached yet or changed since it was cached.
+		/// </summary>
+		/// <param name="path">Path to the file to read.</param>
+		/// <returns>Shared pointer to the file contents, or <see langword="nullptr"/> if the file could not be read.</returns>
+		std::shared_ptr<const std::string> read(const std::filesystem::path &path);
+
+		/// <summary>
+		/// Removes all files from the cache. Contents still referenced elsewhere stay valid.
+		/// </summary>
+		void clear();
+
+	private:
+		struct entry
+		{
+			int64_t last_write_time = 0;
+			uintmax_t file_size = 0;
+			std::shared_ptr<const std::string> contents;
+		};
+
+		std::shared_mutex _mutex;
+		std::unordered_map<std::string, entry> _entries;
+	};
+}
@@ -5,10 +5,13 @@
 
 #include "effect_lexer.hpp"
 #include <cassert>
+#include <utility> // std::pair
+#include <iterator> // std::size
 #include <string_view>
 #include <unordered_map> // Used for static lookup tables
 
 using namespace reshadefx;
+using namespace std::string_view_literals;
 
 enum token_type
 {
@@ -233,283 +236,443 @@ static const std::unordered_map<tokenid, std::string_view> s_token_lookup = {
 	{ tokenid::storage2d, "storage2D" },
 	{ tokenid::storage3d, "storage3D" },
 };
-static const std::unordered_map<std::string_view, tokenid> s_keyword_lookup = {
-	{ "_Pragma", tokenid::pragma },
-	{ "asm", tokenid::reserved },
-	{ "asm_fragment", tokenid::reserved },
-	{ "auto", tokenid::reserved },
-	{ "bool", tokenid::bool_ },
-	{ "bool2", tokenid::bool2 },
-	{ "bool2x1", tokenid::bool2 },
-	{ "bool2x2", tokenid::bool2x2 },
-	{ "bool2x3", tokenid::bool2x3 },
-	{ "bool2x4", tokenid::bool2x4 },
-	{ "bool3", tokenid::bool3 },
-	{ "bool3x1", tokenid::bool3 },
-	{ "bool3x2", tokenid::bool3x2 },
-	{ "bool3x3", tokenid::bool3x3 },
-	{ "bool3x4", tokenid::bool3x4 },
-	{ "bool4", tokenid::bool4 },
-	{ "bool4x1", tokenid::bool4 },
-	{ "bool4x2", tokenid::bool4x2 },
-	{ "bool4x3", tokenid::bool4x3 },
-	{ "bool4x4", tokenid::bool4x4 },
-	{ "break", tokenid::break_ },
-	{ "case", tokenid::case_ },
-	{ "cast", tokenid::reserved },
-	{ "catch", tokenid::reserved },
-	{ "centroid", tokenid::reserved },
-	{ "char", tokenid::reserved },
-	{ "class", tokenid::reserved },
-	{ "column_major", tokenid::reserved },
-	{ "compile", tokenid::reserved },
-	{ "const", tokenid::const_ },
-	{ "const_cast", tokenid::reserved },
-	{ "continue", tokenid::continue_ },
-	{ "default", tokenid::default_ },
-	{ "delete", tokenid::reserved },
-	{ "discard", tokenid::discard_ },
-	{ "do", tokenid::do_ },
-	{ "double", tokenid::reserved },
-	{ "dword", tokenid::uint_ },
-	{ "dword2", tokenid::uint2 },
-	{ "dword2x1", tokenid::uint2 },
-	{ "dword2x2", tokenid::uint2x2 },
-	{ "dword2x3", tokenid::uint2x3 },
-	{ "dword2x4", tokenid::uint2x4 },
-	{ "dword3", tokenid::uint3, },
-	{ "dword3x1", tokenid::uint3 },
-	{ "dword3x2", tokenid::uint3x2 },
-	{ "dword3x3", tokenid::uint3x3 },
-	{ "dword3x4", tokenid::uint3x4 },
-	{ "dword4", tokenid::uint4 },
-	{ "dword4x1", tokenid::uint4 },
-	{ "dword4x2", tokenid::uint4x2 },
-	{ "dword4x3", tokenid::uint4x3 },
-	{ "dword4x4", tokenid::uint4x4 },
-	{ "dynamic_cast", tokenid::reserved },
-	{ "else", tokenid::else_ },
-	{ "enum", tokenid::reserved },
-	{ "explicit", tokenid::reserved },
-	{ "extern", tokenid::extern_ },
-	{ "external", tokenid::reserved },
-	{ "false", tokenid::false_literal },
-	{ "FALSE", tokenid::false_literal },
-	{ "float", tokenid::float_ },
-	{ "float2", tokenid::float2 },
-	{ "float2x1", tokenid::float2 },
-	{ "float2x2", tokenid::float2x2 },
-	{ "float2x3", tokenid::float2x3 },
-	{ "float2x4", tokenid::float2x4 },
-	{ "float3", tokenid::float3 },
-	{ "float3x1", tokenid::float3 },
-	{ "float3x2", tokenid::float3x2 },
-	{ "float3x3", tokenid::float3x3 },
-	{ "float3x4", tokenid::float3x4 },
-	{ "float4", tokenid::float4 },
-	{ "float4x1", tokenid::float4 },
-	{ "float4x2", tokenid::float4x2 },
-	{ "float4x3", tokenid::float4x3 },
-	{ "float4x4", tokenid::float4x4 },
-	{ "for", tokenid::for_ },
-	{ "foreach", tokenid::reserved },
-	{ "friend", tokenid::reserved },
-	{ "globallycoherent", tokenid::reserved },
-	{ "goto", tokenid::reserved },
-	{ "groupshared", tokenid::groupshared },
-	{ "half", tokenid::reserved },
-	{ "half2", tokenid::reserved },
-	{ "half2x1", tokenid::reserved },
-	{ "half2x2", tokenid::reserved },
-	{ "half2x3", tokenid::reserved },
-	{ "half2x4", tokenid::reserved },
-	{ "half3", tokenid::reserved },
-	{ "half3x1", tokenid::reserved },
-	{ "half3x2", tokenid::reserved },
-	{ "half3x3", tokenid::reserved },
-	{ "half3x4", tokenid::reserved },
-	{ "half4", tokenid::reserved },
-	{ "half4x1", tokenid::reserved },
-	{ "half4x2", tokenid::reserved },
-	{ "half4x3", tokenid::reserved },
-	{ "half4x4", tokenid::reserved },
-	{ "if", tokenid::if_ },
-	{ "in", tokenid::in },
-	{ "inline", tokenid::reserved },
-	{ "inout", tokenid::inout },
-	{ "int", tokenid::int_ },
-	{ "int2", tokenid::int2 },
-	{ "int2x1", tokenid::int2 },
-	{ "int2x2", tokenid::int2x2 },
-	{ "int2x3", tokenid::int2x3 },
-	{ "int2x4", tokenid::int2x4 },
-	{ "int3", tokenid::int3 },
-	{ "int3x1", tokenid::int3 },
-	{ "int3x2", tokenid::int3x2 },
-	{ "int3x3", tokenid::int3x3 },
-	{ "int3x4", tokenid::int3x4 },
-	{ "int4", tokenid::int4 },
-	{ "int4x1", tokenid::int4 },
-	{ "int4x2", tokenid::int4x2 },
-	{ "int4x3", tokenid::int4x3 },
-	{ "int4x4", tokenid::int4x4 },
-	{ "interface", tokenid::reserved },
-	{ "linear", tokenid::linear },
-	{ "long", tokenid::reserved },
-	{ "matrix", tokenid::matrix },
-	{ "min16float", tokenid::min16float },
-	{ "min16float2", tokenid::min16float2 },
-	{ "min16float3", tokenid::min16float3 },
-	{ "min16float4", tokenid::min16float4 },
-	{ "min16float2x2", tokenid::min16float2x2 },
-	{ "min16float2x3", tokenid::min16float2x3 },
-	{ "min16float2x4", tokenid::min16float2x4 },
-	{ "min16float3x2", tokenid::min16float3x2 },
-	{ "min16float3x3", tokenid::min16float3x3 },
-	{ "min16float3x4", tokenid::min16float3x4 },
-	{ "min16float4x2", tokenid::min16float4x2 },
-	{ "min16float4x3", tokenid::min16float4x3 },
-	{ "min16float4x4", tokenid::min16float4x4 },
-	{ "min16int", tokenid::min16int },
-	{ "min16int2", tokenid::min16int2 },
-	{ "min16int3", tokenid::min16int3 },
-	{ "min16int4", tokenid::min16int4 },
-	{ "min16int2x2", tokenid::min16int2x2 },
-	{ "min16int2x3", tokenid::min16int2x3 },
-	{ "min16int2x4", tokenid::min16int2x4 },
-	{ "min16int3x2", tokenid::min16int3x2 },
-	{ "min16int3x3", tokenid::min16int3x3 },
-	{ "min16int3x4", tokenid::min16int3x4 },
-	{ "min16int4x2", tokenid::min16int4x2 },
-	{ "min16int4x3", tokenid::min16int4x3 },
-	{ "min16int4x4", tokenid::min16int4x4 },
-	{ "min16uint", tokenid::min16uint },
-	{ "min16uint2", tokenid::min16uint2 },
-	{ "min16uint3", tokenid::min16uint3 },
-	{ "min16uint4", tokenid::min16uint4 },
-	{ "min16uint2x2", tokenid::min16uint2x2 },
-	{ "min16uint2x3", tokenid::min16uint2x3 },
-	{ "min16uint2x4", tokenid::min16uint2x4 },
-	{ "min16uint3x2", tokenid::min16uint3x2 },
-	{ "min16uint3x3", tokenid::min16uint3x3 },
-	{ "min16uint3x4", tokenid::min16uint3x4 },
-	{ "min16uint4x2", tokenid::min16uint4x2 },
-	{ "min16uint4x3", tokenid::min16uint4x3 },
-	{ "min16uint4x4", tokenid::min16uint4x4 },
-	{ "mutable", tokenid::reserved },
-	{ "namespace", tokenid::namespace_ },
-	{ "new", tokenid::reserved },
-	{ "noinline", tokenid::reserved },
-	{ "nointerpolation", tokenid::nointerpolation },
-	{ "noperspective", tokenid::noperspective },
-	{ "operator", tokenid::reserved },
-	{ "out", tokenid::out },
-	{ "packed", tokenid::reserved },
-	{ "packoffset", tokenid::reserved },
-	{ "pass", tokenid::pass },
-	{ "precise", tokenid::precise },
-	{ "private", tokenid::reserved },
-	{ "protected", tokenid::reserved },
-	{ "public", tokenid::reserved },
-	{ "register", tokenid::reserved },
-	{ "reinterpret_cast", tokenid::reserved },
-	{ "restrict", tokenid::reserved },
-	{ "return", tokenid::return_ },
-	{ "row_major", tokenid::reserved },
-	{ "sample", tokenid::reserved },
-	{ "sampler", tokenid::sampler2d },
-	{ "sampler1D", tokenid::sampler1d },
-	{ "sampler1DArray", tokenid::reserved },
-	{ "sampler2D", tokenid::sampler2d },
-	{ "sampler2DArray", tokenid::reserved },
-	{ "sampler2DMS", tokenid::reserved },
-	{ "sampler2DMSArray", tokenid::reserved },
-	{ "sampler3D", tokenid::sampler3d },
-	{ "sampler_state", tokenid::reserved },
-	{ "samplerCube", tokenid::reserved },
-	{ "samplerCubeArray", tokenid::reserved },
-	{ "samplerCUBE", tokenid::reserved },
-	{ "samplerRect", tokenid::reserved },
-	{ "samplerRECT", tokenid::reserved },
-	{ "SamplerState", tokenid::reserved },
-	{ "storage", tokenid::storage2d },
-	{ "storage1D", tokenid::storage1d },
-	{ "storage2D", tokenid::storage2d },
-	{ "storage3D", tokenid::storage3d },
-	{ "shared", tokenid::reserved },
-	{ "short", tokenid::reserved },
-	{ "signed", tokenid::reserved },
-	{ "sizeof", tokenid::reserved },
-	{ "snorm", tokenid::reserved },
-	{ "static", tokenid::static_ },
-	{ "static_cast", tokenid::reserved },
-	{ "string", tokenid::string_ },
-	{ "struct", tokenid::struct_ },
-	{ "switch", tokenid::switch_ },
-	{ "technique", tokenid::technique },
-	{ "template", tokenid::reserved },
-	{ "texture", tokenid::texture2d },
-	{ "Texture1D", tokenid::reserved },
-	{ "texture1D", tokenid::texture1d },
-	{ "Texture1DArray", tokenid::reserved },
-	{ "Texture2D", tokenid::reserved },
-	{ "texture2D", tokenid::texture2d },
-	{ "Texture2DArray", tokenid::reserved },
-	{ "Texture2DMS", tokenid::reserved },
-	{ "Texture2DMSArray", tokenid::reserved },
-	{ "Texture3D", tokenid::reserved },
-	{ "texture3D", tokenid::texture3d },
-	{ "textureCUBE", tokenid::reserved },
-	{ "TextureCube", tokenid::reserved },
-	{ "TextureCubeArray", tokenid::reserved },
-	{ "textureRECT", tokenid::reserved },
-	{ "this", tokenid::reserved },
-	{ "true", tokenid::true_literal },
-	{ "TRUE", tokenid::true_literal },
-	{ "try", tokenid::reserved },
-	{ "typedef", tokenid::reserved },
-	{ "uint", tokenid::uint_ },
-	{ "uint2", tokenid::uint2 },
-	{ "uint2x1", tokenid::uint2 },
-	{ "uint2x2", tokenid::uint2x2 },
-	{ "uint2x3", tokenid::uint2x3 },
-	{ "uint2x4", tokenid::uint2x4 },
-	{ "uint3", tokenid::uint3 },
-	{ "uint3x1", tokenid::uint3 },
-	{ "uint3x2", tokenid::uint3x2 },
-	{ "uint3x3", tokenid::uint3x3 },
-	{ "uint3x4", tokenid::uint3x4 },
-	{ "uint4", tokenid::uint4 },
-	{ "uint4x1", tokenid::uint4 },
-	{ "uint4x2", tokenid::uint4x2 },
-	{ "uint4x3", tokenid::uint4x3 },
-	{ "uint4x4", tokenid::uint4x4 },
-	{ "uniform", tokenid::uniform_ },
-	{ "union", tokenid::reserved },
-	{ "unorm", tokenid::reserved },
-	{ "unsigned", tokenid::reserved },
-	{ "using", tokenid::reserved },
-	{ "vector", tokenid::vector },
-	{ "virtual", tokenid::reserved },
-	{ "void", tokenid::void_ },
-	{ "volatile", tokenid::volatile_ },
-	{ "while", tokenid::while_ }
+static constexpr std::pair<std::string_view, tokenid> s_keywords[] = {
+	{ "_Pragma"sv, tokenid::pragma },
+	{ "asm"sv, tokenid::reserved },
+	{ "asm_fragment"sv, tokenid::reserved },
+	{ "auto"sv, tokenid::reserved },
+	{ "bool"sv, tokenid::bool_ },
+	{ "bool2"sv, tokenid::bool2 },
+	{ "bool2x1"sv, tokenid::bool2 },
+	{ "bool2x2"sv, tokenid::bool2x2 },
+	{ "bool2x3"sv, tokenid::bool2x3 },
+	{ "bool2x4"sv, tokenid::bool2x4 },
+	{ "bool3"sv, tokenid::bool3 },
+	{ "bool3x1"sv, tokenid::bool3 },
+	{ "bool3x2"sv, tokenid::bool3x2 },
+	{ "bool3x3"sv, tokenid::bool3x3 },
+	{ "bool3x4"sv, tokenid::bool3x4 },
+	{ "bool4"sv, tokenid::bool4 },
+	{ "bool4x1"sv, tokenid::bool4 },
+	{ "bool4x2"sv, tokenid::bool4x2 },
+	{ "bool4x3"sv, tokenid::bool4x3 },
+	{ "bool4x4"sv, tokenid::bool4x4 },
+	{ "break"sv, tokenid::break_ },
+	{ "case"sv, tokenid::case_ },
+	{ "cast"sv, tokenid::reserved },
+	{ "catch"sv, tokenid::reserved },
+	{ "centroid"sv, tokenid::reserved },
+	{ "char"sv, tokenid::reserved },
+	{ "class"sv, tokenid::reserved },
+	{ "column_major"sv, tokenid::reserved },
+	{ "compile"sv, tokenid::reserved },
+	{ "const"sv, tokenid::const_ },
+	{ "const_cast"sv, tokenid::reserved },
+	{ "continue"sv, tokenid::continue_ },
+	{ "default"sv, tokenid::default_ },
+	{ "delete"sv, tokenid::reserved },
+	{ "discard"sv, tokenid::discard_ },
+	{ "do"sv, tokenid::do_ },
+	{ "double"sv, tokenid::reserved },
+	{ "dword"sv, tokenid::uint_ },
+	{ "dword2"sv, tokenid::uint2 },
+	{ "dword2x1"sv, tokenid::uint2 },
+	{ "dword2x2"sv, tokenid::uint2x2 },
+	{ "dword2x3"sv, tokenid::uint2x3 },
+	{ "dword2x4"sv, tokenid::uint2x4 },
+	{ "dword3"sv, tokenid::uint3, },
+	{ "dword3x1"sv, tokenid::uint3 },
+	{ "dword3x2"sv, tokenid::uint3x2 },
+	{ "dword3x3"sv, tokenid::uint3x3 },
+	{ "dword3x4"sv, tokenid::uint3x4 },
+	{ "dword4"sv, tokenid::uint4 },
+	{ "dword4x1"sv, tokenid::uint4 },
+	{ "dword4x2"sv, tokenid::uint4x2 },
+	{ "dword4x3"sv, tokenid::uint4x3 },
+	{ "dword4x4"sv, tokenid::uint4x4 },
+	{ "dynamic_cast"sv, tokenid::reserved },
+	{ "else"sv, tokenid::else_ },
+	{ "enum"sv, tokenid::reserved },
+	{ "explicit"sv, tokenid::reserved },
+	{ "extern"sv, tokenid::extern_ },
+	{ "external"sv, tokenid::reserved },
+	{ "false"sv, tokenid::false_literal },
+	{ "FALSE"sv, tokenid::false_literal },
+	{ "float"sv, tokenid::float_ },
+	{ "float2"sv, tokenid::float2 },
+	{ "float2x1"sv, tokenid::float2 },
+	{ "float2x2"sv, tokenid::float2x2 },
+	{ "float2x3"sv, tokenid::float2x3 },
+	{ "float2x4"sv, tokenid::float2x4 },
+	{ "float3"sv, tokenid::float3 },
+	{ "float3x1"sv, tokenid::float3 },
+	{ "float3x2"sv, tokenid::float3x2 },
+	{ "float3x3"sv, tokenid::float3x3 },
+	{ "float3x4"sv, tokenid::float3x4 },
+	{ "float4"sv, tokenid::float4 },
+	{ "float4x1"sv, tokenid::float4 },
+	{ "float4x2"sv, tokenid::float4x2 },
+	{ "float4x3"sv, tokenid::float4x3 },
+	{ "float4x4"sv, tokenid::float4x4 },
+	{ "for"sv, tokenid::for_ },
+	{ "foreach"sv, tokenid::reserved },
+	{ "friend"sv, tokenid::reserved },
+	{ "globallycoherent"sv, tokenid::reserved },
+	{ "goto"sv, tokenid::reserved },
+	{ "groupshared"sv, tokenid::groupshared },
+	{ "half"sv, tokenid::reserved },
+	{ "half2"sv, tokenid::reserved },
+	{ "half2x1"sv, tokenid::reserved },
+	{ "half2x2"sv, tokenid::reserved },
+	{ "half2x3"sv, tokenid::reserved },
+	{ "half2x4"sv, tokenid::reserved },
+	{ "half3"sv, tokenid::reserved },
+	{ "half3x1"sv, tokenid::reserved },
+	{ "half3x2"sv, tokenid::reserved },
+	{ "half3x3"sv, tokenid::reserved },
+	{ "half3x4"sv, tokenid::reserved },
+	{ "half4"sv, tokenid::reserved },
+	{ "half4x1"sv, tokenid::reserved },
+	{ "half4x2"sv, tokenid::reserved },
+	{ "half4x3"sv, tokenid::reserved },
+	{ "half4x4"sv, tokenid::reserved },
+	{ "if"sv, tokenid::if_ },
+	{ "in"sv, tokenid::in },
+	{ "inline"sv, tokenid::reserved },
+	{ "inout"sv, tokenid::inout },
+	{ "int"sv, tokenid::int_ },
+	{ "int2"sv, tokenid::int2 },
+	{ "int2x1"sv, tokenid::int2 },
+	{ "int2x2"sv, tokenid::int2x2 },
+	{ "int2x3"sv, tokenid::int2x3 },
+	{ "int2x4"sv, tokenid::int2x4 },
+	{ "int3"sv, tokenid::int3 },
+	{ "int3x1"sv, tokenid::int3 },
+	{ "int3x2"sv, tokenid::int3x2 },
+	{ "int3x3"sv, tokenid::int3x3 },
+	{ "int3x4"sv, tokenid::int3x4 },
+	{ "int4"sv, tokenid::int4 },
+	{ "int4x1"sv, tokenid::int4 },
+	{ "int4x2"sv, tokenid::int4x2 },
+	{ "int4x3"sv, tokenid::int4x3 },
+	{ "int4x4"sv, tokenid::int4x4 },
+	{ "interface"sv, tokenid::reserved },
+	{ "linear"sv, tokenid::linear },
+	{ "long"sv, tokenid::reserved },
+	{ "matrix"sv, tokenid::matrix },
+	{ "min16float"sv, tokenid::min16float },
+	{ "min16float2"sv, tokenid::min16float2 },
+	{ "min16float3"sv, tokenid::min16float3 },
+	{ "min16float4"sv, tokenid::min16float4 },
+	{ "min16float2x2"sv, tokenid::min16float2x2 },
+	{ "min16float2x3"sv, tokenid::min16float2x3 },
+	{ "min16float2x4"sv, tokenid::min16float2x4 },
+	{ "min16float3x2"sv, tokenid::min16float3x2 },
+	{ "min16float3x3"sv, tokenid::min16float3x3 },
+	{ "min16float3x4"sv, tokenid::min16float3x4 },
+	{ "min16float4x2"sv, tokenid::min16float4x2 },
+	{ "min16float4x3"sv, tokenid::min16float4x3 },
+	{ "min16float4x4"sv, tokenid::min16float4x4 },
+	{ "min16int"sv, tokenid::min16int },
+	{ "min16int2"sv, tokenid::min16int2 },
+	{ "min16int3"sv, tokenid::min16int3 },
+	{ "min16int4"sv, tokenid::min16int4 },
+	{ "min16int2x2"sv, tokenid::min16int2x2 },
+	{ "min16int2x3"sv, tokenid::min16int2x3 },
+	{ "min16int2x4"sv, tokenid::min16int2x4 },
+	{ "min16int3x2"sv, tokenid::min16int3x2 },
+	{ "min16int3x3"sv, tokenid::min16int3x3 },
+	{ "min16int3x4"sv, tokenid::min16int3x4 },
+	{ "min16int4x2"sv, tokenid::min16int4x2 },
+	{ "min16int4x3"sv, tokenid::min16int4x3 },
+	{ "min16int4x4"sv, tokenid::min16int4x4 },
+	{ "min16uint"sv, tokenid::min16uint },
+	{ "min16uint2"sv, tokenid::min16uint2 },
+	{ "min16uint3"sv, tokenid::min16uint3 },
+	{ "min16uint4"sv, tokenid::min16uint4 },
+	{ "min16uint2x2"sv, tokenid::min16uint2x2 },
+	{ "min16uint2x3"sv, tokenid::min16uint2x3 },
+	{ "min16uint2x4"sv, tokenid::min16uint2x4 },
+	{ "min16uint3x2"sv, tokenid::min16uint3x2 },
+	{ "min16uint3x3"sv, tokenid::min16uint3x3 },
+	{ "min16uint3x4"sv, tokenid::min16uint3x4 },
+	{ "min16uint4x2"sv, tokenid::min16uint4x2 },
+	{ "min16uint4x3"sv, tokenid::min16uint4x3 },
+	{ "min16uint4x4"sv, tokenid::min16uint4x4 },
+	{ "mutable"sv, tokenid::reserved },
+	{ "namespace"sv, tokenid::namespace_ },
+	{ "new"sv, tokenid::reserved },
+	{ "noinline"sv, tokenid::reserved },
+	{ "nointerpolation"sv, tokenid::nointerpolation },
+	{ "noperspective"sv, tokenid::noperspective },
+	{ "operator"sv, tokenid::reserved },
+	{ "out"sv, tokenid::out },
+	{ "packed"sv, tokenid::reserved },
+	{ "packoffset"sv, tokenid::reserved },
+	{ "pass"sv, tokenid::pass },
+	{ "precise"sv, tokenid::precise },
+	{ "private"sv, tokenid::reserved },
+	{ "protected"sv, tokenid::reserved },
+	{ "public"sv, tokenid::reserved },
+	{ "register"sv, tokenid::reserved },
+	{ "reinterpret_cast"sv, tokenid::reserved },
+	{ "restrict"sv, tokenid::reserved },
+	{ "return"sv, tokenid::return_ },
+	{ "row_major"sv, tokenid::reserved },
+	{ "sample"sv, tokenid::reserved },
+	{ "sampler"sv, tokenid::sampler2d },
+	{ "sampler1D"sv, tokenid::sampler1d },
+	{ "sampler1DArray"sv, tokenid::reserved },
+	{ "sampler2D"sv, tokenid::sampler2d },
+	{ "sampler2DArray"sv, tokenid::reserved },
+	{ "sampler2DMS"sv, tokenid::reserved },
+	{ "sampler2DMSArray"sv, tokenid::reserved },
+	{ "sampler3D"sv, tokenid::sampler3d },
+	{ "sampler_state"sv, tokenid::reserved },
+	{ "samplerCube"sv, tokenid::reserved },
+	{ "samplerCubeArray"sv, tokenid::reserved },
+	{ "samplerCUBE"sv, tokenid::reserved },
+	{ "samplerRect"sv, tokenid::reserved },
+	{ "samplerRECT"sv, tokenid::reserved },
+	{ "SamplerState"sv, tokenid::reserved },
+	{ "storage"sv, tokenid::storage2d },
+	{ "storage1D"sv, tokenid::storage1d },
+	{ "storage2D"sv, tokenid::storage2d },
+	{ "storage3D"sv, tokenid::storage3d },
+	{ "shared"sv, tokenid::reserved },
+	{ "short"sv, tokenid::reserved },
+	{ "signed"sv, tokenid::reserved },
+	{ "sizeof"sv, tokenid::reserved },
+	{ "snorm"sv, tokenid::reserved },
+	{ "static"sv, tokenid::static_ },
+	{ "static_cast"sv, tokenid::reserved },
+	{ "string"sv, tokenid::string_ },
+	{ "struct"sv, tokenid::struct_ },
+	{ "switch"sv, tokenid::switch_ },
+	{ "technique"sv, tokenid::technique },
+	{ "template"sv, tokenid::reserved },
+	{ "texture"sv, tokenid::texture2d },
+	{ "Texture1D"sv, tokenid::reserved },
+	{ "texture1D"sv, tokenid::texture1d },
+	{ "Texture1DArray"sv, tokenid::reserved },
+	{ "Texture2D"sv, tokenid::reserved },
+	{ "texture2D"sv, tokenid::texture2d },
+	{ "Texture2DArray"sv, tokenid::reserved },
+	{ "Texture2DMS"sv, tokenid::reserved },
+	{ "Texture2DMSArray"sv, tokenid::reserved },
+	{ "Texture3D"sv, tokenid::reserved },
+	{ "texture3D"sv, tokenid::texture3d },
+	{ "textureCUBE"sv, tokenid::reserved },
+	{ "TextureCube"sv, tokenid::reserved },
+	{ "TextureCubeArray"sv, tokenid::reserved },
+	{ "textureRECT"sv, tokenid::reserved },
+	{ "this"sv, tokenid::reserved },
+	{ "true"sv, tokenid::true_literal },
+	{ "TRUE"sv, tokenid::true_literal },
+	{ "try"sv, tokenid::reserved },
+	{ "typedef"sv, tokenid::reserved },
+	{ "uint"sv, tokenid::uint_ },
+	{ "uint2"sv, tokenid::uint2 },
+	{ "uint2x1"sv, tokenid::uint2 },
+	{ "uint2x2"sv, tokenid::uint2x2 },
+	{ "uint2x3"sv, tokenid::uint2x3 },
+	{ "uint2x4"sv, tokenid::uint2x4 },
+	{ "uint3"sv, tokenid::uint3 },
+	{ "uint3x1"sv, tokenid::uint3 },
+	{ "uint3x2"sv, tokenid::uint3x2 },
+	{ "uint3x3"sv, tokenid::uint3x3 },
+	{ "uint3x4"sv, tokenid::uint3x4 },
+	{ "uint4"sv, tokenid::uint4 },
+	{ "uint4x1"sv, tokenid::uint4 },
+	{ "uint4x2"sv, tokenid::uint4x2 },
+	{ "uint4x3"sv, tokenid::uint4x3 },
+	{ "uint4x4"sv, tokenid::uint4x4 },
+	{ "uniform"sv, tokenid::uniform_ },
+	{ "union"sv, tokenid::reserved },
+	{ "unorm"sv, tokenid::reserved },
+	{ "unsigned"sv, tokenid::reserved },
+	{ "using"sv, tokenid::reserved },
+	{ "vector"sv, tokenid::vector },
+	{ "virtual"sv, tokenid::reserved },
+	{ "void"sv, tokenid::void_ },
+	{ "volatile"sv, tokenid::volatile_ },
+	{ "while"sv, tokenid::while_ }
 };
-static const std::unordered_map<std::string_view, tokenid> s_pp_directive_lookup = {
-	{ "define", tokenid::hash_def },
-	{ "undef", tokenid::hash_undef },
-	{ "if", tokenid::hash_if },
-	{ "ifdef", tokenid::hash_ifdef },
-	{ "ifndef", tokenid::hash_ifndef },
-	{ "else", tokenid::hash_else },
-	{ "elif", tokenid::hash_elif },
-	{ "endif", tokenid::hash_endif },
-	{ "error", tokenid::hash_error },
-	{ "warning", tokenid::hash_warning },
-	{ "pragma", tokenid::hash_pragma },
-	{ "include", tokenid::hash_include },
+static constexpr std::pair<std::string_view, tokenid> s_pp_directives[] = {
+	{ "define"sv, tokenid::hash_def },
+	{ "undef"sv, tokenid::hash_undef },
+	{ "if"sv, tokenid::hash_if },
+	{ "ifdef"sv, tokenid::hash_ifdef },
+	{ "ifndef"sv, tokenid::hash_ifndef },
+	{ "else"sv, tokenid::hash_else },
+	{ "elif"sv, tokenid::hash_elif },
+	{ "endif"sv, tokenid::hash_endif },
+	{ "error"sv, tokenid::hash_error },
+	{ "warning"sv, tokenid::hash_warning },
+	{ "pragma"sv, tokenid::hash_pragma },
+	{ "include"sv, tokenid::hash_include },
 };
 
+/// <summary>
+/// A perfect hash table over a fixed set of strings, using the "hash and displace" scheme.
+/// Every string is first assigned to a bucket, then each bucket is given a displacement value that moves all its strings to otherwise unused slots, so that a lookup needs exactly one hash and one string compare.
+/// </summary>
+template <size_t num_keys, size_t num_buckets, size_t num_slots>
+class perfect_hash_table
+{
+	static_assert(num_keys < 0xFFFF && (num_slots & (num_slots - 1)) == 0, "number of slots has to be a power of two");
+
+public:
+	/// <summary>
+	/// Builds the table from displacement values that were computed ahead of time with <see cref="compute_displacements"/>.
+	/// This only takes a single pass over the keys, so that it stays well below the step limits compilers impose on constant evaluation.
+	/// </summary>
+	constexpr perfect_hash_table(const std::pair<std::string_view, tokenid>(&keys)[num_keys], const uint16_t(&displacements)[num_buckets]) :
+		_keys(keys), _displacements(), _slots()
+	{
+		for (size_t b = 0; b < num_buckets; ++b)
+			_displacements[b] = displacements[b];
+
+		// Slots store the key index plus one, so that zero-initialization already marks all of them as empty
+		for (size_t i = 0; i < num_keys; ++i)
+		{
+			const uint32_t h = hash(keys[i].first);
+			const uint32_t slot = slot_index(h, displacements[h % num_buckets]);
+			if (_slots[slot] != 0)
+				_valid = false; // Displacements do not match the keys anymore
+			else
+				_slots[slot] = static_cast<uint16_t>(i + 1);
+		}
+	}
+
+	/// <summary>
+	/// Checks whether every key was placed in a slot of its own, i.e. whether the displacement values match the keys.
+	/// </summary>
+	constexpr bool valid() const { return _valid; }
+
+	/// <summary>
+	/// Searches displacement values that place every key in a slot of its own.
+	/// This is too expensive to evaluate at compile time, so call it and paste the result into the source whenever the keys change.
+	/// </summary>
+	static void compute_displacements(const std::pair<std::string_view, tokenid>(&keys)[num_keys], uint16_t(&displacements)[num_buckets])
+	{
+		uint32_t hashes[num_keys] = {};
+		for (size_t i = 0; i < num_keys; ++i)
+			hashes[i] = hash(keys[i].first);
+
+		// Sort keys by bucket, so that all keys of a bucket are next to each other
+		size_t bucket_sizes[num_buckets] = {};
+		for (size_t i = 0; i < num_keys; ++i)
+			bucket_sizes[hashes[i] % num_buckets]++;
+		size_t bucket_offsets[num_buckets + 1] = {};
+		for (size_t b = 0; b < num_buckets; ++b)
+			bucket_offsets[b + 1] = bucket_offsets[b] + bucket_sizes[b];
+		size_t sorted_keys[num_keys] = {};
+		size_t bucket_fill[num_buckets] = {};
+		for (size_t i = 0; i < num_keys; ++i)
+		{
+			const size_t b = hashes[i] % num_buckets;
+			sorted_keys[bucket_offsets[b] + bucket_fill[b]++] = i;
+		}
+
+		size_t max_bucket_size = 0;
+		for (size_t b = 0; b < num_buckets; ++b)
+			max_bucket_size = bucket_sizes[b] > max_bucket_size ? bucket_sizes[b] : max_bucket_size;
+
+		bool used_slots[num_slots] = {};
+
+		// Place the largest buckets first, while there are still many free slots
+		for (size_t bucket_size = max_bucket_size; bucket_size != 0; --bucket_size)
+		{
+			for (size_t b = 0; b < num_buckets; ++b)
+			{
+				if (bucket_sizes[b] != bucket_size)
+					continue;
+
+				uint32_t displacement = 0;
+				for (bool placed = false; !placed; )
+				{
+					placed = true;
+
+					for (size_t k = bucket_offsets[b]; k < bucket_offsets[b + 1] && placed; ++k)
+					{
+						const uint32_t slot = slot_index(hashes[sorted_keys[k]], displacement);
+						if (used_slots[slot])
+							placed = false;
+						// Keys in the same bucket must not end up in the same slot either
+						for (size_t j = bucket_offsets[b]; j < k; ++j)
+							if (slot_index(hashes[sorted_keys[j]], displacement) == slot)
+								placed = false;
+					}
+
+					if (!placed)
+						displacement++;
+				}
+
+				displacements[b] = static_cast<uint16_t>(displacement);
+
+				for (size_t k = bucket_offsets[b]; k < bucket_offsets[b + 1]; ++k)
+					used_slots[slot_index(hashes[sorted_keys[k]], displacement)] = true;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Looks up the token associated with the specified string.
+	/// </summary>
+	/// <returns>The associated token, or <paramref name="default_id"/> if the string is not part of the table.</returns>
+	tokenid find(std::string_view name, tokenid default_id) const
+	{
+		const uint32_t h = hash(name);
+		const uint16_t index = _slots[slot_index(h, _displacements[h % num_buckets])];
+		return index != 0 && _keys[index - 1].first == name ? _keys[index - 1].second : default_id;
+	}
+
+private:
+	static constexpr uint32_t hash(std::string_view name)
+	{
+		// FNV-1a
+		uint32_t h = 2166136261u;
+		for (const char *c = name.data(), *const end = c + name.size(); c != end; ++c)
+			h = (h ^ static_cast<uint8_t>(*c)) * 16777619u;
+		return h;
+	}
+	static constexpr uint32_t slot_index(uint32_t h, uint32_t displacement)
+	{
+		h ^= displacement * 0x9E3779B1u;
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		return h & (num_slots - 1);
+	}
+
+	const std::pair<std::string_view, tokenid> *_keys;
+	uint16_t _displacements[num_buckets];
+	uint16_t _slots[num_slots];
+	bool _valid = true;
+};
+
+// Displacement values generated with 'perfect_hash_table::compute_displacements' for the keyword and directive lists above
+static constexpr uint16_t s_keyword_displacements[std::size(s_keywords) / 2] = {
+	0, 2, 0, 0, 2, 0, 0, 0, 0, 0, 0, 1, 1, 0, 2, 0,
+	2, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+	1, 0, 1, 0, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 1, 0, 0, 3, 0, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1,
+	0, 1,
+};
+static constexpr uint16_t s_pp_directive_displacements[8] = {
+	3, 1, 0, 0, 0, 1, 1, 0,
+};
+
+static constexpr perfect_hash_table<std::size(s_keywords), std::size(s_keywords) / 2, 1024> s_keyword_lookup(s_keywords, s_keyword_displacements);
+static constexpr perfect_hash_table<std::size(s_pp_directives), 8, 32> s_pp_directive_lookup(s_pp_directives, s_pp_directive_displacements);
+static_assert(s_keyword_lookup.valid(), "keyword displacements are out of date, regenerate them with 'perfect_hash_table::compute_displacements'");
+static_assert(s_pp_directive_lookup.valid(), "pre-processor directive displacements are out of date, regenerate them with 'perfect_hash_table::compute_displacements'");
+
 static bool is_octal_digit(char c)
 {
 	return static_cast<unsigned>(c - '0') < 8;
@@ -566,7 +729,8 @@ std::string reshadefx::token::id_to_name(tokenid id)
 	return "unknown";
 }
 
-reshadefx::token reshadefx::lexer::lex()
+template <bool ignore_comments, bool ignore_whitespace, bool ignore_pp_directives, bool ignore_keywords>
+reshadefx::token reshadefx::lexer::lex_impl()
 {
 	bool is_at_line_begin = _cur_location.column <= 1;
 
@@ -577,7 +741,7 @@ next_token:
 	tok.offset = input_offset();
 	tok.length = 1;
 	tok.literal_as_double = 0;
-	tok.literal_as_string.clear();
+	tok.literal_as_string = {};
 
 	assert(_cur <= _end);
 
@@ -589,7 +753,7 @@ next_token:
 		return tok;
 	case SPACE:
 		skip_space();
-		if (_ignore_whitespace || is_at_line_begin || *_cur == '\n')
+		if (ignore_whitespace || is_at_line_begin || *_cur == '\n')
 			goto next_token;
 		tok.id = tokenid::space;
 		tok.length = input_offset() - tok.offset;
@@ -599,7 +763,7 @@ next_token:
 		_cur_location.line++;
 		_cur_location.column = 1;
 		is_at_line_begin = true;
-		if (_ignore_whitespace)
+		if constexpr (ignore_whitespace)
 			goto next_token;
 		tok.id = tokenid::end_of_line;
 		return tok;
@@ -608,6 +772,8 @@ next_token:
 		break;
 	case IDENT:
 		parse_identifier(tok);
+		if constexpr (!ignore_keywords)
+			tok.id = s_keyword_lookup.find(tok.literal_as_string, tokenid::identifier);
 		break;
 	case '!':
 		if (_cur[1] == '=')
@@ -622,7 +788,7 @@ next_token:
 	case '#':
 		if (is_at_line_begin)
 		{
-			if (!parse_pp_directive(tok) || _ignore_pp_directives)
+			if (!parse_pp_directive(tok) || ignore_pp_directives)
 			{
 				skip_to_next_line();
 				goto next_token;
@@ -703,7 +869,7 @@ next_token:
 		if (_cur[1] == '/')
 		{
 			skip_to_next_line();
-			if (_ignore_comments)
+			if constexpr (ignore_comments)
 				goto next_token;
 			tok.id = tokenid::single_line_comment;
 			tok.length = input_offset() - tok.offset;
@@ -725,7 +891,7 @@ next_token:
 				}
 				skip(1);
 			}
-			if (_ignore_comments)
+			if constexpr (ignore_comments)
 				goto next_token;
 			tok.id = tokenid::multi_line_comment;
 			tok.length = input_offset() - tok.offset;
@@ -796,7 +962,7 @@ next_token:
 		{
 			// Skip to next line if current line ends with a backslash
 			skip_space();
-			if (_ignore_whitespace)
+			if constexpr (ignore_whitespace)
 				goto next_token;
 			tok.id = tokenid::space;
 			tok.length = input_offset() - tok.offset;
@@ -843,6 +1009,31 @@ next_token:
 	return tok;
 }
 
+reshadefx::token (reshadefx::lexer::*reshadefx::lexer::select_lex_impl(bool ignore_comments, bool ignore_whitespace, bool ignore_pp_directives, bool ignore_keywords))()
+{
+	// Instantiate the lexer for every combination of flags, so that none of them have to be checked per character in the hot path
+	static constexpr token (lexer::*const variants[16])() = {
+		&lexer::lex_impl<false, false, false, false>,
+		&lexer::lex_impl<false, false, false, true>,
+		&lexer::lex_impl<false, false, true, false>,
+		&lexer::lex_impl<false, false, true, true>,
+		&lexer::lex_impl<false, true, false, false>,
+		&lexer::lex_impl<false, true, false, true>,
+		&lexer::lex_impl<false, true, true, false>,
+		&lexer::lex_impl<false, true, true, true>,
+		&lexer::lex_impl<true, false, false, false>,
+		&lexer::lex_impl<true, false, false, true>,
+		&lexer::lex_impl<true, false, true, false>,
+		&lexer::lex_impl<true, false, true, true>,
+		&lexer::lex_impl<true, true, false, false>,
+		&lexer::lex_impl<true, true, false, true>,
+		&lexer::lex_impl<true, true, true, false>,
+		&lexer::lex_impl<true, true, true, true>,
+	};
+
+	return variants[(ignore_comments ? 8 : 0) | (ignore_whitespace ? 4 : 0) | (ignore_pp_directives ? 2 : 0) | (ignore_keywords ? 1 : 0)];
+}
+
 void reshadefx::lexer::skip(size_t length)
 {
 	_cur += length;
@@ -888,8 +1079,8 @@ void reshadefx::lexer::skip_to_next_line()
 
 void reshadefx::lexer::reset_to_offset(size_t offset)
 {
-	assert(offset < _input.size());
-	_cur = _input.data() + offset;
+	assert(offset < _input->size());
+	_cur = _input->data() + offset;
 }
 
 void reshadefx::lexer::parse_identifier(token &tok) const
@@ -903,14 +1094,7 @@ void reshadefx::lexer::parse_identifier(token &tok) const
 	tok.id = tokenid::identifier;
 	tok.offset = input_offset();
 	tok.length = end - begin;
-	tok.literal_as_string.assign(begin, end);
-
-	if (_ignore_keywords)
-		return;
-
-	if (const auto it = s_keyword_lookup.find(tok.literal_as_string);
-		it != s_keyword_lookup.end())
-		tok.id = it->second;
+	tok.literal_as_string = std::string_view(begin, end - begin);
 }
 bool reshadefx::lexer::parse_pp_directive(token &tok)
 {
@@ -918,10 +1102,9 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 	skip_space(); // Skip any space between the '#' and directive
 	parse_identifier(tok);
 
-	if (const auto it = s_pp_directive_lookup.find(tok.literal_as_string);
-		it != s_pp_directive_lookup.end())
+	if (tok.id = s_pp_directive_lookup.find(tok.literal_as_string, tokenid::unknown);
+		tok.id != tokenid::unknown)
 	{
-		tok.id = it->second;
 		return true;
 	}
 	else if (!_ignore_line_directives && tok.literal_as_string == "line") // The #line directive needs special handling
@@ -945,7 +1128,7 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 			token temptok;
 			parse_string_literal(temptok, false);
 
-			_cur_location.source = std::move(temptok.literal_as_string);
+			_cur_location.source = temptok.literal_as_string;
 		}
 
 		// Do not return the #line directive as token to the caller
@@ -959,6 +1142,16 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 {
 	auto *const begin = _cur, *end = begin + 1; // Skip first quote character right away
+	auto *value_end = end;
+
+	// Most string literals are the same as their input text, so only build a separate value string once the first character is found that needs to be transformed
+	std::string value;
+	bool value_is_input = true;
+	const auto copy_input_to_value = [&]() {
+		if (value_is_input)
+			value.assign(begin + 1, end);
+		value_is_input = false;
+	};
 
 	for (auto c = *end; c != '"'; c = *++end)
 	{
@@ -973,6 +1166,7 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 		if (c == '\r')
 		{
 			// Silently ignore carriage return characters
+			copy_input_to_value();
 			continue;
 		}
 
@@ -980,6 +1174,7 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 			c == '\\' && end[n] == '\n')
 		{
 			// Escape character found at end of line, the string literal continues on to the next line
+			copy_input_to_value();
 			end += n;
 			_cur_location.line++;
 			continue;
@@ -988,6 +1183,8 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 		// Handle escape sequences
 		if (c == '\\' && escape)
 		{
+			copy_input_to_value();
+
 			unsigned int n = 0;
 
 			// Any character following the '\' is not parsed as usual, so increment pointer here (this makes sure '\"' does not abort the outer loop as well)
@@ -1050,14 +1247,24 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 			}
 		}
 
-		tok.literal_as_string += c;
+		if (value_is_input)
+			value_end = end + 1;
+		else
+			value += c;
 	}
 
 	tok.id = tokenid::string_literal;
 	tok.length = end - begin + 1;
 
-	// Free up unused memory
-	tok.literal_as_string.shrink_to_fit();
+	if (value_is_input)
+	{
+		tok.literal_as_string = std::string_view(begin + 1, value_end - (begin + 1));
+	}
+	else
+	{
+		tok.literal_storage = std::make_shared<const std::string>(std::move(value));
+		tok.literal_as_string = *tok.literal_storage;
+	}
 }
 void reshadefx::lexer::parse_numeric_literal(token &tok) const
 {
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "effect_token.hpp"
+#include <memory> // std::make_shared, std::shared_ptr
 
 namespace reshadefx
 {
@@ -15,8 +16,12 @@ namespace reshadefx
 	class lexer
 	{
 	public:
+		/// <summary>
+		/// Creates a lexical analyzer over the specified shared <paramref name="input"/> buffer.
+		/// The buffer is not copied and has to stay unmodified, since the tokens returned by <see cref="lex"/> point into it.
+		/// </summary>
 		explicit lexer(
-			std::string input,
+			std::shared_ptr<const std::string> input,
 			bool ignore_comments = true,
 			bool ignore_whitespace = true,
 			bool ignore_pp_directives = true,
@@ -31,45 +36,48 @@ namespace reshadefx
 			_ignore_pp_directives(ignore_pp_directives),
 			_ignore_line_directives(ignore_line_directives),
 			_ignore_keywords(ignore_keywords),
-			_escape_string_literals(escape_string_literals)
+			_escape_string_literals(escape_string_literals),
+			_lex_impl(select_lex_impl(ignore_comments, ignore_whitespace, ignore_pp_directives, ignore_keywords))
 		{
-			_cur = _input.data();
-			_end = _cur + _input.size();
+			_cur = _input->data();
+			_end = _cur + _input->size();
 		}
-
-		lexer(const lexer &lexer) { operator=(lexer); }
-		lexer &operator=(const lexer &lexer)
+		/// <summary>
+		/// Creates a lexical analyzer that takes ownership of the specified <paramref name="input"/> string.
+		/// </summary>
+		explicit lexer(
+			std::string input,
+			bool ignore_comments = true,
+			bool ignore_whitespace = true,
+			bool ignore_pp_directives = true,
+			bool ignore_line_directives = false,
+			bool ignore_keywords = false,
+			bool escape_string_literals = true,
+			const location &start_location = location()) :
+			lexer(std::make_shared<const std::string>(std::move(input)), ignore_comments, ignore_whitespace, ignore_pp_directives, ignore_line_directives, ignore_keywords, escape_string_literals, start_location)
 		{
-			_input = lexer._input;
-			_cur_location = lexer._cur_location;
-			reset_to_offset(lexer._cur - lexer._input.data());
-			_end = _input.data() + _input.size();
-			_ignore_comments = lexer._ignore_comments;
-			_ignore_whitespace = lexer._ignore_whitespace;
-			_ignore_pp_directives = lexer._ignore_pp_directives;
-			_ignore_keywords = lexer._ignore_keywords;
-			_escape_string_literals = lexer._escape_string_literals;
-			_ignore_line_directives = lexer._ignore_line_directives;
-
-			return *this;
 		}
 
 		/// <summary>
 		/// Gets the current position in the input string.
 		/// </summary>
-		size_t input_offset() const { return _cur - _input.data(); }
+		size_t input_offset() const { return _cur - _input->data(); }
 
 		/// <summary>
 		/// Gets the input string this lexical analyzer works on.
 		/// </summary>
 		/// <returns>Constant reference to the input string.</returns>
-		const std::string &input_string() const { return _input; }
+		const std::string &input_string() const { return *_input; }
+		/// <summary>
+		/// Gets the shared input buffer this lexical analyzer works on.
+		/// </summary>
+		const std::shared_ptr<const std::string> &input_buffer() const { return _input; }
 
 		/// <summary>
 		/// Performs lexical analysis on the input string and return the next token in sequence.
 		/// </summary>
 		/// <returns>Next token from the input string.</returns>
-		token lex();
+		token lex() { return (this->*_lex_impl)(); }
 
 		/// <summary>
 		/// Advances to the next token that is not whitespace.
@@ -87,6 +95,10 @@ namespace reshadefx
 		void reset_to_offset(size_t offset);
 
 	private:
+		template <bool ignore_comments, bool ignore_whitespace, bool ignore_pp_directives, bool ignore_keywords>
+		token lex_impl();
+		static token (lexer::*select_lex_impl(bool ignore_comments, bool ignore_whitespace, bool ignore_pp_directives, bool ignore_keywords))();
+
 		/// <summary>
 		/// Skips an arbitrary amount of characters in the input string.
 		/// </summary>
@@ -98,7 +110,7 @@ namespace reshadefx
 		void parse_string_literal(token &tok, bool escape);
 		void parse_numeric_literal(token &tok) const;
 
-		std::string _input;
+		std::shared_ptr<const std::string> _input;
 		location _cur_location;
 		const std::string::value_type *_cur, *_end;
 
@@ -108,5 +120,6 @@ namespace reshadefx
 		bool _ignore_line_directives;
 		bool _ignore_keywords;
 		bool _escape_string_literals;
+		token (lexer::*_lex_impl)();
 	};
 }
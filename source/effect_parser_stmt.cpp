@@ -70,7 +70,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 		if (!expect('(') || !expect(tokenid::string_literal))
 			return false;
 
-		_codegen->emit_pragma(_token.literal_as_string);
+		_codegen->emit_pragma(std::string(_token.literal_as_string));
 
 		if (!expect(')'))
 			return false;
@@ -82,7 +82,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 		if (!expect(tokenid::identifier))
 			return false;
 
-		const std::string name = std::move(_token.literal_as_string);
+		const std::string name(_token.literal_as_string);
 
 		if (!expect('{'))
 			return false;
@@ -131,7 +131,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 			if (!expect(tokenid::identifier))
 				return false;
 
-			const std::string attribute = std::move(_token.literal_as_string);
+			const std::string attribute(_token.literal_as_string);
 
 			if (attribute == "shader")
 			{
@@ -197,7 +197,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 
 			if (peek('('))
 			{
-				const std::string name = std::move(_token.literal_as_string);
+				const std::string name(_token.literal_as_string);
 
 				// This is definitely a function declaration, so parse it
 				if (!parse_function(type, name, stype, num_threads))
@@ -226,7 +226,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 						return false;
 					}
 
-					const std::string name = std::move(_token.literal_as_string);
+					const std::string name(_token.literal_as_string);
 
 					if (!parse_variable(type, name, true))
 					{
@@ -287,7 +287,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 			switch_call = (0x8 << 4)
 		};
 
-		const std::string attribute = std::move(_token_next.literal_as_string);
+		const std::string attribute(_token_next.literal_as_string);
 
 		if (!expect(tokenid::identifier) || !expect(']'))
 			return false;
@@ -542,7 +542,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 					if (count++ > 0 && !expect(','))
 						return false;
 
-					if (!expect(tokenid::identifier) || !parse_variable(type, std::move(_token.literal_as_string)))
+					if (!expect(tokenid::identifier) || !parse_variable(type, std::string(_token.literal_as_string)))
 						return false;
 				}
 				while (!peek(';'));
@@ -897,7 +897,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 				return false;
 			}
 
-			if (!expect(tokenid::identifier) || !parse_variable(type, std::move(_token.literal_as_string)))
+			if (!expect(tokenid::identifier) || !parse_variable(type, std::string(_token.literal_as_string)))
 			{
 				consume_until(';');
 				return false;
@@ -1046,7 +1046,7 @@ bool reshadefx::parser::parse_annotations(std::vector<annotation> &annotations)
 			return false;
 		}
 
-		std::string name = std::move(_token.literal_as_string);
+		std::string name(_token.literal_as_string);
 
 		expression annotation_exp;
 		if (!expect('=') || !parse_expression_multary(annotation_exp) || !expect(';'))
@@ -1076,7 +1076,7 @@ bool reshadefx::parser::parse_struct()
 	struct_type info;
 	// The structure name is optional
 	if (accept(tokenid::identifier))
-		info.name = std::move(_token.literal_as_string);
+		info.name = _token.literal_as_string;
 	else
 		info.name = "_anonymous_struct_" + std::to_string(struct_location.line) + '_' + std::to_string(struct_location.column);
 
@@ -1110,7 +1110,7 @@ bool reshadefx::parser::parse_struct()
 				return false;
 			}
 
-			member.name = std::move(_token.literal_as_string);
+			member.name = _token.literal_as_string;
 			member.location = std::move(_token.location);
 
 			if (member.type.is_void())
@@ -1179,7 +1179,7 @@ bool reshadefx::parser::parse_struct()
 					return false;
 				}
 
-				member.semantic = std::move(_token.literal_as_string);
+				member.semantic = _token.literal_as_string;
 				// Make semantic upper case to simplify comparison later on
 				std::transform(member.semantic.begin(), member.semantic.end(), member.semantic.begin(),
 					[](std::string::value_type c) {
@@ -1306,7 +1306,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 			break;
 		}
 
-		param.name = std::move(_token.literal_as_string);
+		param.name = _token.literal_as_string;
 		param.location = std::move(_token.location);
 
 		if (param.type.is_void())
@@ -1373,7 +1373,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 				break;
 			}
 
-			param.semantic = std::move(_token.literal_as_string);
+			param.semantic = _token.literal_as_string;
 			// Make semantic upper case to simplify comparison later on
 			std::transform(param.semantic.begin(), param.semantic.end(), param.semantic.begin(),
 				[](std::string::value_type c) {
@@ -1450,7 +1450,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 			return false;
 		}
 
-		info.return_semantic = std::move(_token.literal_as_string);
+		info.return_semantic = _token.literal_as_string;
 		// Make semantic upper case to simplify comparison later on
 		std::transform(info.return_semantic.begin(), info.return_semantic.end(), info.return_semantic.begin(),
 			[](std::string::value_type c) {
@@ -1608,7 +1608,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		}
 
 		std::string &semantic = texture_info.semantic;
-		semantic = std::move(_token.literal_as_string);
+		semantic = _token.literal_as_string;
 
 		// Make semantic upper case to simplify comparison later on
 		std::transform(semantic.begin(), semantic.end(), semantic.begin(),
@@ -1704,7 +1704,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 				}
 
 				location property_location = std::move(_token.location);
-				const std::string property_name = std::move(_token.literal_as_string);
+				const std::string property_name(_token.literal_as_string);
 
 				if (!expect('='))
 				{
@@ -1719,7 +1719,8 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 				if (accept(tokenid::identifier)) // Handle special enumeration names for property values
 				{
 					// Transform identifier to uppercase to do case-insensitive comparison
-					std::transform(_token.literal_as_string.begin(), _token.literal_as_string.end(), _token.literal_as_string.begin(),
+					std::string enum_name(_token.literal_as_string);
+					std::transform(enum_name.begin(), enum_name.end(), enum_name.begin(),
 						[](std::string::value_type c) {
 							return static_cast<std::string::value_type>(std::toupper(c));
 						});
@@ -1753,7 +1754,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 					};
 
 					// Look up identifier in list of possible enumeration names
-					if (const auto it = s_enum_values.find(_token.literal_as_string);
+					if (const auto it = s_enum_values.find(enum_name);
 						it != s_enum_values.end())
 						property_exp.reset_to_rvalue_constant(_token.location, it->second);
 					else // No match found, so rewind to parser state before the identifier was consumed and try parsing it as a normal expression
@@ -2088,7 +2089,7 @@ bool reshadefx::parser::parse_technique()
 		return false;
 
 	technique info;
-	info.name = std::move(_token.literal_as_string);
+	info.name = _token.literal_as_string;
 
 	bool parse_success = parse_annotations(info.annotations);
 
@@ -2126,7 +2127,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 
 	// Passes can have an optional name
 	if (accept(tokenid::identifier))
-		info.name = std::move(_token.literal_as_string);
+		info.name = _token.literal_as_string;
 
 	bool parse_success = true;
 	bool targets_support_srgb = true;
@@ -2145,7 +2146,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 		}
 
 		location state_location = std::move(_token.location);
-		const std::string state_name = std::move(_token.literal_as_string);
+		const std::string state_name(_token.literal_as_string);
 
 		if (!expect('='))
 		{
@@ -2365,7 +2366,8 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 			if (accept(tokenid::identifier)) // Handle special enumeration names for pass states
 			{
 				// Transform identifier to uppercase to do case-insensitive comparison
-				std::transform(_token.literal_as_string.begin(), _token.literal_as_string.end(), _token.literal_as_string.begin(),
+				std::string enum_name(_token.literal_as_string);
+				std::transform(enum_name.begin(), enum_name.end(), enum_name.begin(),
 					[](std::string::value_type c) {
 						return static_cast<std::string::value_type>(std::toupper(c));
 					});
@@ -2411,7 +2413,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 				};
 
 				// Look up identifier in list of possible enumeration names
-				if (const auto it = s_enum_values.find(_token.literal_as_string);
+				if (const auto it = s_enum_values.find(enum_name);
 					it != s_enum_values.end())
 					state_exp.reset_to_rvalue_constant(_token.location, it->second);
 				else // No match found, so rewind to parser state before the identifier was consumed and try parsing it as a normal expression
@@ -4,11 +4,12 @@
  */
 
 #include "effect_lexer.hpp"
+#include "effect_file_cache.hpp"
 #include "effect_preprocessor.hpp"
 #include <limits>
-#include <cstdio> // fclose, fopen, fread, fseek
 #include <cassert>
-#include <algorithm> // std::find_if
+#include <cstring> // std::memcpy
+#include <algorithm> // std::find_if, std::replace_if, std::sort
 
 #ifndef _WIN32
 	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
@@ -62,43 +63,6 @@ static const int s_precedence_lookup[] = {
 	11, 11, 11, 11 // unary operators
 };
 
-static bool read_file(const std::filesystem::path &path, std::string &file_data)
-{
-	// Read file contents into memory
-#ifndef _WIN32
-	FILE *const file = fopen(path.c_str(), "rb");
-#else
-	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYWR);
-#endif
-	if (file == nullptr)
-		return false;
-
-	fseek(file, 0, SEEK_END);
-	const size_t file_size = ftell(file);
-	fseek(file, 0, SEEK_SET);
-
-	file_data.resize(file_size + 1, '\0'); // One additional character at the end for new line feed set below
-	const size_t file_size_read = fread(file_data.data(), 1, file_size, file);
-
-	// No longer need to have a handle open to the file, since all data was read, so can safely close it
-	fclose(file);
-
-	if (file_size_read != file_size)
-		return false;
-
-	// Append a new line feed to the end of the input string to avoid issues with parsing
-	file_data.back() = '\n';
-
-	// Remove UTF-8 BOM (0xEFBBBF is the UTF-8 byte sequence for the character 0xFEFF)
-	if (file_data.size() >= 3 &&
-		static_cast<unsigned char>(file_data[0]) == 0xEF &&
-		static_cast<unsigned char>(file_data[1]) == 0xBB &&
-		static_cast<unsigned char>(file_data[2]) == 0xBF)
-		file_data.erase(0, 3);
-
-	return true;
-}
-
 template <char ESCAPE_CHAR = '\\'>
 static std::string escape_string(std::string s)
 {
@@ -137,11 +101,12 @@ bool reshadefx::preprocessor::add_macro_definition(const std::string &name, cons
 
 bool reshadefx::preprocessor::append_file(const std::filesystem::path &path)
 {
-	std::string source_code;
-	if (!read_file(path, source_code))
+	// Files are shared with all other pre-processor instances, so this does not copy the contents when they were read before
+	std::shared_ptr<const std::string> source_code = file_cache::instance().read(path);
+	if (source_code == nullptr)
 		return false;
 
-	return append_string(std::move(source_code), path);
+	return append(std::move(source_code), path);
 }
 bool reshadefx::preprocessor::append_string(std::string source_code, const std::filesystem::path &path)
 {
@@ -149,6 +114,10 @@ bool reshadefx::preprocessor::append_string(std::string source_code, const std::
 	if (source_code.empty() || source_code.back() != '\n')
 		return false;
 
+	return append(std::make_shared<const std::string>(std::move(source_code)), path);
+}
+bool reshadefx::preprocessor::append(std::shared_ptr<const std::string> source_code, const std::filesystem::path &path)
+{
 	// Only consider new errors added below for the success of this call
 	const size_t errors_offset = _errors.length();
 
@@ -161,12 +130,212 @@ bool reshadefx::preprocessor::append_string(std::string source_code, const std::
 	return _errors.find(": preprocessor error: ", errors_offset) == std::string::npos;
 }
 
+bool reshadefx::preprocessor::split_include_prefix(const std::filesystem::path &path, std::string &include_prefix, std::string &source_code)
+{
+	const std::shared_ptr<const std::string> file_data = file_cache::instance().read(path);
+	if (file_data == nullptr)
+		return false;
+
+	// The cached contents are shared, so need to work on a copy here, since the prefix is blanked out below
+	source_code = *file_data;
+
+	const auto trim_front = [](std::string_view &line) {
+		while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+			line.remove_prefix(1);
+	};
+
+	size_t prefix_length = 0;
+
+	for (size_t offset = 0, next; (next = source_code.find('\n', offset)) != std::string::npos; offset = next + 1)
+	{
+		std::string_view line(source_code.data() + offset, next - offset);
+		while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r'))
+			line.remove_suffix(1);
+		trim_front(line);
+
+		// Skip empty lines and single-line comments, but stop at anything else that could affect the pre-processor state (including multi-line comments and line continuations)
+		if (line.empty() || (line.compare(0, 2, "//") == 0 && line.back() != '\\'))
+			continue;
+
+		if (line.front() != '#')
+			break;
+		line.remove_prefix(1);
+		trim_front(line);
+
+		if (line.compare(0, 7, "include") != 0)
+			break;
+		line.remove_prefix(7);
+		trim_front(line);
+
+		// Only accept plain file names, since macros used in the directive could be defined differently later on
+		if (line.size() < 2 || line.front() != '\"')
+			break;
+		if (const size_t path_end = line.find('\"', 1);
+			path_end != std::string_view::npos)
+			line.remove_prefix(path_end + 1);
+		else
+			break;
+		trim_front(line);
+
+		if (!line.empty() && line.compare(0, 2, "//") != 0)
+			break;
+
+		prefix_length = next + 1;
+	}
+
+	include_prefix = source_code.substr(0, prefix_length);
+
+	std::replace_if(source_code.begin(), source_code.begin() + prefix_length, [](char c) { return c != '\n'; }, ' ');
+
+	return true;
+}
+
+static void write_uint32(std::string &data, uint32_t value)
+{
+	data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+static void write_string(std::string &data, const std::string &value)
+{
+	write_uint32(data, static_cast<uint32_t>(value.size()));
+	data.append(value);
+}
+static bool read_uint32(std::string_view &data, uint32_t &value)
+{
+	if (data.size() < sizeof(value))
+		return false;
+	std::memcpy(&value, data.data(), sizeof(value));
+	data.remove_prefix(sizeof(value));
+	return true;
+}
+static bool read_string(std::string_view &data, std::string &value)
+{
+	uint32_t size = 0;
+	if (!read_uint32(data, size) || data.size() < size)
+		return false;
+	value.assign(data.data(), size);
+	data.remove_prefix(size);
+	return true;
+}
+
+// Change this whenever the serialized format or the pre-processor output changes
+static constexpr uint32_t s_state_version = 2;
+
+std::string reshadefx::preprocessor::serialize_state() const
+{
+	assert(_input_stack.empty() && _if_stack.empty());
+
+	std::string data;
+	write_uint32(data, s_state_version);
+
+	write_uint32(data, static_cast<uint32_t>(_macros.size()));
+	for (const std::pair<const std::string, macro> &macro : _macros)
+	{
+		write_string(data, macro.first);
+		write_string(data, macro.second.replacement_list);
+		write_uint32(data, static_cast<uint32_t>(macro.second.parameters.size()));
+		for (const std::string &parameter : macro.second.parameters)
+			write_string(data, parameter);
+		write_uint32(data, (macro.second.is_predefined ? 0x1 : 0) | (macro.second.is_variadic ? 0x2 : 0) | (macro.second.is_function_like ? 0x4 : 0));
+	}
+
+	write_uint32(data, static_cast<uint32_t>(_used_macros.size()));
+	for (const std::string &name : _used_macros)
+		write_string(data, name);
+
+	write_string(data, _output);
+	write_string(data, _output_location.source);
+	write_uint32(data, _output_location.line);
+
+	// Only the names of included files are stored, their contents are read again when they are included another time
+	// Files that were cleared by '#pragma once' are marked, so that they stay cleared
+	write_uint32(data, static_cast<uint32_t>(_file_cache.size()));
+	for (const std::pair<const std::string, std::shared_ptr<const std::string>> &cache_entry : _file_cache)
+	{
+		write_string(data, cache_entry.first);
+		write_uint32(data, cache_entry.second != nullptr && cache_entry.second->empty() ? 1 : 0);
+	}
+
+	return data;
+}
+bool reshadefx::preprocessor::deserialize_state(std::string_view data)
+{
+	assert(_input_stack.empty() && _if_stack.empty());
+
+	uint32_t version = 0, count = 0, value = 0;
+	if (!read_uint32(data, version) || version != s_state_version)
+		return false;
+
+	std::unordered_map<std::string, macro> macros;
+	if (!read_uint32(data, count))
+		return false;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::string name;
+		macro definition;
+		uint32_t num_parameters = 0;
+		if (!read_string(data, name) || !read_string(data, definition.replacement_list) || !read_uint32(data, num_parameters))
+			return false;
+		definition.parameters.resize(std::min<uint32_t>(num_parameters, static_cast<uint32_t>(data.size())));
+		for (std::string &parameter : definition.parameters)
+			if (!read_string(data, parameter))
+				return false;
+		if (definition.parameters.size() != num_parameters || !read_uint32(data, value))
+			return false;
+		definition.is_predefined = (value & 0x1) != 0;
+		definition.is_variadic = (value & 0x2) != 0;
+		definition.is_function_like = (value & 0x4) != 0;
+
+		macros.emplace(std::move(name), std::move(definition));
+	}
+
+	std::unordered_set<std::string> used_macros;
+	if (!read_uint32(data, count))
+		return false;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::string name;
+		if (!read_string(data, name))
+			return false;
+		used_macros.insert(std::move(name));
+	}
+
+	std::string output;
+	location output_location;
+	if (!read_string(data, output) || !read_string(data, output_location.source) || !read_uint32(data, output_location.line))
+		return false;
+
+	std::unordered_map<std::string, std::shared_ptr<const std::string>> file_cache;
+	if (!read_uint32(data, count))
+		return false;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::string file_path_string;
+		if (!read_string(data, file_path_string) || !read_uint32(data, value))
+			return false;
+		file_cache.emplace(std::move(file_path_string), value != 0 ? std::make_shared<const std::string>() : nullptr);
+	}
+
+	// Reject truncated or otherwise corrupted data
+	if (!data.empty())
+		return false;
+
+	_macros = std::move(macros);
+	_used_macros = std::move(used_macros);
+	_output = std::move(output);
+	_output_location = std::move(output_location);
+	_file_cache = std::move(file_cache);
+
+	return true;
+}
+
 std::vector<std::filesystem::path> reshadefx::preprocessor::included_files() const
 {
 	std::vector<std::filesystem::path> files;
 	files.reserve(_file_cache.size());
-	for (const std::pair<std::string, std::string> &cache_entry : _file_cache)
+	for (const std::pair<const std::string, std::shared_ptr<const std::string>> &cache_entry : _file_cache)
 		files.push_back(std::filesystem::u8path(cache_entry.first));
+	// Sort so that the order does not depend on how the file cache was filled (e.g. after restoring a serialized state)
+	std::sort(files.begin(), files.end());
 	return files;
 }
 std::vector<std::pair<std::string, std::string>> reshadefx::preprocessor::used_macro_definitions() const
@@ -201,6 +370,10 @@ void reshadefx::preprocessor::warning(const location &location, const std::strin
 }
 
 void reshadefx::preprocessor::push(std::string input, const std::string &name)
+{
+	push(std::make_shared<const std::string>(std::move(input)), name);
+}
+void reshadefx::preprocessor::push(std::shared_ptr<const std::string> input, const std::string &name)
 {
 	location start_location = !name.empty() ?
 		// Start at the beginning of the file when pushing a new file
@@ -266,7 +439,9 @@ void reshadefx::preprocessor::consume()
 
 	// Set current token
 	_token = std::move(input.next_token);
-	_current_token_raw_data = input.lexer->input_string().substr(_token.offset, _token.length);
+	if (_current_token_input != input.lexer->input_buffer())
+		_current_token_input = input.lexer->input_buffer();
+	_current_token_raw_data = std::string_view(*_current_token_input).substr(_token.offset, _token.length);
 
 	// Get the next token
 	input.next_token = input.lexer->lex();
@@ -337,8 +512,8 @@ bool reshadefx::preprocessor::expect(tokenid tokid)
 		}
 		else
 		{
-			const std::string token_string = _input_stack[_next_input_index].lexer->input_string().substr(actual_token.offset, actual_token.length);
-			error(actual_token.location, "syntax error: unexpected token '" + token_string + '\'');
+			const std::string_view token_string = std::string_view(_input_stack[_next_input_index].lexer->input_string()).substr(actual_token.offset, actual_token.length);
+			error(actual_token.location, "syntax error: unexpected token '" + std::string(token_string) + '\'');
 		}
 
 		return false;
@@ -434,7 +609,7 @@ void reshadefx::preprocessor::parse()
 		case tokenid::hash_unknown:
 			// Standalone "#" is valid and should be ignored
 			if (_token.length != 0)
-				error(_token.location, "unrecognized preprocessing directive '" + _token.literal_as_string + '\'');
+				error(_token.location, "unrecognized preprocessing directive '" + std::string(_token.literal_as_string) + '\'');
 			if (!expect(tokenid::end_of_line))
 				consume_until(tokenid::end_of_line);
 			continue;
@@ -476,7 +651,7 @@ void reshadefx::preprocessor::parse_def()
 	const location location = std::move(_token.location);
 
 	macro definition;
-	const std::string macro_name = std::move(_token.literal_as_string);
+	const std::string macro_name(_token.literal_as_string);
 
 	// Only create function-like macro if the parenthesis follows the macro name without any whitespace between
 	if (accept(tokenid::parenthesis_open, false))
@@ -485,7 +660,7 @@ void reshadefx::preprocessor::parse_def()
 
 		while (accept(tokenid::identifier))
 		{
-			definition.parameters.push_back(_token.literal_as_string);
+			definition.parameters.emplace_back(_token.literal_as_string);
 
 			if (!accept(tokenid::comma))
 				break;
@@ -510,7 +685,7 @@ void reshadefx::preprocessor::parse_undef()
 	if (_token.literal_as_string == "defined")
 		return warning(_token.location, "macro name 'defined' is reserved");
 
-	_macros.erase(_token.literal_as_string);
+	_macros.erase(std::string(_token.literal_as_string));
 }
 
 void reshadefx::preprocessor::parse_if()
@@ -551,13 +726,15 @@ void reshadefx::preprocessor::parse_ifdef()
 	}
 	else
 	{
-		level.value = is_defined(_token.literal_as_string);
+		const std::string macro_name(_token.literal_as_string);
+
+		level.value = is_defined(macro_name);
 		level.skipping = !level.value;
 
 		// Only add to used macro list if this #ifdef is active and the macro was not defined before
-		if (const auto macro_it = _macros.find(_token.literal_as_string);
+		if (const auto macro_it = _macros.find(macro_name);
 			macro_it == _macros.end() || macro_it->second.is_predefined)
-			_used_macros.emplace(_token.literal_as_string);
+			_used_macros.emplace(macro_name);
 	}
 
 	_if_stack.push_back(std::move(level));
@@ -579,13 +756,15 @@ void reshadefx::preprocessor::parse_ifndef()
 	}
 	else
 	{
-		level.value = !is_defined(_token.literal_as_string);
+		const std::string macro_name(_token.literal_as_string);
+
+		level.value = !is_defined(macro_name);
 		level.skipping = !level.value;
 
 		// Only add to used macro list if this #ifndef is active and the macro was not defined before
-		if (const auto macro_it = _macros.find(_token.literal_as_string);
+		if (const auto macro_it = _macros.find(macro_name);
 			macro_it == _macros.end() || macro_it->second.is_predefined)
-			_used_macros.emplace(_token.literal_as_string);
+			_used_macros.emplace(macro_name);
 	}
 
 	_if_stack.push_back(std::move(level));
@@ -659,7 +838,7 @@ void reshadefx::preprocessor::parse_error()
 	if (!expect(tokenid::string_literal))
 		return;
 
-	error(keyword_location, _token.literal_as_string);
+	error(keyword_location, std::string(_token.literal_as_string));
 }
 void reshadefx::preprocessor::parse_warning()
 {
@@ -668,7 +847,7 @@ void reshadefx::preprocessor::parse_warning()
 	if (!expect(tokenid::string_literal))
 		return;
 
-	warning(keyword_location, _token.literal_as_string);
+	warning(keyword_location, std::string(_token.literal_as_string));
 }
 
 void reshadefx::preprocessor::parse_pragma()
@@ -678,7 +857,7 @@ void reshadefx::preprocessor::parse_pragma()
 	if (!expect(tokenid::identifier))
 		return;
 
-	std::string pragma = std::move(_token.literal_as_string);
+	std::string pragma(_token.literal_as_string);
 
 	while (!peek(tokenid::end_of_line) && !peek(tokenid::end_of_file))
 	{
@@ -700,7 +879,7 @@ void reshadefx::preprocessor::parse_pragma()
 		if (const auto file_it = _file_cache.find(_output_location.source);
 			file_it != _file_cache.end())
 		{
-			file_it->second.clear();
+			file_it->second = std::make_shared<const std::string>();
 		}
 		return;
 	}
@@ -748,19 +927,22 @@ void reshadefx::preprocessor::parse_include()
 			}) != _input_stack.end())
 		return error(_token.location, "recursive #include");
 
-	std::string input;
+	std::shared_ptr<const std::string> input;
 
+	// Entries without contents were restored by 'deserialize_state', so need to read the file again
 	if (const auto file_it = _file_cache.find(file_path_string);
-		file_it != _file_cache.end())
+		file_it != _file_cache.end() && file_it->second != nullptr)
 	{
 		input = file_it->second;
 	}
 	else
 	{
-		if (!read_file(file_path, input))
+		// The process-wide cache and the lexer share the same buffer, so includes of the same file (even across pre-processor instances) do not read or copy its contents again
+		input = file_cache::instance().read(file_path);
+		if (input == nullptr)
 			return error(keyword_location, "could not open included file '" + file_name.u8string() + '\'');
 
-		_file_cache.emplace(file_path_string, input);
+		_file_cache.insert_or_assign(file_path_string, input);
 	}
 
 	// Skip end of line character following the include statement before pushing, so that the line number is already pointing to the next line when popping out of it again
@@ -949,7 +1131,7 @@ bool reshadefx::preprocessor::evaluate_expression()
 				if (!expect(tokenid::identifier))
 					return false;
 
-				const std::string macro_name = std::move(_token.literal_as_string);
+				const std::string macro_name(_token.literal_as_string);
 
 				if (has_parentheses && !expect(tokenid::parenthesis_close))
 					return false;
@@ -1146,14 +1328,16 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 		return true;
 	}
 
-	const auto macro_it = _macros.find(_token.literal_as_string);
+	const std::string macro_name(_token.literal_as_string);
+
+	const auto macro_it = _macros.find(macro_name);
 	if (macro_it == _macros.end())
 		return false;
 
 	if (!_input_stack.empty())
 	{
 		const std::unordered_set<std::string> &hidden_macros = _input_stack[_current_input_index].hidden_macros;
-		if (hidden_macros.find(_token.literal_as_string) != hidden_macros.end())
+		if (hidden_macros.find(macro_name) != hidden_macros.end())
 			return false;
 	}
 
@@ -6,7 +6,7 @@
 #pragma once
 
 #include "effect_token.hpp"
-#include <memory> // std::unique_ptr
+#include <memory> // std::shared_ptr, std::unique_ptr
 #include <filesystem>
 #include <unordered_map>
 #include <unordered_set>
@@ -70,6 +70,29 @@ namespace reshadefx
 		/// <returns><see langword="true"/> if parsing was successful, <see langword="false"/> otherwise.</returns>
 		bool append_string(std::string source_code, const std::filesystem::path &path = std::filesystem::path());
 
+		/// <summary>
+		/// Opens the specified file and splits off the block of #include directives at its start, which is often the same across many files.
+		/// Parsing the include block with <see cref="append_string"/> and then the rest results in the same output as <see cref="append_file"/>, except for line directives.
+		/// </summary>
+		/// <param name="path">Path to the file to read.</param>
+		/// <param name="include_prefix">Set to the leading lines of the file that only contain #include directives, empty lines or comments.</param>
+		/// <param name="source_code">Set to the file contents, with the include block replaced by whitespace, so that offsets and line numbers stay the same.</param>
+		/// <returns><see langword="true"/> if the file was read successfully, <see langword="false"/> otherwise.</returns>
+		static bool split_include_prefix(const std::filesystem::path &path, std::string &include_prefix, std::string &source_code);
+
+		/// <summary>
+		/// Serializes the current macro definitions, output and list of included files to a binary blob.
+		/// This can only be called in between appending input.
+		/// </summary>
+		std::string serialize_state() const;
+		/// <summary>
+		/// Replaces the current macro definitions, output and list of included files with those previously serialized with <see cref="serialize_state"/>.
+		/// This makes it possible to skip pre-processing the same input again, as long as the initial state and all the files it included are still the same.
+		/// </summary>
+		/// <param name="data">Serialized state to restore.</param>
+		/// <returns><see langword="true"/> if the state was restored, <see langword="false"/> if the data was invalid (in which case the current state is unchanged).</returns>
+		bool deserialize_state(std::string_view data);
+
 		/// <summary>
 		/// Gets the list of error messages.
 		/// </summary>
@@ -108,7 +131,10 @@ namespace reshadefx
 		void error(const location &location, const std::string &message);
 		void warning(const location &location, const std::string &message);
 
+		bool append(std::shared_ptr<const std::string> source_code, const std::filesystem::path &path);
+
 		void push(std::string input, const std::string &name = std::string());
+		void push(std::shared_ptr<const std::string> input, const std::string &name = std::string());
 
 		bool peek(tokenid tokid) const;
 		void consume();
@@ -143,7 +169,9 @@ namespace reshadefx
 		size_t _next_input_index = 0;
 		size_t _current_input_index = 0;
 		reshadefx::token _token;
-		std::string _current_token_raw_data;
+		std::string_view _current_token_raw_data;
+		// Keeps the input the current token points into alive, even after its input level was popped
+		std::shared_ptr<const std::string> _current_token_input;
 		reshadefx::location _output_location;
 
 		unsigned short _recursion_count = 0;
@@ -153,6 +181,6 @@ namespace reshadefx
 		std::vector<if_level> _if_stack;
 
 		std::vector<std::filesystem::path> _include_paths;
-		std::unordered_map<std::string, std::string> _file_cache;
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> _file_cache;
 	};
 }
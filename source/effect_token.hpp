@@ -5,8 +5,10 @@
 
 #pragma once
 
+#include <memory> // std::shared_ptr
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace reshadefx
@@ -272,7 +274,14 @@ namespace reshadefx
 			float literal_as_float;
 			double literal_as_double;
 		};
-		std::string literal_as_string;
+		/// <summary>
+		/// Identifier name or string literal value. This points into the input of the lexer that produced the token, so it is only valid as long as that input is.
+		/// </summary>
+		std::string_view literal_as_string;
+		/// <summary>
+		/// Holds the value of string literals that differ from their input text (e.g. because escape sequences were resolved), which <see cref="literal_as_string"/> then points into instead.
+		/// </summary>
+		std::shared_ptr<const std::string> literal_storage;
 
 		operator tokenid() const { return id; }
 
@@ -0,0 +1,882 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "format_conversion.hpp"
+#include <cmath> // std::log, std::lrint, std::pow, std::sqrt
+#include <atomic>
+#include <cfloat> // FLT_MIN
+#include <cstring> // std::memcpy
+#include <algorithm> // std::max, std::min
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define RESHADE_FORMAT_CONVERSION_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h> // __cpuid, __cpuidex
+		// MSVC allows using intrinsics of any instruction set without having to enable it for the whole file
+		#define TARGET_SSE2
+		#define TARGET_SSSE3
+		#define TARGET_AVX2
+	#else
+		#define TARGET_SSE2 __attribute__((target("sse2")))
+		#define TARGET_SSSE3 __attribute__((target("ssse3")))
+		#define TARGET_AVX2 __attribute__((target("avx2,f16c")))
+	#endif
+#else
+	#define RESHADE_FORMAT_CONVERSION_X86 0
+#endif
+
+using namespace reshade;
+using namespace reshade::format_conversion;
+
+// BT.709/sRGB to BT.2020 primaries
+static constexpr float s_bt709_to_bt2020[3][3] = {
+	{ 0.627403914928436279296875f,      0.3292830288410186767578125f,      0.0433130674064159393310546875f },
+	{ 0.069097287952899932861328125f,   0.9195404052734375f,               0.011362315155565738677978515625f },
+	{ 0.01639143936336040496826171875f, 0.08801330626010894775390625f,     0.895595252513885498046875f }
+};
+
+// PQ constants as per Rec. ITU-R BT.2100-3 Table 4
+static constexpr float s_pq_m1 = 0.1593017578125f;
+static constexpr float s_pq_m2 = 78.84375f;
+static constexpr float s_pq_c1 = 0.8359375f;
+static constexpr float s_pq_c2 = 18.8515625f;
+static constexpr float s_pq_c3 = 18.6875f;
+// HLG constants as per Rec. ITU-R BT.2100-3 Table 5
+static constexpr float s_hlg_a = 0.17883277f;
+static constexpr float s_hlg_b = 0.28466892f;
+static constexpr float s_hlg_c = 0.55991073f;
+
+// scRGB 1.0 is 80 nits, PQ 1.0 is 10000 nits and HLG is normalized to a nominal peak of 1000 nits
+static constexpr float s_scrgb_to_pq_scale = 80.0f / 10000.0f;
+static constexpr float s_scrgb_to_hlg_scale = 80.0f / 1000.0f;
+
+static inline uint32_t load_uint32(const uint8_t *src)
+{
+	uint32_t value;
+	std::memcpy(&value, src, sizeof(value));
+	return value;
+}
+static inline void store_uint32(uint8_t *dst, uint32_t value)
+{
+	std::memcpy(dst, &value, sizeof(value));
+}
+static inline void store_uint16(uint8_t *dst, uint16_t value)
+{
+	std::memcpy(dst, &value, sizeof(value));
+}
+
+static inline float half_to_float(uint16_t value)
+{
+	// Shift exponent and mantissa into place and rebias the exponent (infinity and NaN end up as large finite values, which are clamped later anyway)
+	uint32_t bits = (static_cast<uint32_t>(value & 0x7FFF) << 13) + (112 << 23);
+	float result;
+	if ((value & 0x7C00) == 0)
+	{
+		// Denormals are turned into a normal value with the smallest exponent first and then have the implicit leading one subtracted again
+		// This avoids creating single precision denormals, which many processors handle very slowly
+		bits += 1 << 23;
+		std::memcpy(&result, &bits, sizeof(result));
+		result -= 6.103515625e-05f; // 2^-14
+	}
+	else
+	{
+		std::memcpy(&result, &bits, sizeof(result));
+	}
+	return (value & 0x8000) != 0 ? -result : result;
+}
+
+#pragma region Scalar Kernels
+
+static void r8_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 1, dst += 4)
+		store_uint32(dst, 0xFF000000 | src[0]);
+}
+static void r8g8_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 2, dst += 4)
+		store_uint32(dst, 0xFF000000 | (src[1] << 8) | src[0]);
+}
+static void rgbx8_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+		store_uint32(dst, load_uint32(src) | 0xFF000000);
+}
+static void bgra8_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	// Format is BGRA, but output should be RGBA, so flip channels
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+	{
+		const uint32_t bgra = load_uint32(src);
+		store_uint32(dst, (bgra & 0xFF00FF00) | ((bgra & 0x000000FF) << 16) | ((bgra & 0x00FF0000) >> 16));
+	}
+}
+static void bgrx8_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+	{
+		const uint32_t bgra = load_uint32(src);
+		store_uint32(dst, 0xFF000000 | (bgra & 0x0000FF00) | ((bgra & 0x000000FF) << 16) | ((bgra & 0x00FF0000) >> 16));
+	}
+}
+template <bool bgr>
+static void rgb10a2_to_rgba8_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+	{
+		const uint32_t rgba = load_uint32(src);
+		// Divide by 4 to get 10-bit range (0-1023) into 8-bit range (0-255)
+		const uint32_t x = ( rgba & 0x000003FFu)        >> 2;
+		const uint32_t y = ((rgba & 0x000FFC00u) >> 10) >> 2;
+		const uint32_t z = ((rgba & 0x3FF00000u) >> 20) >> 2;
+		const uint32_t a = ((rgba & 0xC0000000u) >> 30) * 85;
+		store_uint32(dst, (a << 24) | (bgr ? (x << 16) | (y << 8) | z : (z << 16) | (y << 8) | x));
+	}
+}
+template <bool bgr>
+static void rgb10a2_to_rgb16_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 6)
+	{
+		const uint32_t rgba = load_uint32(src);
+		// Multiply by 64 to get 10-bit range (0-1023) into 16-bit range (0-65535)
+		const uint16_t x = static_cast<uint16_t>( (rgba & 0x000003FFu)        << 6);
+		const uint16_t y = static_cast<uint16_t>(((rgba & 0x000FFC00u) >> 10) << 6);
+		const uint16_t z = static_cast<uint16_t>(((rgba & 0x3FF00000u) >> 20) << 6);
+		store_uint16(dst + 0, bgr ? z : x);
+		store_uint16(dst + 2, y);
+		store_uint16(dst + 4, bgr ? x : z);
+	}
+}
+static void rgba16f_to_rgb16f_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 8, dst += 6)
+		std::memcpy(dst, src, 6);
+}
+static void bgr10a2_to_rgb10a2_scalar(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+	{
+		const uint32_t bgra = load_uint32(src);
+		store_uint32(dst, ((bgra & 0x000003FFu) << 20) | ((bgra & 0x3FF00000u) >> 20) | (bgra & 0xC00FFC00u));
+	}
+}
+
+static void encode_scrgb_to_bt2100_scalar(const uint16_t *src, uint16_t *dst, size_t count, transfer_function transfer)
+{
+	for (size_t i = 0; i < count; ++i, src += 3, dst += 3)
+	{
+		const float rgb[3] = { half_to_float(src[0]), half_to_float(src[1]), half_to_float(src[2]) };
+
+		for (int c = 0; c < 3; ++c)
+		{
+			const float value = std::max(0.0f, s_bt709_to_bt2020[c][0] * rgb[0] + s_bt709_to_bt2020[c][1] * rgb[1] + s_bt709_to_bt2020[c][2] * rgb[2]);
+			const double encoded = transfer == transfer_function::pq ? encode_pq(value * s_scrgb_to_pq_scale) : encode_hlg(value * s_scrgb_to_hlg_scale);
+			dst[c] = static_cast<uint16_t>(std::lrint(encoded * 65535.0));
+		}
+	}
+}
+
+#pragma endregion
+
+#if RESHADE_FORMAT_CONVERSION_X86
+
+#pragma region SSE2 Kernels
+
+TARGET_SSE2 static void rgbx8_to_rgba8_sse2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4)), alpha));
+
+	rgbx8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+template <bool bgr>
+TARGET_SSE2 static void rgb10a2_to_rgba8_sse2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+
+		// Keep the upper 8 bits of every 10-bit channel
+		const __m128i x = _mm_and_si128(_mm_srli_epi32(rgba, 2), mask);
+		const __m128i y = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(rgba, 12), mask), 8);
+		const __m128i z = _mm_and_si128(_mm_srli_epi32(rgba, 22), mask);
+		// Replicate the 2-bit alpha value into all 8 bits (which is the same as multiplying by 85)
+		const __m128i a = _mm_and_si128(rgba, _mm_set1_epi32(static_cast<int>(0xC0000000)));
+		const __m128i a8 = _mm_or_si128(_mm_or_si128(a, _mm_srli_epi32(a, 2)), _mm_or_si128(_mm_srli_epi32(a, 4), _mm_srli_epi32(a, 6)));
+
+		const __m128i result = bgr ?
+			_mm_or_si128(_mm_or_si128(_mm_slli_epi32(x, 16), y), _mm_or_si128(z, a8)) :
+			_mm_or_si128(_mm_or_si128(_mm_slli_epi32(z, 16), y), _mm_or_si128(x, a8));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), result);
+	}
+
+	rgb10a2_to_rgba8_scalar<bgr>(src + i * 4, dst + i * 4, count - i);
+}
+TARGET_SSE2 static void bgr10a2_to_rgb10a2_sse2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+		const __m128i result = _mm_or_si128(
+			_mm_or_si128(_mm_slli_epi32(_mm_and_si128(bgra, _mm_set1_epi32(0x000003FF)), 20), _mm_srli_epi32(_mm_and_si128(bgra, _mm_set1_epi32(0x3FF00000)), 20)),
+			_mm_and_si128(bgra, _mm_set1_epi32(static_cast<int>(0xC00FFC00))));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), result);
+	}
+
+	bgr10a2_to_rgb10a2_scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// Natural logarithm for positive normalized values, using the polynomial approximation from the Cephes library (relative error of about 1e-7 over the full range)
+TARGET_SSE2 static inline __m128 log_sse2(__m128 x)
+{
+	const __m128i bits = _mm_castps_si128(x);
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F000000)));
+
+	// Move mantissa from [0.5, 1) to [sqrt(0.5), sqrt(2)), where the polynomial is most accurate
+	const __m128 mask = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+	e = _mm_sub_ps(e, _mm_and_ps(mask, _mm_set1_ps(1.0f)));
+	m = _mm_add_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_and_ps(mask, m));
+
+	const __m128 z = _mm_mul_ps(m, m);
+	__m128 y = _mm_set1_ps(7.0376836292e-2f);
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+	y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+// Natural exponential for values in [-87, 88], using the polynomial approximation from the Cephes library (relative error of about 1e-7)
+TARGET_SSE2 static inline __m128 exp_sse2(__m128 x)
+{
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.0f)), _mm_set1_ps(88.0f));
+
+	// Split into integer power of two and remainder
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	const __m128 fx_truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	fx = _mm_sub_ps(fx_truncated, _mm_and_ps(_mm_cmpgt_ps(fx_truncated, fx), _mm_set1_ps(1.0f)));
+
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(1.9875691500e-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+
+	const __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+	return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+// The transfer functions are long chains of dependent operations, so every step is done for all channels before moving on to the next, which lets the processor execute the independent chains interleaved
+TARGET_SSE2 static inline void encode_pq_sse2(__m128 (&values)[3])
+{
+	__m128 y[3];
+	for (int c = 0; c < 3; ++c)
+		y[c] = log_sse2(_mm_min_ps(_mm_max_ps(_mm_mul_ps(values[c], _mm_set1_ps(s_scrgb_to_pq_scale)), _mm_set1_ps(FLT_MIN)), _mm_set1_ps(1.0f)));
+	for (int c = 0; c < 3; ++c)
+		y[c] = exp_sse2(_mm_mul_ps(y[c], _mm_set1_ps(s_pq_m1)));
+	for (int c = 0; c < 3; ++c)
+		y[c] = log_sse2(_mm_div_ps(_mm_add_ps(_mm_mul_ps(y[c], _mm_set1_ps(s_pq_c2)), _mm_set1_ps(s_pq_c1)), _mm_add_ps(_mm_mul_ps(y[c], _mm_set1_ps(s_pq_c3)), _mm_set1_ps(1.0f))));
+	for (int c = 0; c < 3; ++c)
+		values[c] = exp_sse2(_mm_mul_ps(y[c], _mm_set1_ps(s_pq_m2)));
+}
+TARGET_SSE2 static inline void encode_hlg_sse2(__m128 (&values)[3])
+{
+	__m128 e[3], upper[3];
+	for (int c = 0; c < 3; ++c)
+		e[c] = _mm_min_ps(_mm_mul_ps(values[c], _mm_set1_ps(s_scrgb_to_hlg_scale)), _mm_set1_ps(1.0f));
+	for (int c = 0; c < 3; ++c)
+		upper[c] = _mm_add_ps(_mm_mul_ps(log_sse2(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(e[c], _mm_set1_ps(12.0f)), _mm_set1_ps(s_hlg_b)), _mm_set1_ps(FLT_MIN))), _mm_set1_ps(s_hlg_a)), _mm_set1_ps(s_hlg_c));
+	for (int c = 0; c < 3; ++c)
+	{
+		const __m128 lower = _mm_sqrt_ps(_mm_mul_ps(e[c], _mm_set1_ps(3.0f)));
+		const __m128 mask = _mm_cmple_ps(e[c], _mm_set1_ps(1.0f / 12.0f));
+		values[c] = _mm_or_ps(_mm_and_ps(mask, lower), _mm_andnot_ps(mask, upper[c]));
+	}
+}
+
+TARGET_SSE2 static void encode_scrgb_to_bt2100_sse2(const uint16_t *src, uint16_t *dst, size_t count, transfer_function transfer)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// Gather channels into separate vectors, so that the color space conversion can be done for four pixels at once
+		alignas(16) uint32_t channels[3][4];
+		for (int k = 0; k < 4; ++k)
+			for (int c = 0; c < 3; ++c)
+				channels[c][k] = src[(i + k) * 3 + c];
+
+		__m128 rgb[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			// Same conversion from 16-bit to 32-bit floating point as in the scalar variant
+			const __m128i h = _mm_load_si128(reinterpret_cast<const __m128i *>(channels[c]));
+			const __m128i bits = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13), _mm_set1_epi32(112 << 23));
+			const __m128 denormal_mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7C00)), _mm_setzero_si128()));
+			const __m128 denormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), _mm_set1_ps(6.103515625e-05f));
+			const __m128 magnitude = _mm_or_ps(_mm_and_ps(denormal_mask, denormal), _mm_andnot_ps(denormal_mask, _mm_castsi128_ps(bits)));
+			rgb[c] = _mm_or_ps(magnitude, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16)));
+		}
+
+		__m128 values[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			const __m128 value = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(rgb[0], _mm_set1_ps(s_bt709_to_bt2020[c][0])), _mm_mul_ps(rgb[1], _mm_set1_ps(s_bt709_to_bt2020[c][1]))),
+				_mm_mul_ps(rgb[2], _mm_set1_ps(s_bt709_to_bt2020[c][2])));
+			values[c] = _mm_max_ps(value, _mm_setzero_ps());
+		}
+
+		if (transfer == transfer_function::pq)
+			encode_pq_sse2(values);
+		else
+			encode_hlg_sse2(values);
+
+		for (int c = 0; c < 3; ++c)
+			_mm_store_si128(reinterpret_cast<__m128i *>(channels[c]), _mm_cvtps_epi32(_mm_mul_ps(values[c], _mm_set1_ps(65535.0f))));
+
+		for (int k = 0; k < 4; ++k)
+			for (int c = 0; c < 3; ++c)
+				dst[(i + k) * 3 + c] = static_cast<uint16_t>(channels[c][k]);
+	}
+
+	encode_scrgb_to_bt2100_scalar(src + i * 3, dst + i * 3, count - i, transfer);
+}
+
+#pragma endregion
+
+#pragma region SSSE3 Kernels
+
+TARGET_SSSE3 static void r8_to_rgba8_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 +  0), _mm_or_si128(_mm_shuffle_epi8(r, _mm_setr_epi8( 0, -1, -1, -1,  1, -1, -1, -1,  2, -1, -1, -1,  3, -1, -1, -1)), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_or_si128(_mm_shuffle_epi8(r, _mm_setr_epi8( 4, -1, -1, -1,  5, -1, -1, -1,  6, -1, -1, -1,  7, -1, -1, -1)), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 32), _mm_or_si128(_mm_shuffle_epi8(r, _mm_setr_epi8( 8, -1, -1, -1,  9, -1, -1, -1, 10, -1, -1, -1, 11, -1, -1, -1)), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 48), _mm_or_si128(_mm_shuffle_epi8(r, _mm_setr_epi8(12, -1, -1, -1, 13, -1, -1, -1, 14, -1, -1, -1, 15, -1, -1, -1)), alpha));
+	}
+
+	r8_to_rgba8_scalar(src + i, dst + i * 4, count - i);
+}
+TARGET_SSSE3 static void r8g8_to_rgba8_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i rg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 +  0), _mm_or_si128(_mm_shuffle_epi8(rg, _mm_setr_epi8( 0,  1, -1, -1,  2,  3, -1, -1,  4,  5, -1, -1,  6,  7, -1, -1)), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_or_si128(_mm_shuffle_epi8(rg, _mm_setr_epi8( 8,  9, -1, -1, 10, 11, -1, -1, 12, 13, -1, -1, 14, 15, -1, -1)), alpha));
+	}
+
+	r8g8_to_rgba8_scalar(src + i * 2, dst + i * 4, count - i);
+}
+TARGET_SSSE3 static void bgra8_to_rgba8_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4)), swizzle));
+
+	bgra8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+TARGET_SSSE3 static void bgrx8_to_rgba8_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+	const __m128i swizzle = _mm_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4)), swizzle), alpha));
+
+	bgrx8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// Stores two vectors with four 16-bit values each per pixel (where the fourth is ignored) as four tightly packed pixels with three 16-bit values each
+TARGET_SSSE3 static inline void store_rgb16_ssse3(uint8_t *dst, __m128i pixels01, __m128i pixels23)
+{
+	const __m128i compact = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+	pixels01 = _mm_shuffle_epi8(pixels01, compact);
+	pixels23 = _mm_shuffle_epi8(pixels23, compact);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_or_si128(pixels01, _mm_slli_si128(pixels23, 12)));
+	_mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 16), _mm_srli_si128(pixels23, 4));
+}
+
+template <bool bgr>
+TARGET_SSSE3 static void rgb10a2_to_rgb16_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_set1_epi32(0x3FF);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+
+		// Multiply by 64 to get 10-bit range (0-1023) into 16-bit range (0-65535)
+		const __m128i x = _mm_slli_epi32(_mm_and_si128(rgba, mask), 6);
+		const __m128i y = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(rgba, 10), mask), 6);
+		const __m128i z = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(rgba, 20), mask), 6);
+
+		const __m128i rg = _mm_or_si128(bgr ? z : x, _mm_slli_epi32(y, 16));
+		const __m128i b = bgr ? x : z;
+		store_rgb16_ssse3(dst + i * 6, _mm_unpacklo_epi32(rg, b), _mm_unpackhi_epi32(rg, b));
+	}
+
+	rgb10a2_to_rgb16_scalar<bgr>(src + i * 4, dst + i * 6, count - i);
+}
+TARGET_SSSE3 static void rgba16f_to_rgb16f_ssse3(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		store_rgb16_ssse3(dst + i * 6, _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 8)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 8 + 16)));
+
+	rgba16f_to_rgb16f_scalar(src + i * 8, dst + i * 6, count - i);
+}
+
+#pragma endregion
+
+#pragma region AVX2 Kernels
+
+TARGET_AVX2 static void rgbx8_to_rgba8_avx2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4)), alpha));
+
+	rgbx8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+TARGET_AVX2 static void bgra8_to_rgba8_avx2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i swizzle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4)), swizzle));
+
+	bgra8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+TARGET_AVX2 static void bgrx8_to_rgba8_avx2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+	const __m256i swizzle = _mm256_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4)), swizzle), alpha));
+
+	bgrx8_to_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+template <bool bgr>
+TARGET_AVX2 static void rgb10a2_to_rgba8_avx2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i rgba = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+
+		const __m256i x = _mm256_and_si256(_mm256_srli_epi32(rgba, 2), mask);
+		const __m256i y = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(rgba, 12), mask), 8);
+		const __m256i z = _mm256_and_si256(_mm256_srli_epi32(rgba, 22), mask);
+		const __m256i a = _mm256_and_si256(rgba, _mm256_set1_epi32(static_cast<int>(0xC0000000)));
+		const __m256i a8 = _mm256_or_si256(_mm256_or_si256(a, _mm256_srli_epi32(a, 2)), _mm256_or_si256(_mm256_srli_epi32(a, 4), _mm256_srli_epi32(a, 6)));
+
+		const __m256i result = bgr ?
+			_mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(x, 16), y), _mm256_or_si256(z, a8)) :
+			_mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(z, 16), y), _mm256_or_si256(x, a8));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), result);
+	}
+
+	rgb10a2_to_rgba8_scalar<bgr>(src + i * 4, dst + i * 4, count - i);
+}
+TARGET_AVX2 static void bgr10a2_to_rgb10a2_avx2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i bgra = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+		const __m256i result = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(bgra, _mm256_set1_epi32(0x000003FF)), 20), _mm256_srli_epi32(_mm256_and_si256(bgra, _mm256_set1_epi32(0x3FF00000)), 20)),
+			_mm256_and_si256(bgra, _mm256_set1_epi32(static_cast<int>(0xC00FFC00))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), result);
+	}
+
+	bgr10a2_to_rgb10a2_scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// Same approximations as the SSE2 variants above, just for eight values at once
+TARGET_AVX2 static inline __m256 log_avx2(__m256 x)
+{
+	const __m256i bits = _mm256_castps_si256(x);
+	__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+
+	const __m256 mask = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+	e = _mm256_sub_ps(e, _mm256_and_ps(mask, _mm256_set1_ps(1.0f)));
+	m = _mm256_add_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_and_ps(mask, m));
+
+	const __m256 z = _mm256_mul_ps(m, m);
+	__m256 y = _mm256_set1_ps(7.0376836292e-2f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.1514610310e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(1.1676998740e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.2420140846e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(1.4249322787e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.6668057665e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(2.0000714765e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-2.4999993993e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(3.3333331174e-1f));
+	y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+	y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+	y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+	return _mm256_add_ps(_mm256_add_ps(m, y), _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+}
+TARGET_AVX2 static inline __m256 exp_avx2(__m256 x)
+{
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.0f)), _mm256_set1_ps(88.0f));
+
+	const __m256 fx = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _mm256_set1_ps(0.5f)));
+
+	x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(0.693359375f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(-2.12194440e-4f)));
+
+	const __m256 z = _mm256_mul_ps(x, x);
+	__m256 y = _mm256_set1_ps(1.9875691500e-4f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+	y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, z), x), _mm256_set1_ps(1.0f));
+
+	const __m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+TARGET_AVX2 static inline void encode_pq_avx2(__m256 (&values)[3])
+{
+	__m256 y[3];
+	for (int c = 0; c < 3; ++c)
+		y[c] = log_avx2(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(values[c], _mm256_set1_ps(s_scrgb_to_pq_scale)), _mm256_set1_ps(FLT_MIN)), _mm256_set1_ps(1.0f)));
+	for (int c = 0; c < 3; ++c)
+		y[c] = exp_avx2(_mm256_mul_ps(y[c], _mm256_set1_ps(s_pq_m1)));
+	for (int c = 0; c < 3; ++c)
+		y[c] = log_avx2(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(y[c], _mm256_set1_ps(s_pq_c2)), _mm256_set1_ps(s_pq_c1)), _mm256_add_ps(_mm256_mul_ps(y[c], _mm256_set1_ps(s_pq_c3)), _mm256_set1_ps(1.0f))));
+	for (int c = 0; c < 3; ++c)
+		values[c] = exp_avx2(_mm256_mul_ps(y[c], _mm256_set1_ps(s_pq_m2)));
+}
+TARGET_AVX2 static inline void encode_hlg_avx2(__m256 (&values)[3])
+{
+	__m256 e[3], upper[3];
+	for (int c = 0; c < 3; ++c)
+		e[c] = _mm256_min_ps(_mm256_mul_ps(values[c], _mm256_set1_ps(s_scrgb_to_hlg_scale)), _mm256_set1_ps(1.0f));
+	for (int c = 0; c < 3; ++c)
+		upper[c] = _mm256_add_ps(_mm256_mul_ps(log_avx2(_mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(e[c], _mm256_set1_ps(12.0f)), _mm256_set1_ps(s_hlg_b)), _mm256_set1_ps(FLT_MIN))), _mm256_set1_ps(s_hlg_a)), _mm256_set1_ps(s_hlg_c));
+	for (int c = 0; c < 3; ++c)
+		values[c] = _mm256_blendv_ps(upper[c], _mm256_sqrt_ps(_mm256_mul_ps(e[c], _mm256_set1_ps(3.0f))), _mm256_cmp_ps(e[c], _mm256_set1_ps(1.0f / 12.0f), _CMP_LE_OQ));
+}
+
+TARGET_AVX2 static void encode_scrgb_to_bt2100_avx2(const uint16_t *src, uint16_t *dst, size_t count, transfer_function transfer)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		alignas(16) uint16_t channels[3][8];
+		for (int k = 0; k < 8; ++k)
+			for (int c = 0; c < 3; ++c)
+				channels[c][k] = src[(i + k) * 3 + c];
+
+		__m256 rgb[3];
+		for (int c = 0; c < 3; ++c)
+			rgb[c] = _mm256_cvtph_ps(_mm_load_si128(reinterpret_cast<const __m128i *>(channels[c])));
+
+		__m256 values[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			const __m256 value = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(rgb[0], _mm256_set1_ps(s_bt709_to_bt2020[c][0])), _mm256_mul_ps(rgb[1], _mm256_set1_ps(s_bt709_to_bt2020[c][1]))),
+				_mm256_mul_ps(rgb[2], _mm256_set1_ps(s_bt709_to_bt2020[c][2])));
+			values[c] = _mm256_max_ps(value, _mm256_setzero_ps());
+		}
+
+		if (transfer == transfer_function::pq)
+			encode_pq_avx2(values);
+		else
+			encode_hlg_avx2(values);
+
+		alignas(32) uint32_t encoded[3][8];
+		for (int c = 0; c < 3; ++c)
+			_mm256_store_si256(reinterpret_cast<__m256i *>(encoded[c]), _mm256_cvtps_epi32(_mm256_mul_ps(values[c], _mm256_set1_ps(65535.0f))));
+
+		for (int k = 0; k < 8; ++k)
+			for (int c = 0; c < 3; ++c)
+				dst[(i + k) * 3 + c] = static_cast<uint16_t>(encoded[c][k]);
+	}
+
+	encode_scrgb_to_bt2100_sse2(src + i * 3, dst + i * 3, count - i, transfer);
+}
+
+#pragma endregion
+
+#endif
+
+enum kernel_index
+{
+	kernel_r8_to_rgba8,
+	kernel_r8g8_to_rgba8,
+	kernel_rgbx8_to_rgba8,
+	kernel_bgra8_to_rgba8,
+	kernel_bgrx8_to_rgba8,
+	kernel_rgb10a2_to_rgba8,
+	kernel_bgr10a2_to_rgba8,
+	kernel_rgb10a2_to_rgb16,
+	kernel_bgr10a2_to_rgb16,
+	kernel_rgba16f_to_rgb16f,
+	kernel_bgr10a2_to_rgb10a2,
+	num_kernels
+};
+
+using kernel_func = void(*)(const uint8_t *src, uint8_t *dst, size_t count);
+using encode_func = void(*)(const uint16_t *src, uint16_t *dst, size_t count, transfer_function transfer);
+
+static const kernel_func s_kernels[][num_kernels] = {
+	{
+		r8_to_rgba8_scalar,
+		r8g8_to_rgba8_scalar,
+		rgbx8_to_rgba8_scalar,
+		bgra8_to_rgba8_scalar,
+		bgrx8_to_rgba8_scalar,
+		rgb10a2_to_rgba8_scalar<false>,
+		rgb10a2_to_rgba8_scalar<true>,
+		rgb10a2_to_rgb16_scalar<false>,
+		rgb10a2_to_rgb16_scalar<true>,
+		rgba16f_to_rgb16f_scalar,
+		bgr10a2_to_rgb10a2_scalar,
+	},
+#if RESHADE_FORMAT_CONVERSION_X86
+	{
+		r8_to_rgba8_scalar,
+		r8g8_to_rgba8_scalar,
+		rgbx8_to_rgba8_sse2,
+		bgra8_to_rgba8_scalar,
+		bgrx8_to_rgba8_scalar,
+		rgb10a2_to_rgba8_sse2<false>,
+		rgb10a2_to_rgba8_sse2<true>,
+		rgb10a2_to_rgb16_scalar<false>,
+		rgb10a2_to_rgb16_scalar<true>,
+		rgba16f_to_rgb16f_scalar,
+		bgr10a2_to_rgb10a2_sse2,
+	},
+	{
+		r8_to_rgba8_ssse3,
+		r8g8_to_rgba8_ssse3,
+		rgbx8_to_rgba8_sse2,
+		bgra8_to_rgba8_ssse3,
+		bgrx8_to_rgba8_ssse3,
+		rgb10a2_to_rgba8_sse2<false>,
+		rgb10a2_to_rgba8_sse2<true>,
+		rgb10a2_to_rgb16_ssse3<false>,
+		rgb10a2_to_rgb16_ssse3<true>,
+		rgba16f_to_rgb16f_ssse3,
+		bgr10a2_to_rgb10a2_sse2,
+	},
+	{
+		r8_to_rgba8_ssse3,
+		r8g8_to_rgba8_ssse3,
+		rgbx8_to_rgba8_avx2,
+		bgra8_to_rgba8_avx2,
+		bgrx8_to_rgba8_avx2,
+		rgb10a2_to_rgba8_avx2<false>,
+		rgb10a2_to_rgba8_avx2<true>,
+		rgb10a2_to_rgb16_ssse3<false>,
+		rgb10a2_to_rgb16_ssse3<true>,
+		rgba16f_to_rgb16f_ssse3,
+		bgr10a2_to_rgb10a2_avx2,
+	},
+#endif
+};
+static const encode_func s_encode_kernels[] = {
+	encode_scrgb_to_bt2100_scalar,
+#if RESHADE_FORMAT_CONVERSION_X86
+	encode_scrgb_to_bt2100_sse2,
+	encode_scrgb_to_bt2100_sse2,
+	encode_scrgb_to_bt2100_avx2,
+#endif
+};
+
+static instruction_set detect_instruction_set()
+{
+#if RESHADE_FORMAT_CONVERSION_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	const int max_function_id = info[0];
+
+	__cpuid(info, 1);
+	const bool has_sse2 = (info[3] & (1 << 26)) != 0;
+	const bool has_ssse3 = (info[2] & (1 << 9)) != 0;
+	const bool has_f16c = (info[2] & (1 << 29)) != 0;
+	// Also need to check that the operating system saves the AVX registers on context switches
+	const bool has_avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+	bool has_avx2 = false;
+	if (max_function_id >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		has_avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	const bool has_sse2 = __builtin_cpu_supports("sse2");
+	const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+	const bool has_f16c = __builtin_cpu_supports("f16c");
+	const bool has_avx = __builtin_cpu_supports("avx");
+	const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+	if (has_avx && has_avx2 && has_f16c)
+		return instruction_set::avx2;
+	if (has_ssse3)
+		return instruction_set::ssse3;
+	if (has_sse2)
+		return instruction_set::sse2;
+#endif
+	return instruction_set::scalar;
+}
+
+static const instruction_set s_supported_instruction_set = detect_instruction_set();
+static std::atomic<instruction_set> s_instruction_set = s_supported_instruction_set;
+
+static int find_kernel(api::format source_format, api::format dest_format)
+{
+	switch (dest_format)
+	{
+	case api::format::r8g8b8a8_unorm:
+		switch (source_format)
+		{
+		case api::format::r8_unorm:
+			return kernel_r8_to_rgba8;
+		case api::format::r8g8_unorm:
+			return kernel_r8g8_to_rgba8;
+		case api::format::r8g8b8x8_unorm:
+			return kernel_rgbx8_to_rgba8;
+		case api::format::b8g8r8a8_unorm:
+			return kernel_bgra8_to_rgba8;
+		case api::format::b8g8r8x8_unorm:
+			return kernel_bgrx8_to_rgba8;
+		case api::format::r10g10b10a2_unorm:
+			return kernel_rgb10a2_to_rgba8;
+		case api::format::b10g10r10a2_unorm:
+			return kernel_bgr10a2_to_rgba8;
+		default:
+			break;
+		}
+		break;
+	case api::format::r16g16b16_unorm:
+		switch (source_format)
+		{
+		case api::format::r10g10b10a2_unorm:
+			return kernel_rgb10a2_to_rgb16;
+		case api::format::b10g10r10a2_unorm:
+			return kernel_bgr10a2_to_rgb16;
+		default:
+			break;
+		}
+		break;
+	case api::format::r16g16b16_float:
+		if (source_format == api::format::r16g16b16a16_float)
+			return kernel_rgba16f_to_rgb16f;
+		break;
+	case api::format::r10g10b10a2_unorm:
+		if (source_format == api::format::b10g10r10a2_unorm)
+			return kernel_bgr10a2_to_rgb10a2;
+		break;
+	default:
+		break;
+	}
+
+	return -1;
+}
+
+auto reshade::format_conversion::get_instruction_set() -> instruction_set
+{
+	return s_instruction_set;
+}
+auto reshade::format_conversion::set_instruction_set(instruction_set max_instruction_set) -> instruction_set
+{
+	const instruction_set new_instruction_set = std::min(max_instruction_set, s_supported_instruction_set);
+	s_instruction_set = new_instruction_set;
+	return new_instruction_set;
+}
+
+bool reshade::format_conversion::is_supported(api::format source_format, api::format dest_format)
+{
+	return source_format == dest_format || find_kernel(source_format, dest_format) >= 0;
+}
+
+bool reshade::format_conversion::convert(const void *source, api::format source_format, void *dest, api::format dest_format, size_t count)
+{
+	if (source_format == dest_format)
+	{
+		std::memcpy(dest, source, count * api::format_row_pitch(source_format, 1));
+		return true;
+	}
+
+	const int kernel = find_kernel(source_format, dest_format);
+	if (kernel < 0)
+		return false;
+
+	s_kernels[static_cast<size_t>(s_instruction_set.load())][kernel](static_cast<const uint8_t *>(source), static_cast<uint8_t *>(dest), count);
+	return true;
+}
+
+void reshade::format_conversion::encode_scrgb_to_bt2100(const uint16_t *source, uint16_t *dest, size_t count, transfer_function transfer)
+{
+	s_encode_kernels[static_cast<size_t>(s_instruction_set.load())](source, dest, count, transfer);
+}
+
+double reshade::format_conversion::encode_pq(double value)
+{
+	const double y = std::pow(std::min(std::max(value, 0.0), 1.0), static_cast<double>(s_pq_m1));
+	return std::pow((s_pq_c1 + s_pq_c2 * y) / (1.0 + s_pq_c3 * y), static_cast<double>(s_pq_m2));
+}
+double reshade::format_conversion::encode_hlg(double value)
+{
+	const double e = std::min(std::max(value, 0.0), 1.0);
+	return e <= 1.0 / 12.0 ? std::sqrt(3.0 * e) : s_hlg_a * std::log(12.0 * e - s_hlg_b) + s_hlg_c;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "reshade_api_format.hpp"
+#include <cstddef>
+
+namespace reshade::format_conversion
+{
+	/// <summary>
+	/// Instruction sets the conversion kernels are specialized for. Each level implies support for the ones before it.
+	/// </summary>
+	enum class instruction_set
+	{
+		scalar,
+		sse2,
+		ssse3,
+		/// <summary>
+		/// AVX2 together with F16C.
+		/// </summary>
+		avx2,
+	};
+
+	/// <summary>
+	/// Transfer functions that linear scRGB data can be encoded with for HDR screenshots.
+	/// </summary>
+	enum class transfer_function
+	{
+		/// <summary>
+		/// SMPTE ST 2084 perceptual quantizer, with 1.0 in scRGB mapped to 80 nits of a 10000 nits range.
+		/// </summary>
+		pq,
+		/// <summary>
+		/// ARIB STD-B67 hybrid log-gamma, with 1.0 in scRGB mapped to 80 nits of a 1000 nits nominal peak.
+		/// </summary>
+		hlg,
+	};
+
+	/// <summary>
+	/// Gets the instruction set the conversion functions currently dispatch to.
+	/// By default this is the best one supported by the processor.
+	/// </summary>
+	instruction_set get_instruction_set();
+	/// <summary>
+	/// Limits the instruction set the conversion functions dispatch to, e.g. to compare the different implementations.
+	/// </summary>
+	/// <param name="max_instruction_set">Best instruction set that may be used.</param>
+	/// <returns>The instruction set that is used from now on, which may be lower than requested if the processor does not support it.</returns>
+	instruction_set set_instruction_set(instruction_set max_instruction_set);
+
+	/// <summary>
+	/// Checks whether <see cref="convert"/> supports converting from the specified source format to the specified destination format.
+	/// </summary>
+	bool is_supported(api::format source_format, api::format dest_format);
+
+	/// <summary>
+	/// Converts a row of pixels from one format to another.
+	/// Supported are identical formats and all conversions required to save screenshots and textures, i.e. from 8-bit and 10-bit formats to <see cref="api::format::r8g8b8a8_unorm"/>, from 10-bit formats to <see cref="api::format::r16g16b16_unorm"/>, from <see cref="api::format::r16g16b16a16_float"/> to <see cref="api::format::r16g16b16_float"/> and from <see cref="api::format::b10g10r10a2_unorm"/> to <see cref="api::format::r10g10b10a2_unorm"/>.
+	/// </summary>
+	/// <param name="source">Pointer to the source pixels.</param>
+	/// <param name="source_format">Format of the source pixels (must be a typed format).</param>
+	/// <param name="dest">Pointer to the destination pixels. This may not overlap with <paramref name="source"/>.</param>
+	/// <param name="dest_format">Format to convert to (must be a typed format).</param>
+	/// <param name="count">Number of pixels to convert.</param>
+	/// <returns><see langword="true"/> if the conversion is supported and was performed, <see langword="false"/> otherwise.</returns>
+	bool convert(const void *source, api::format source_format, void *dest, api::format dest_format, size_t count);
+
+	/// <summary>
+	/// Converts pixels of linear scRGB data (BT.709 primaries, 1.0 is 80 nits) in <see cref="api::format::r16g16b16_float"/> format to BT.2020 primaries, encodes them with the specified transfer function and quantizes the result to <see cref="api::format::r16g16b16_unorm"/>.
+	/// Negative values are clamped to zero and values above the maximum luminance of the transfer function (including infinity) are clamped to it.
+	/// The vectorized implementations use polynomial approximations of the logarithm and exponential, which stay within 1 code value of the exact result (absolute error before quantization is below 2e-5).
+	/// </summary>
+	/// <param name="source">Pointer to the source pixels.</param>
+	/// <param name="dest">Pointer to the destination pixels. This may be the same as <paramref name="source"/> to convert in place.</param>
+	/// <param name="count">Number of pixels to convert.</param>
+	/// <param name="transfer">Transfer function to encode with.</param>
+	void encode_scrgb_to_bt2100(const uint16_t *source, uint16_t *dest, size_t count, transfer_function transfer);
+
+	/// <summary>
+	/// Encodes a normalized linear value (1.0 is 10000 nits) with the PQ inverse EOTF, at full precision.
+	/// This is the reference the vectorized implementation is measured against.
+	/// </summary>
+	double encode_pq(double value);
+	/// <summary>
+	/// Encodes a normalized scene-linear value (1.0 is the nominal peak) with the HLG OETF, at full precision.
+	/// This is the reference the vectorized implementation is measured against.
+	/// </summary>
+	double encode_hlg(double value);
+}
@@ -8,10 +8,11 @@
 #include <atomic>
 #include <utility>
 #include <cassert>
+#include <cstdint>
 
 /// <summary>
-/// A simple lock-free linear search table.
-/// The key values "one" and "zero" hold a special meaning (see <see cref="no_value"/> and <see cref="update_value"/>), so do not use them.
+/// A lock-free open-addressing hash table with linear probing.
+/// The key values "zero", "minus one" and "minus two" hold a special meaning (see <see cref="no_value"/>, <see cref="update_value"/> and <see cref="erased_value"/>), so do not use them.
 /// </summary>
 template <typename TKey, typename TValue, uint32_t MAX_ENTRIES>
 class lockfree_linear_map : lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>
@@ -24,6 +25,7 @@ public:
 
 	using lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::no_value;
 	using lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::update_value;
+	using lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::erased_value;
 
 	/// <summary>
 	/// Gets the value associated with the specified <paramref name="key"/>.
@@ -106,7 +108,7 @@ public:
 
 			// Clear this entry so it can be used again
 			if (TKey current_key = lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::_data[i].first.exchange(no_value);
-				current_key != no_value && current_key != update_value) // If this in update mode, we can assume the thread updating will reset the key to its intended value
+				current_key != no_value && current_key != update_value && current_key != erased_value) // If this in update mode, we can assume the thread updating will reset the key to its intended value, and erased entries already had their value deleted
 			{
 				// Delete any value attached to the entry, but only if there was one to begin with
 				delete old_value;
@@ -122,6 +124,9 @@ private:
 	}
 };
 
+#pragma warning(push)
+#pragma warning(disable: 4324) // Structure was padded due to alignment specifier
+
 /// <summary>
 /// Overload of the lock-free table for pointer value types, which avoids an extra indirection and stores the pointers directly.
 /// </summary>
@@ -130,6 +135,8 @@ class lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>
 {
 	using TValuePtr = TValue *;
 
+	static_assert(MAX_ENTRIES != 0 && (MAX_ENTRIES & (MAX_ENTRIES - 1)) == 0, "Table size has to be a power of two");
+
 public:
 	~lockfree_linear_map()
 	{
@@ -137,13 +144,18 @@ public:
 	}
 
 	/// <summary>
-	/// Special key indicating that the entry is empty.
+	/// Special key indicating that the entry is empty and was never used, which ends a probe sequence.
 	/// </summary>
 	static inline const TKey no_value = (TKey)0;
 	/// <summary>
 	/// Special key indicating that the entry is currently being updated.
 	/// </summary>
 	static inline const TKey update_value = (TKey)-1;
+	/// <summary>
+	/// Special key indicating that the entry was erased, which can be used again, but does not end a probe sequence (so that keys placed after it can still be found).
+	/// Runs of these in front of an empty entry are turned back into empty entries when possible (see <see cref="erase"/>).
+	/// </summary>
+	static inline const TKey erased_value = (TKey)-2;
 
 	/// <summary>
 	/// Gets the pointer associated with the specified <paramref name="key"/>.
@@ -153,20 +165,18 @@ public:
 	/// <returns>Pointer associated with the key, or <see langword="nullptr"/> if it was not found.</returns>
 	TValuePtr at(TKey key) const
 	{
-		assert(key != no_value && key != update_value);
+		assert(key != no_value && key != update_value && key != erased_value);
 
-		// If the table is really big, reduce search time by using hash as start index
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
-
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (uint32_t i = 0, index = start_index(key); i < MAX_ENTRIES; ++i, index = (index + 1) & (MAX_ENTRIES - 1))
 		{
-			if (_data[i].first.load(std::memory_order_acquire) == key)
+			const TKey test_key = _data[index].first.load(std::memory_order_acquire);
+			if (test_key == key)
 			{
 				// The pointer is guaranteed to be value at this point, or else key would have been in update mode
-				return _data[i].second;
+				return _data[index].second;
 			}
+			if (test_key == no_value)
+				break; // Key would have been placed here if it existed, so can stop searching
 		}
 
 		return nullptr;
@@ -180,26 +190,29 @@ public:
 	/// <returns><see langword="true"/> if the key-pointer pair was added successfully, or <see langword="false"/> if the table is full.</returns>
 	bool emplace(TKey key, TValuePtr value)
 	{
-		assert(key != no_value && key != update_value);
+		assert(key != no_value && key != update_value && key != erased_value);
 
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
+		// Prevent erased entries from being reclaimed while probing (see 'erase')
+		_pending_emplaces.fetch_add(1);
 
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (uint32_t i = 0, index = start_index(key); i < MAX_ENTRIES; ++i, index = (index + 1) & (MAX_ENTRIES - 1))
 		{
-			if (TKey test_key = _data[i].first.load(std::memory_order_relaxed);
-				test_key == no_value &&
-				_data[i].first.compare_exchange_strong(test_key, update_value, std::memory_order_relaxed))
+			// Retry the same entry if it changed in between, rather than moving on, so that a key is never placed further down the probe sequence than the first free entry
+			for (TKey test_key = _data[index].first.load(); test_key == no_value || test_key == erased_value;)
 			{
-				_data[i].second = value;
+				if (_data[index].first.compare_exchange_weak(test_key, update_value))
+				{
+					_data[index].second = value;
 
-				_data[i].first.store(key, std::memory_order_release);
+					_data[index].first.store(key, std::memory_order_release);
 
-				return true;
+					_pending_emplaces.fetch_sub(1);
+					return true;
+				}
 			}
 		}
 
+		_pending_emplaces.fetch_sub(1);
 		return false;
 	}
 
@@ -210,27 +223,40 @@ public:
 	/// <returns>Removed pointer if the key existed, <see langword="nullptr"/> otherwise.</returns>
 	TValuePtr erase(TKey key)
 	{
-		if (key == no_value || key == update_value) // Cannot remove special keys
+		if (key == no_value || key == update_value || key == erased_value) // Cannot remove special keys
 			return nullptr;
 
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
-
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (uint32_t i = 0, index = start_index(key); i < MAX_ENTRIES; ++i, index = (index + 1) & (MAX_ENTRIES - 1))
 		{
 			// Load and check before doing an expensive CAS
-			if (TKey test_key = _data[i].first.load(std::memory_order_relaxed);
+			if (TKey test_key = _data[index].first.load(std::memory_order_relaxed);
 				test_key == key)
 			{
 				// Get the value before freeing the entry up for other threads to fill again
-				const TValuePtr old_value = _data[i].second;
+				const TValuePtr old_value = _data[index].second;
 
-				if (_data[i].first.compare_exchange_strong(test_key, no_value, std::memory_order_relaxed))
+				// Mark the entry as erased instead of empty, since other keys may have been placed after it in the same probe sequence
+				if (_data[index].first.compare_exchange_strong(test_key, erased_value))
 				{
+					// If the probe sequence ends right after this entry, no key can have been placed past it, so it and any erased entries in front of it can be emptied again
+					// Otherwise erased entries would accumulate until every look up of a missing key had to probe the entire table
+					// But this is only safe while no key is being added, since that may have already probed past these entries and would then place its key where look ups stop before reaching it
+					for (uint32_t reclaim_index = index;
+						_data[(reclaim_index + 1) & (MAX_ENTRIES - 1)].first.load() == no_value && _pending_emplaces.load() == 0;
+						reclaim_index = (reclaim_index - 1) & (MAX_ENTRIES - 1))
+					{
+						if (TKey erased_key = erased_value;
+							!_data[reclaim_index].first.compare_exchange_strong(erased_key, no_value))
+							break;
+					}
+
 					return old_value;
 				}
 			}
+			else if (test_key == no_value)
+			{
+				break;
+			}
 		}
 
 		return nullptr;
@@ -248,5 +274,15 @@ public:
 	}
 
 protected:
-	std::pair<std::atomic<TKey>, TValuePtr> _data[MAX_ENTRIES];
+	static inline uint32_t start_index(TKey key)
+	{
+		// Keys are usually aligned pointers or handles, so mix the upper bits into the index (Fibonacci hashing)
+		return static_cast<uint32_t>((static_cast<uint64_t>((uintptr_t)key) * 0x9E3779B97F4A7C15ull) >> 32) & (MAX_ENTRIES - 1);
+	}
+
+	// Align to cache line, so that a probe sequence touches as few cache lines as possible
+	alignas(64) std::pair<std::atomic<TKey>, TValuePtr> _data[MAX_ENTRIES];
+	std::atomic<uint32_t> _pending_emplaces = 0;
 };
+
+#pragma warning(pop)
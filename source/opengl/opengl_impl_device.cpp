@@ -2165,6 +2165,8 @@ bool reshade::opengl::device_impl::create_pipeline(api::pipeline_layout, uint32_
 			break;
 		case api::pipeline_subobject_type::dynamic_pipeline_states:
 			break; // Ignored
+		case api::pipeline_subobject_type::pipeline_cache:
+			break; // Ignored, since pipelines cannot be cached
 		case api::pipeline_subobject_type::max_vertex_count:
 			assert(subobjects[i].count == 1);
 			break; // Ignored
@@ -2752,3 +2754,18 @@ bool reshade::opengl::device_impl::get_pipeline_shader_group_handles(api::pipeli
 {
 	return false;
 }
+
+bool reshade::opengl::device_impl::create_pipeline_cache(const void *, size_t, api::pipeline_cache *out_cache)
+{
+	*out_cache = { 0 };
+	return false;
+}
+void reshade::opengl::device_impl::destroy_pipeline_cache(api::pipeline_cache cache)
+{
+	assert(cache == 0);
+}
+bool reshade::opengl::device_impl::get_pipeline_cache_data(api::pipeline_cache, size_t *out_size, void *)
+{
+	*out_size = 0;
+	return false;
+}
@@ -97,6 +97,10 @@ namespace reshade::opengl
 
 		bool get_pipeline_shader_group_handles(api::pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) final;
 
+		bool create_pipeline_cache(const void *initial_data, size_t initial_data_size, api::pipeline_cache *out_cache) final;
+		void destroy_pipeline_cache(api::pipeline_cache cache) final;
+		bool get_pipeline_cache_data(api::pipeline_cache cache, size_t *out_size, void *out_data) final;
+
 		const GladGLContext _dispatch_table;
 
 	protected:
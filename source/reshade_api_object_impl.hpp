@@ -6,16 +6,21 @@
 #pragma once
 
 #include "reshade_api_device.hpp"
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <cassert>
+#include <algorithm>
 #include <unordered_map>
 
 namespace reshade::api
 {
-	template <typename T, typename... api_object_base>
-	class __declspec(novtable) api_object_impl : public api_object_base...
+	/// <summary>
+	/// Process-wide registry that assigns each private data GUID a small dense slot index the first time data is stored for it, so that objects can keep the associated values in a fixed array instead of a hash map.
+	/// </summary>
+	class private_data_slots
 	{
-		static_assert(sizeof(T) <= sizeof(uint64_t));
-
+	public:
 		struct guid_t
 		{
 			struct hash
@@ -48,6 +53,85 @@ namespace reshade::api
 #endif
 		};
 
+		/// <summary>
+		/// Number of slots every object reserves inline. GUIDs that are registered after all slots were handed out are stored in a per-object overflow map instead.
+		/// </summary>
+		static constexpr uint32_t max_slots = 8;
+		static constexpr uint32_t invalid_slot = 0xFFFFFFFF;
+
+		/// <summary>
+		/// Gets the slot index that was registered for the specified <paramref name="guid"/>, or <see cref="invalid_slot"/> if there is none.
+		/// This is lock-free and usually only has to compare a single table entry.
+		/// </summary>
+		static uint32_t find(const guid_t &guid)
+		{
+			for (uint32_t i = 0, index = start_index(guid); i < table_size; ++i, index = (index + 1) % table_size)
+			{
+				const uint32_t slot = _table[index].slot.load(std::memory_order_acquire);
+				if (slot == 0)
+					break;
+				if (guid_t::equal()(_table[index].guid, guid))
+					return slot - 1;
+			}
+
+			return invalid_slot;
+		}
+
+		/// <summary>
+		/// Gets the slot index that was registered for the specified <paramref name="guid"/>, or registers a new one if there is none yet.
+		/// </summary>
+		/// <returns>Slot index, or <see cref="invalid_slot"/> if all slots are already in use.</returns>
+		static uint32_t find_or_register(const guid_t &guid)
+		{
+			if (const uint32_t slot = find(guid); slot != invalid_slot)
+				return slot;
+
+			const std::lock_guard<std::mutex> lock(_mutex);
+
+			// Check again, in case another thread registered the same GUID in the meantime
+			if (const uint32_t slot = find(guid); slot != invalid_slot)
+				return slot;
+
+			if (_num_slots >= max_slots)
+				return invalid_slot;
+
+			// The table has more entries than there are slots, so this always finds an empty one
+			uint32_t index = start_index(guid);
+			while (_table[index].slot.load(std::memory_order_relaxed) != 0)
+				index = (index + 1) % table_size;
+
+			_table[index].guid = guid;
+			_table[index].slot.store(++_num_slots, std::memory_order_release);
+
+			return _num_slots - 1;
+		}
+
+	private:
+		static constexpr uint32_t table_size = max_slots * 4;
+
+		static uint32_t start_index(const guid_t &guid)
+		{
+			return static_cast<uint32_t>(guid_t::hash()(guid) % table_size);
+		}
+
+		struct entry
+		{
+			std::atomic<uint32_t> slot; // Slot index plus one, or zero if this entry is empty
+			guid_t guid;
+		};
+
+		static inline entry _table[table_size] = {};
+		static inline uint32_t _num_slots = 0;
+		static inline std::mutex _mutex;
+	};
+
+	template <typename T, typename... api_object_base>
+	class __declspec(novtable) api_object_impl : public api_object_base...
+	{
+		static_assert(sizeof(T) <= sizeof(uint64_t));
+
+		using guid_t = private_data_slots::guid_t;
+
 	public:
 		api_object_impl(const api_object_impl &) = delete;
 		api_object_impl &operator=(const api_object_impl &) = delete;
@@ -56,24 +140,49 @@ namespace reshade::api
 		{
 			assert(data != nullptr);
 
-			if (_private_data.empty()) // Early-out to avoid crash when this is called after the object was destroyed
+			const guid_t &key = *reinterpret_cast<const guid_t *>(guid);
+
+			if (const uint32_t slot = private_data_slots::find(key);
+				slot != private_data_slots::invalid_slot)
+			{
+				*data = _private_data[slot];
+				return;
+			}
+
+			if (_private_data_overflow == nullptr)
 			{
 				*data = 0;
 				return;
 			}
 
-			if (const auto it = _private_data.find(*reinterpret_cast<const guid_t *>(guid));
-				it != _private_data.end())
+			if (const auto it = _private_data_overflow->find(key);
+				it != _private_data_overflow->end())
 				*data = it->second;
 			else
 				*data = 0;
 		}
 		void set_private_data(const uint8_t guid[16], const uint64_t data)  final
 		{
+			const guid_t &key = *reinterpret_cast<const guid_t *>(guid);
+
+			// Only register a slot when data is actually stored, so that clearing data for unknown GUIDs does not use one up
+			if (const uint32_t slot = (data != 0) ? private_data_slots::find_or_register(key) : private_data_slots::find(key);
+				slot != private_data_slots::invalid_slot)
+			{
+				_private_data[slot] = data;
+				return;
+			}
+
 			if (data != 0)
-				_private_data[*reinterpret_cast<const guid_t *>(guid)] = data;
-			else
-				_private_data.erase(*reinterpret_cast<const guid_t *>(guid));
+			{
+				if (_private_data_overflow == nullptr)
+					_private_data_overflow = std::make_unique<std::unordered_map<guid_t, uint64_t, typename guid_t::hash, typename guid_t::equal>>();
+				(*_private_data_overflow)[key] = data;
+			}
+			else if (_private_data_overflow != nullptr)
+			{
+				_private_data_overflow->erase(key);
+			}
 		}
 
 		uint64_t get_native() const final { return (uint64_t)_orig; }
@@ -86,11 +195,14 @@ namespace reshade::api
 		~api_object_impl()
 		{
 			// All user data should ideally have been removed before destruction, to avoid leaks
-			assert(_private_data.empty());
+			assert(std::find_if(std::begin(_private_data), std::end(_private_data), [](uint64_t data) { return data != 0; }) == std::end(_private_data));
+			assert(_private_data_overflow == nullptr || _private_data_overflow->empty());
 		}
 
 	private:
-		std::unordered_map<guid_t, uint64_t, typename guid_t::hash, typename guid_t::equal> _private_data;
+		uint64_t _private_data[private_data_slots::max_slots] = {};
+		// Only allocated once more GUIDs are in use than there are slots
+		std::unique_ptr<std::unordered_map<guid_t, uint64_t, typename guid_t::hash, typename guid_t::equal>> _private_data_overflow;
 	};
 }
 
@@ -7,10 +7,12 @@
 #include "runtime_internal.hpp"
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
+#include "effect_file_cache.hpp"
 #include "effect_preprocessor.hpp"
 #include "version.h"
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
+#include "format_conversion.hpp"
 #include "ini_file.hpp"
 #include "addon_manager.hpp"
 #include "input.hpp"
@@ -24,9 +26,6 @@
 #include <cstdlib> // std::malloc, std::rand, std::strtod, std::strtol
 #include <cstring> // std::memcpy, std::memset, std::strlen
 #include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::set_symmetric_difference, std::sort, std::stable_sort, std::swap, std::transform
-#include <emmintrin.h>
-#include <smmintrin.h>
-#include <immintrin.h>
 #include <fpng.h>
 #include <simple_lossless.h>
 #include <stb_image.h>
@@ -299,6 +298,12 @@ reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphic
 	_last_frame_duration(std::chrono::milliseconds(1)),
 	_effect_search_paths({ L".\\" }),
 	_texture_search_paths({ L".\\" }),
+#ifndef _WIN64
+	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
+	_worker_pool(std::min(std::max(std::thread::hardware_concurrency(), 2u) - 1, 4u)),
+#else
+	_worker_pool(std::max(std::thread::hardware_concurrency(), 2u) - 1),
+#endif
 	_config_path(config_path),
 	_screenshot_path(L".\\"),
 	_screenshot_name("%AppName% %Date% %Time%_%Count%"), // Ensure unique naming with screenshot count because users may request more than one screenshot per second
@@ -356,7 +361,9 @@ reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphic
 }
 reshade::runtime::~runtime()
 {
-	assert(_worker_threads.empty());
+	// Make sure no screenshots are still being written in the background
+	_worker_pool.wait_idle();
+
 	assert(!_is_initialized && _techniques.empty() && _technique_sorting.empty());
 
 #if RESHADE_GUI
@@ -563,6 +570,19 @@ bool reshade::runtime::on_init()
 		_primary_input_handler = _input.use_count() == 1 || (_input == nullptr && _input_gamepad != nullptr);
 	}
 
+	// Fence used to track completion of texture readbacks (failure is not fatal, readbacks fall back to waiting for idle then)
+	_device->create_fence(0, api::fence_flags::none, &_readback_fence);
+	_readback_fence_value = 0;
+
+	// Driver pipeline cache persisted from the last run, so that effect pipelines do not have to be compiled by the driver again (not supported on all APIs, in which case pipelines are created without it)
+	{
+		std::string pipeline_cache_data;
+		if (!load_effect_cache("pipelines-" + std::to_string(_renderer_id), "cache", pipeline_cache_data))
+			pipeline_cache_data.clear();
+
+		_device->create_pipeline_cache(pipeline_cache_data.data(), pipeline_cache_data.size(), &_effect_pipeline_cache);
+	}
+
 	// Reset frame count to zero so effects are loaded in 'update_effects'
 	_frame_count = 0;
 
@@ -633,9 +653,45 @@ void reshade::runtime::on_reset()
 	else
 		return; // Nothing to do if the runtime was already destroyed or not successfully initialized in the first place
 
+	// Finish all pending readbacks, so that screenshots taken right before are still written (the wait for idle below then also waits for them to be encoded)
+	for (size_t slot_index = 0; slot_index < std::size(_readback_slots); ++slot_index)
+	{
+		readback_slot &slot = _readback_slots[slot_index];
+
+		flush_texture_readback(slot_index);
+
+		_device->destroy_resource(slot.resource);
+		slot.resource = {};
+		slot.desc = {};
+	}
+
+	_device->destroy_fence(_readback_fence);
+	_readback_fence = {};
+
 	// Already performs a wait for idle, so no need to do it again before destroying resources below
 	destroy_effects();
 
+	// Persist driver pipeline cache now that all effect pipelines were destroyed, so that the next run can load them from it
+	if (_effect_pipeline_cache != 0)
+	{
+		if (size_t pipeline_cache_size = 0;
+			!_no_effect_cache && _device->get_pipeline_cache_data(_effect_pipeline_cache, &pipeline_cache_size, nullptr) && pipeline_cache_size != 0)
+		{
+			std::string pipeline_cache_data(pipeline_cache_size, '\0');
+			if (_device->get_pipeline_cache_data(_effect_pipeline_cache, &pipeline_cache_size, pipeline_cache_data.data()))
+			{
+				pipeline_cache_data.resize(pipeline_cache_size);
+				save_effect_cache("pipelines-" + std::to_string(_renderer_id), "cache", pipeline_cache_data);
+			}
+		}
+
+		_device->destroy_pipeline_cache(_effect_pipeline_cache);
+		_effect_pipeline_cache = {};
+	}
+
+	// All readbacks were encoded by now, so can free their pixel buffers (they are allocated again with the new dimensions on the next screenshot)
+	_readback_buffers.trim();
+
 	_device->destroy_resource(_empty_tex);
 	_empty_tex = {};
 	_device->destroy_resource_view(_empty_srv);
@@ -729,6 +785,8 @@ void reshade::runtime::on_present()
 
 	update_effects();
 
+	update_texture_readbacks();
+
 	_current_time = std::chrono::system_clock::now();
 
 	if (_should_save_screenshot && _screenshot_save_before && _effects_enabled && !_effects_rendered_this_frame)
@@ -752,6 +810,19 @@ void reshade::runtime::on_present()
 		save_screenshot(_screenshot_save_before ? "After" : nullptr);
 
 	_frame_count++;
+	_last_uniform_upload_size = _uniform_upload_size;
+	_uniform_upload_size = 0;
+	_last_back_buffer_copies = _back_buffer_copies;
+	_back_buffer_copies = 0;
+	_last_back_buffer_copies_saved = _back_buffer_copies_saved;
+	_back_buffer_copies_saved = 0;
+
+	// Destroy objects of replaced effects once no frame that may reference them is in flight anymore (these were queued in frame order)
+	size_t num_deferred_destructions = 0;
+	for (; num_deferred_destructions < _deferred_effect_object_destructions.size() && _deferred_effect_object_destructions[num_deferred_destructions].first <= _frame_count; ++num_deferred_destructions)
+		_deferred_effect_object_destructions[num_deferred_destructions].second();
+	_deferred_effect_object_destructions.erase(_deferred_effect_object_destructions.begin(), _deferred_effect_object_destructions.begin() + num_deferred_destructions);
+
 	const auto current_time = std::chrono::high_resolution_clock::now();
 	_last_frame_duration = current_time - _last_present_time; _last_present_time = current_time;
 
@@ -1012,9 +1083,12 @@ void reshade::runtime::load_config()
 	config_get("GENERAL", "NoEffectCache", _no_effect_cache);
 	config_get("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
+	config_get("GENERAL", "AliasTransientTextures", _transient_texture_aliasing);
+	config_get("GENERAL", "AutoReloadEffects", _effect_auto_reload);
 	config_get("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config_get("GENERAL", "PerformanceMode", _performance_mode);
 	config_get("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
+	config_get("GENERAL", "PrewarmShortcutTechniques", _technique_prewarming);
 	config_get("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config_get("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config_get("GENERAL", "IntermediateCachePath", _effect_cache_path);
@@ -1089,9 +1163,12 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "NoEffectCache", _no_effect_cache);
 	config.set("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
+	config.set("GENERAL", "AliasTransientTextures", _transient_texture_aliasing);
+	config.set("GENERAL", "AutoReloadEffects", _effect_auto_reload);
 	config.set("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config.set("GENERAL", "PerformanceMode", _performance_mode);
 	config.set("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
+	config.set("GENERAL", "PrewarmShortcutTechniques", _technique_prewarming);
 	config.set("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config.set("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config.set("GENERAL", "IntermediateCachePath", _effect_cache_path);
@@ -1501,7 +1578,64 @@ bool reshade::runtime::switch_to_next_preset(std::filesystem::path filter_path,
 	return true;
 }
 
-bool reshade::runtime::load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, size_t permutation_index, bool force_load, bool preprocess_required)
+static uint64_t calc_texture_memory_size(const reshade::api::resource_desc &desc)
+{
+	uint64_t size = 0;
+	for (uint32_t level = 0, width = desc.texture.width, height = desc.texture.height, depth = desc.texture.depth_or_layers; level < desc.texture.levels; ++level)
+	{
+		size += static_cast<uint64_t>(reshade::api::format_slice_pitch(desc.texture.format, reshade::api::format_row_pitch(desc.texture.format, width), height)) * depth;
+
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+		if (desc.type == reshade::api::resource_type::texture_3d)
+			depth = std::max(1u, depth / 2);
+	}
+	return size;
+}
+
+/// <summary>
+/// Finds the only technique that accesses the specified texture, if its contents never need to outlive that technique.
+/// This is the case when the first pass accessing it in the technique clears it as a render target, so that the texture does not carry any data across techniques or frames.
+/// </summary>
+static std::string find_transient_texture_technique(const reshadefx::effect_module &module, const reshadefx::texture &tex)
+{
+	if (!tex.render_target || tex.storage_access || !tex.semantic.empty())
+		return std::string();
+
+	const auto is_sampled_in_pass = [&module, &tex](const reshadefx::pass &pass) {
+		return std::any_of(pass.texture_bindings.begin(), pass.texture_bindings.end(),
+			[&module, &tex](const reshadefx::texture_binding &binding) { return module.samplers[binding.index].texture_name == tex.unique_name; });
+	};
+	const auto is_render_target_in_pass = [&tex](const reshadefx::pass &pass) {
+		return std::find(std::begin(pass.render_target_names), std::end(pass.render_target_names), tex.unique_name) != std::end(pass.render_target_names);
+	};
+
+	const reshadefx::technique *transient_technique = nullptr;
+
+	for (const reshadefx::technique &tech : module.techniques)
+	{
+		const auto first_pass = std::find_if(tech.passes.begin(), tech.passes.end(),
+			[&](const reshadefx::pass &pass) { return is_sampled_in_pass(pass) || is_render_target_in_pass(pass); });
+		if (first_pass == tech.passes.end())
+			continue;
+
+		// Texture is used by more than one technique, so its contents may be expected to persist between them
+		if (transient_technique != nullptr)
+			return std::string();
+		transient_technique = &tech;
+
+		if (!first_pass->cs_entry_point.empty() || !first_pass->clear_render_targets ||
+			// Texture has to be written to only (not read from) by the first pass
+			!is_render_target_in_pass(*first_pass) || is_sampled_in_pass(*first_pass) ||
+			// Clearing only affects the first level, so other levels have to be regenerated
+			(tex.levels > 1 && !first_pass->generate_mipmaps))
+			return std::string();
+	}
+
+	return transient_technique != nullptr ? transient_technique->name : std::string();
+}
+
+bool reshade::runtime::load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, size_t permutation_index, bool force_load, bool preprocess_required, effect *staged_effect)
 {
 	const std::chrono::high_resolution_clock::time_point time_load_started = std::chrono::high_resolution_clock::now();
 
@@ -1573,34 +1707,38 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		}
 	}
 
-	attributes += effect_name;
-	attributes += '?';
-	attributes += std::to_string(std::filesystem::last_write_time(source_file, ec).time_since_epoch().count());
-	attributes += ';';
-
-	// The actual included files are not known at this point, so detect changes to any ".fxh" files in the search paths
+	// Pre-processor state after the include block at the start of effect files is shared between all effects in the same directory, so identify it without the effect file name
+	std::string include_prefix_attributes = attributes;
+	include_prefix_attributes += "renderer=" + std::to_string(_renderer_id) + ';';
+	include_prefix_attributes += "permutation=" + std::string(permutation_index != 0 ? "1" : "0") + ';';
 	for (const std::filesystem::path &include_path : include_paths)
-	{
-		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
-		{
-			if (entry.path().extension() == L".fxh")
-			{
-				attributes += entry.path().filename().u8string();
-				attributes += '?';
-				attributes += std::to_string(entry.last_write_time(ec).time_since_epoch().count());
-				attributes += ';';
-			}
-		}
-	}
+		include_prefix_attributes += include_path.u8string() + ';';
+	include_prefix_attributes += source_file.parent_path().u8string() + ';';
 
-	effect &effect = _effects[effect_index];
+	attributes += source_file.u8string();
+
+	// Look up the files this effect permutation included the last time it was pre-processed and check whether any of them changed since
+	// The source hash is then made up of the attributes above and the contents of those files, so that only changes to files the effect actually depends on cause a recompile
+	const size_t attributes_hash = std::hash<std::string>()(attributes);
+	const std::string cache_index_key = std::to_string(attributes_hash);
+	size_t dependencies_hash = 0;
+	std::vector<std::filesystem::path> dependency_files;
+	// This also works without the effect cache, since the index is still filled in memory (it is just not loaded from or saved to disk then), so that effects are not reset on every load when their source did not change
+	const bool dependencies_unchanged = _effect_cache_index.validate(cache_index_key, dependencies_hash, nullptr, &dependency_files);
+
+	// Compile into a separate effect object when reloading in the background, since the current one is still in use for rendering
+	effect &effect = staged_effect != nullptr ? *staged_effect : _effects[effect_index];
 
-	const size_t source_hash = std::hash<std::string>()(attributes);
-	if (permutation_index == 0 && (source_file != effect.source_file || source_hash != effect.source_hash))
+	const auto combine_source_hash = [attributes_hash](size_t dependencies_hash) {
+		return attributes_hash ^ (dependencies_hash + 0x9e3779b9 + (attributes_hash << 6) + (attributes_hash >> 2));
+	};
+
+	size_t source_hash = combine_source_hash(dependencies_hash);
+	if (permutation_index == 0 && (source_file != effect.source_file || !dependencies_unchanged || source_hash != effect.source_hash))
 	{
 		if (effect.created)
 		{
-			if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
+			if (staged_effect == nullptr && _reload_remaining_effects != std::numeric_limits<size_t>::max())
 				_reload_remaining_effects--;
 			return false; // Cannot reset an effect that has not been destroyed
 		}
@@ -1629,7 +1767,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 			if (effect.skipped)
 			{
-				if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
+				if (staged_effect == nullptr && _reload_remaining_effects != std::numeric_limits<size_t>::max())
 					_reload_remaining_effects--;
 				return false;
 			}
@@ -1645,7 +1783,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	std::string source;
 	std::string errors;
 
-	if (!preprocessed && (preprocess_required || (source_cached = load_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source)) == false))
+	if (!preprocessed && (preprocess_required || !dependencies_unchanged || (source_cached = load_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source)) == false))
 	{
 		reshadefx::preprocessor pp;
 		pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
@@ -1688,7 +1826,45 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			"#define tex2Dgather3 tex2DgatherA\n");
 
 		// Load and preprocess the source file
-		preprocessed = pp.append_file(source_file);
+		const std::chrono::high_resolution_clock::time_point time_preprocess_started = std::chrono::high_resolution_clock::now();
+
+		std::string include_prefix, source_code;
+		if (reshadefx::preprocessor::split_include_prefix(source_file, include_prefix, source_code))
+		{
+			preprocessed = true;
+
+			// Most effects start by including the same headers, so try to restore the pre-processor state after those from the cache, rather than parsing the headers again for every effect
+			if (!include_prefix.empty())
+			{
+				include_prefix_attributes += include_prefix;
+
+				const std::string include_prefix_cache_key = "pp-" + std::to_string(std::hash<std::string>()(include_prefix_attributes));
+				size_t include_prefix_dependencies_hash = 0;
+
+				if (std::string state;
+					_no_effect_cache ||
+					!_effect_cache_index.validate(include_prefix_cache_key, include_prefix_dependencies_hash) ||
+					!load_effect_cache(include_prefix_cache_key + '-' + std::to_string(include_prefix_dependencies_hash), "pps", state) ||
+					!pp.deserialize_state(state))
+				{
+					// The resulting state is restored for other effects in the same directory that start with the same include block, so give it a name that does not refer to this effect file
+					// Only the file name is replaced, so that relative includes are still resolved against the same directory
+					preprocessed = pp.append_string(std::move(include_prefix), source_file.parent_path() / "<include prefix>");
+
+					// Do not save state if there were any warnings, since those would be lost when restoring it
+					if (preprocessed && pp.errors().empty() && !_no_effect_cache)
+					{
+						include_prefix_dependencies_hash = _effect_cache_index.update(include_prefix_cache_key, pp.included_files(), {});
+						save_effect_cache(include_prefix_cache_key + '-' + std::to_string(include_prefix_dependencies_hash), "pps", pp.serialize_state());
+					}
+				}
+			}
+
+			preprocessed = pp.append_string(std::move(source_code), source_file) && preprocessed;
+		}
+
+		if (permutation_index == 0)
+			effect.preprocess_duration = std::chrono::high_resolution_clock::now() - time_preprocess_started;
 
 		// Append preprocessor errors to the error list
 		errors += pp.errors();
@@ -1697,6 +1873,15 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		{
 			source = pp.output();
 
+			// Record the files that were actually included, so that the next load can tell whether cached results for this permutation are still valid
+			std::vector<std::filesystem::path> dependencies = pp.included_files();
+			dependencies.insert(dependencies.begin(), source_file);
+			dependencies_hash = _effect_cache_index.update(cache_index_key, dependencies, pp.used_macro_definitions());
+
+			source_hash = combine_source_hash(dependencies_hash);
+			if (permutation_index == 0)
+				effect.source_hash = source_hash;
+
 			// Keep track of used preprocessor definitions (so they can be displayed in the overlay)
 			for (const std::pair<std::string, std::string> &definition : pp.used_macro_definitions())
 			{
@@ -1752,10 +1937,17 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			}
 
 			std::sort(effect.definitions.begin(), effect.definitions.end());
+
+			// Included files were recorded in the cache index when the cached source was pre-processed
+			effect.included_files.clear();
+			for (const std::filesystem::path &dependency_file : dependency_files)
+				if (dependency_file != source_file)
+					effect.included_files.push_back(dependency_file);
+			std::sort(effect.included_files.begin(), effect.included_files.end());
 		}
 	}
 
-	std::unique_ptr<reshadefx::codegen> codegen;
+	std::shared_ptr<reshadefx::codegen> codegen;
 	size_t spec_constants_hash = 0;
 	if (!compiled && !source.empty())
 	{
@@ -1781,8 +1973,13 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		reshadefx::parser parser;
 
 		// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
+		const std::chrono::high_resolution_clock::time_point time_parse_started = std::chrono::high_resolution_clock::now();
+
 		compiled = parser.parse(std::move(source), codegen.get());
 
+		if (permutation_index == 0)
+			effect.parse_duration = std::chrono::high_resolution_clock::now() - time_parse_started;
+
 		// Append parser errors to the error list
 		errors  += parser.errors();
 
@@ -1838,11 +2035,14 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					else
 						variable.special = special_uniform::unknown;
 
-					// Copy initial data into uniform storage area
-					reset_uniform_value(variable);
+					// Copy initial data into uniform storage area (this is deferred until the effect is swapped in when compiling in the background)
+					if (staged_effect == nullptr)
+						reset_uniform_value(variable);
 
 					effect.uniforms.push_back(std::move(variable));
 				}
+
+				compile_special_uniform_updates(effect);
 			}
 			else
 			{
@@ -1974,16 +2174,63 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		{
 			assert(!preprocess_required);
 
-			return load_effect(source_file, preset, effect_index, permutation_index, force_load, true);
+			return load_effect(source_file, preset, effect_index, permutation_index, force_load, true, staged_effect);
 		}
 
+		const std::chrono::high_resolution_clock::time_point time_codegen_started = std::chrono::high_resolution_clock::now();
+
 		permutation.generated_code = codegen->finalize_code();
+
+		if (permutation_index == 0)
+			effect.codegen_duration = std::chrono::high_resolution_clock::now() - time_codegen_started;
 	}
 
 	if ((preprocessed || source_cached) && compiled)
 	{
-		if (permutation.cso.empty())
+		if (codegen != nullptr)
 		{
+			const std::chrono::high_resolution_clock::time_point time_assemble_started = std::chrono::high_resolution_clock::now();
+
+			permutation.cso.clear();
+			permutation.assembly.clear();
+			permutation.codegen.reset();
+			permutation.entry_point_cache_id = source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash) + '-' + std::to_string(spec_constants_hash) + '-';
+			permutation.assembling_entry_points.clear();
+
+			// Only assemble entry points of techniques that are enabled right away, the others are assembled once their technique is first enabled (see 'compile_technique')
+			std::vector<std::string> technique_list;
+			preset.get({}, "Techniques", technique_list);
+
+			std::vector<std::string> required_entry_points;
+			for (const reshadefx::technique &tech : permutation.module.techniques)
+			{
+				if (std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
+						[](const reshadefx::annotation &annotation) {
+							return annotation.name == "enabled" && (annotation.type.is_integral() ? annotation.value.as_int[0] != 0 : annotation.value.as_float[0] != 0.0f);
+						}) == tech.annotations.cend() &&
+					std::find(technique_list.cbegin(), technique_list.cend(), tech.name + '@' + effect_name) == technique_list.cend() &&
+					std::find(technique_list.cbegin(), technique_list.cend(), tech.name) == technique_list.cend())
+					continue;
+
+				for (const reshadefx::pass &pass : tech.passes)
+					for (const std::string *entry_point_name : { &pass.vs_entry_point, &pass.ps_entry_point, &pass.cs_entry_point })
+						if (!entry_point_name->empty())
+							required_entry_points.push_back(*entry_point_name);
+			}
+
+			struct assemble_job
+			{
+				const std::string *entry_point_name;
+				std::string cache_id;
+				std::string *cso;
+				std::string *assembly;
+				std::string errors;
+				bool success;
+			};
+
+			std::vector<assemble_job> assemble_jobs;
+			assemble_jobs.reserve(permutation.module.entry_points.size());
+
 			// Compile shader modules
 			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : permutation.module.entry_points)
 			{
@@ -1994,33 +2241,71 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					break;
 				}
 
+				if (std::find(required_entry_points.cbegin(), required_entry_points.cend(), entry_point.first) == required_entry_points.cend())
+				{
+					// Keep the code generator around to assemble this entry point later
+					permutation.codegen = codegen;
+					continue;
+				}
+
 				std::string &cso = permutation.cso[entry_point.first];
 				std::string &assembly = permutation.assembly[entry_point.first];
 
-				const std::string cache_id = source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash) + '-' + std::to_string(spec_constants_hash) + '-' + entry_point.first;
+				std::string cache_id = permutation.entry_point_cache_id + entry_point.first;
 
 				if (load_effect_cache(cache_id, "cso", cso) &&
 					load_effect_cache(cache_id, "asm", assembly))
-				{
 					continue;
+
+				cso.clear();
+				assembly.clear();
+
+				assemble_jobs.push_back({ &entry_point.first, std::move(cache_id), &cso, &assembly, std::string(), false });
+			}
+
+			// Entry points are independent of each other, so assemble them in parallel (this is the most expensive step for DXBC and SPIR-V)
+			if (compiled && !assemble_jobs.empty())
+			{
+				thread_pool::group assemble_group;
+
+				for (size_t i = 1; i < assemble_jobs.size(); ++i)
+				{
+					_worker_pool.submit([&codegen, &job = assemble_jobs[i]]() {
+						job.success = codegen->assemble_code_for_entry_point(*job.entry_point_name, *job.cso, *job.assembly, job.errors);
+					}, &assemble_group);
 				}
-				else
+
+				// Assemble the first entry point on this thread, rather than just waiting
+				assemble_jobs[0].success = codegen->assemble_code_for_entry_point(*assemble_jobs[0].entry_point_name, *assemble_jobs[0].cso, *assemble_jobs[0].assembly, assemble_jobs[0].errors);
+
+				_worker_pool.wait(assemble_group);
+
+				for (assemble_job &job : assemble_jobs)
 				{
-					cso.clear();
-					assembly.clear();
+					errors += job.errors;
 
-					if (!codegen->assemble_code_for_entry_point(entry_point.first, cso, assembly, errors))
+					if (!job.success)
 					{
 						compiled = false;
-						break;
+						continue;
 					}
 
-					save_effect_cache(cache_id, "cso", cso);
-					save_effect_cache(cache_id, "asm", assembly);
+					save_effect_cache(job.cache_id, "cso", *job.cso);
+					save_effect_cache(job.cache_id, "asm", *job.assembly);
 				}
 			}
+
+			if (!compiled)
+				permutation.codegen.reset();
+
+			if (permutation_index == 0)
+				effect.assemble_duration = std::chrono::high_resolution_clock::now() - time_assemble_started;
 		}
+	}
 
+	// Merging with textures and techniques of other effects has to wait until the previous version of the effect is replaced when compiling in the background (see 'update_effects')
+	if ((preprocessed || source_cached) && compiled && staged_effect == nullptr)
+	{
 		const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
 
 		for (texture new_texture : permutation.module.textures)
@@ -2076,8 +2361,13 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 				}
 
 				if (!shared_permutation)
+				{
 					existing_texture->shared.push_back(effect_index);
 
+					// Contents of a texture that is shared across effects may be expected to persist between them, so cannot alias its memory anymore
+					existing_texture->transient_technique.clear();
+				}
+
 				// Update render target and storage access flags of the existing shared texture, in case they are used as such in this effect
 				existing_texture->render_target |= new_texture.render_target;
 				existing_texture->storage_access |= new_texture.storage_access;
@@ -2128,6 +2418,9 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			// This is the first effect using this texture
 			new_texture.shared.push_back(effect_index);
 
+			if (_transient_texture_aliasing && !new_texture.annotation_as_int("pooled") && new_texture.annotation_as_string("source").empty())
+				new_texture.transient_technique = find_transient_texture_technique(permutation.module, new_texture);
+
 			_textures.push_back(std::move(new_texture));
 		}
 
@@ -2170,7 +2463,11 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 	const std::chrono::high_resolution_clock::time_point time_load_finished = std::chrono::high_resolution_clock::now();
 
-	if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
+	if (permutation_index == 0)
+		effect.load_duration = time_load_finished - time_load_started;
+
+	// Effects compiling in the background are not part of any reload yet, so must not affect its state (see 'reload_effects_in_background')
+	if (staged_effect == nullptr && _reload_remaining_effects != std::numeric_limits<size_t>::max())
 	{
 		assert(_reload_remaining_effects != 0);
 		_reload_remaining_effects--;
@@ -2186,7 +2483,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	}
 	else
 	{
-		_last_reload_successful = false;
+		if (staged_effect == nullptr)
+			_last_reload_successful = false;
 
 		if (effect.errors.empty())
 			log::message(log::level::error, "Failed to compile '%s'%s!", source_file.u8string().c_str(), permutation_index == 0 ? "" : " permutation");
@@ -2205,6 +2503,10 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	// Cannot create an effect that was not previously destroyed (ignore other permutations, since the value is already set by the default permutation)
 	assert(!effect.created || permutation_index != 0);
 
+	// Pipeline creation time is accumulated over all techniques of the default permutation, so start over whenever it is created anew
+	if (permutation_index == 0)
+		effect.pipeline_duration = {};
+
 	effect::permutation &permutation = effect.permutations[permutation_index];
 
 	// Create textures now, since they are referenced when building samplers below
@@ -2216,10 +2518,11 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 		if (tex.resource != 0)
 		{
 			if (!(tex.render_target && tex.rtv[0] == 0) &&
-				!(tex.storage_access && _renderer_id >= 0xb000 && tex.uav.empty()))
+				!(tex.storage_access && _renderer_id >= 0xb000 && tex.uav.empty()) &&
+				!(tex.transient_resource && tex.transient_technique.empty()))
 				continue;
 
-			// Update texture if usage has changed since it was last created (e.g. because a pooled texture is now used with storage access when it was not before)
+			// Update texture if usage has changed since it was last created (e.g. because a pooled texture is now used with storage access when it was not before, or a transient texture is now shared with another effect)
 			destroy_texture(tex);
 
 			// This also requires the descriptors to be updated in all effects referencing this texture, so simply recreate them
@@ -2243,16 +2546,6 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 		}
 	}
 
-	// Build specialization constants
-	std::vector<uint32_t> spec_data;
-	std::vector<uint32_t> spec_constants;
-	for (const reshadefx::uniform &spec_constant : permutation.module.spec_constants)
-	{
-		uint32_t id = static_cast<uint32_t>(spec_constants.size());
-		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
-		spec_constants.push_back(id);
-	}
-
 	// Initialize bindings
 	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
 
@@ -2364,13 +2657,22 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	}
 
 	// Create global constant buffer (except in D3D9, which does not have constant buffers)
-	api::buffer_range cb_buffer_range = {};
+	api::buffer_range cb_buffer_ranges[effect::num_cb_copies] = {};
 	if (_device->get_api() != api::device_api::d3d9 && !effect.uniform_data_storage.empty())
 	{
 		if (permutation_index == 0)
 		{
+			// Mapping with write-discard access renames the buffer in D3D10/D3D11/OpenGL, but in D3D12/Vulkan exposes the memory a previous frame may still be reading from
+			// So keep the constant buffer mapped there instead and cycle through several copies of the uniform storage in it (256 bytes is the strictest constant buffer offset alignment)
+			const bool persistently_mapped = _device->get_api() == api::device_api::d3d12 || _device->get_api() == api::device_api::vulkan;
+
+			effect.cb_stride = static_cast<uint32_t>(persistently_mapped ? (effect.uniform_data_storage.size() + 255) & ~255 : effect.uniform_data_storage.size());
+			effect.cb_index = 0;
+			std::fill_n(effect.cb_reuse_frame, effect::num_cb_copies, 0);
+			effect.uniform_data_dirty = true;
+
 			if (!_device->create_resource(
-					api::resource_desc(effect.uniform_data_storage.size(), api::memory_heap::upload, api::resource_usage::constant_buffer),
+					api::resource_desc(static_cast<uint64_t>(effect.cb_stride) * (persistently_mapped ? effect::num_cb_copies : 1), api::memory_heap::upload, api::resource_usage::constant_buffer),
 					nullptr, api::resource_usage::cpu_access, &effect.cb))
 			{
 				log::message(log::level::error, "Failed to create constant buffer for effect file '%s'!", effect.source_file.u8string().c_str());
@@ -2378,26 +2680,40 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			}
 
 			_device->set_resource_name(effect.cb, "ReShade constant buffer");
+
+			if (void *mapped_uniform_data;
+				persistently_mapped && _device->map_buffer_region(effect.cb, 0, UINT64_MAX, api::map_access::write_only, &mapped_uniform_data))
+				effect.cb_mapped = static_cast<uint8_t *>(mapped_uniform_data);
 		}
 		else
 		{
 			assert(effect.cb != 0);
 		}
 
-		if (!_device->allocate_descriptor_table(permutation.layout, 0, &permutation.cb_table))
+		const uint32_t num_cb_copies = effect.cb_mapped != nullptr ? effect::num_cb_copies : 1;
+
+		if (!_device->allocate_descriptor_tables(num_cb_copies, permutation.layout, 0, permutation.cb_tables))
 		{
 			log::message(log::level::error, "Failed to create constant buffer descriptor table for effect file '%s'!", effect.source_file.u8string().c_str());
 			goto exit_failure;
 		}
 
-		cb_buffer_range.buffer = effect.cb;
+		for (uint32_t i = 0; i < num_cb_copies; ++i)
+		{
+			cb_buffer_ranges[i].buffer = effect.cb;
+			if (effect.cb_mapped != nullptr)
+			{
+				cb_buffer_ranges[i].offset = static_cast<uint64_t>(i) * effect.cb_stride;
+				cb_buffer_ranges[i].size = effect.cb_stride;
+			}
 
-		api::descriptor_table_update &write = descriptor_writes.emplace_back();
-		write.table = permutation.cb_table;
-		write.binding = 0;
-		write.type = api::descriptor_type::constant_buffer;
-		write.count = 1;
-		write.descriptors = &cb_buffer_range;
+			api::descriptor_table_update &write = descriptor_writes.emplace_back();
+			write.table = permutation.cb_tables[i];
+			write.binding = 0;
+			write.type = api::descriptor_type::constant_buffer;
+			write.count = 1;
+			write.descriptors = &cb_buffer_ranges[i];
+		}
 	}
 
 	if (sampler_range.count != 0)
@@ -2448,85 +2764,19 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			pass.texture_table = shader_resource_view_tables[pass_index_in_effect];
 			pass.storage_table = unordered_access_view_tables[pass_index_in_effect];
 
-			std::vector<api::pipeline_subobject> subobjects;
-
-			if (!pass.cs_entry_point.empty())
-			{
-				api::shader_desc cs_desc = {};
-				const std::string &cs = permutation.cso.at(pass.cs_entry_point);
-				cs_desc.code = cs.data();
-				cs_desc.code_size = cs.size();
-				if (_renderer_id & 0x20000)
-				{
-					cs_desc.entry_point = pass.cs_entry_point.c_str();
-					cs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-					cs_desc.spec_constant_ids = spec_constants.data();
-					cs_desc.spec_constant_values = spec_data.data();
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::compute_shader, 1, &cs_desc });
-
-				if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
-				{
-					effect.errors += "error: internal compiler error";
-
-					log::message(log::level::error, "Failed to create compute pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
-					goto exit_failure;
-				}
-			}
-			else
+			if (pass.cs_entry_point.empty())
 			{
-				api::shader_desc vs_desc = {};
-				if (!pass.vs_entry_point.empty())
-				{
-					const std::string &vs = permutation.cso.at(pass.vs_entry_point);
-					vs_desc.code = vs.data();
-					vs_desc.code_size = vs.size();
-					if (_renderer_id & 0x20000)
-					{
-						vs_desc.entry_point = pass.vs_entry_point.c_str();
-						vs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-						vs_desc.spec_constant_ids = spec_constants.data();
-						vs_desc.spec_constant_values = spec_data.data();
-					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::vertex_shader, 1, &vs_desc });
-				}
-
-				api::shader_desc ps_desc = {};
-				if (!pass.ps_entry_point.empty())
-				{
-					const std::string &ps = permutation.cso.at(pass.ps_entry_point);
-					ps_desc.code = ps.data();
-					ps_desc.code_size = ps.size();
-					if (_renderer_id & 0x20000)
-					{
-						ps_desc.entry_point = pass.ps_entry_point.c_str();
-						ps_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-						ps_desc.spec_constant_ids = spec_constants.data();
-						ps_desc.spec_constant_values = spec_data.data();
-					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::pixel_shader, 1, &ps_desc });
-				}
-
-				api::format render_target_formats[8] = {};
 				if (pass.render_target_names[0].empty())
 				{
 					pass.viewport_width = _effect_permutations[permutation_index].width;
 					pass.viewport_height = _effect_permutations[permutation_index].height;
-
-					render_target_formats[0] = api::format_to_default_typed(_effect_permutations[permutation_index].color_format, pass.srgb_write_enable);
-
-					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, 1, &render_target_formats[0] });
 				}
 				else
 				{
-					int render_target_count = 0;
-					for (; render_target_count < 8 && !pass.render_target_names[render_target_count].empty(); ++render_target_count)
+					for (int render_target_index = 0; render_target_index < 8 && !pass.render_target_names[render_target_index].empty(); ++render_target_index)
 					{
 						const auto render_target_texture = std::find_if(_textures.cbegin(), _textures.cend(),
-							[&unique_name = pass.render_target_names[render_target_count]](const texture &item) {
+							[&unique_name = pass.render_target_names[render_target_index]](const texture &item) {
 								return item.unique_name == unique_name && (item.resource != 0 || !item.semantic.empty());
 							});
 						assert(render_target_texture != _textures.cend());
@@ -2534,10 +2784,7 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 						const api::resource_view rtv = render_target_texture->rtv[pass.srgb_write_enable];
 						assert(rtv != 0 && render_target_texture->semantic.empty());
 
-						pass.render_target_views[render_target_count] = rtv;
-
-						const api::resource_desc res_desc = _device->get_resource_desc(render_target_texture->resource);
-						render_target_formats[render_target_count] = api::format_to_default_typed(res_desc.texture.format, pass.srgb_write_enable);
+						pass.render_target_views[render_target_index] = rtv;
 
 						if (std::find(pass.modified_resources.cbegin(), pass.modified_resources.cend(), render_target_texture->resource) == pass.modified_resources.cend())
 						{
@@ -2547,125 +2794,6 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 								pass.generate_mipmap_views.push_back(render_target_texture->srv[0]);
 						}
 					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, static_cast<uint32_t>(render_target_count), render_target_formats });
-				}
-
-				// Only need to attach stencil if stencil is actually used in this pass
-				if (pass.stencil_enable &&
-					pass.viewport_width == _effect_permutations[permutation_index].width &&
-					pass.viewport_height == _effect_permutations[permutation_index].height)
-				{
-					subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_format, 1, &_effect_permutations[permutation_index].stencil_format });
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::max_vertex_count, 1, &pass.num_vertices });
-
-				api::primitive_topology topology = static_cast<api::primitive_topology>(pass.topology);
-				subobjects.push_back({ api::pipeline_subobject_type::primitive_topology, 1, &topology });
-
-				const auto convert_blend_op = [](reshadefx::blend_op value) {
-					switch (value)
-					{
-					default:
-					case reshadefx::blend_op::add: return api::blend_op::add;
-					case reshadefx::blend_op::subtract: return api::blend_op::subtract;
-					case reshadefx::blend_op::reverse_subtract: return api::blend_op::reverse_subtract;
-					case reshadefx::blend_op::min: return api::blend_op::min;
-					case reshadefx::blend_op::max: return api::blend_op::max;
-					}
-				};
-				const auto convert_blend_factor = [](reshadefx::blend_factor value) {
-					switch (value) {
-					case reshadefx::blend_factor::zero: return api::blend_factor::zero;
-					default:
-					case reshadefx::blend_factor::one: return api::blend_factor::one;
-					case reshadefx::blend_factor::source_color: return api::blend_factor::source_color;
-					case reshadefx::blend_factor::one_minus_source_color: return api::blend_factor::one_minus_source_color;
-					case reshadefx::blend_factor::dest_color: return api::blend_factor::dest_color;
-					case reshadefx::blend_factor::one_minus_dest_color: return api::blend_factor::one_minus_dest_color;
-					case reshadefx::blend_factor::source_alpha: return api::blend_factor::source_alpha;
-					case reshadefx::blend_factor::one_minus_source_alpha: return api::blend_factor::one_minus_source_alpha;
-					case reshadefx::blend_factor::dest_alpha: return api::blend_factor::dest_alpha;
-					case reshadefx::blend_factor::one_minus_dest_alpha: return api::blend_factor::one_minus_dest_alpha;
-					}
-				};
-
-				// Technically should check for 'api::device_caps::independent_blend' support, but render target write masks are supported in D3D9, when rest is not, so just always set ...
-				api::blend_desc blend_state = {};
-				for (int i = 0; i < 8; ++i)
-				{
-					blend_state.blend_enable[i] = pass.blend_enable[i];
-					blend_state.source_color_blend_factor[i] = convert_blend_factor(pass.source_color_blend_factor[i]);
-					blend_state.dest_color_blend_factor[i] = convert_blend_factor(pass.dest_color_blend_factor[i]);
-					blend_state.color_blend_op[i] = convert_blend_op(pass.color_blend_op[i]);
-					blend_state.source_alpha_blend_factor[i] = convert_blend_factor(pass.source_alpha_blend_factor[i]);
-					blend_state.dest_alpha_blend_factor[i] = convert_blend_factor(pass.dest_alpha_blend_factor[i]);
-					blend_state.alpha_blend_op[i] = convert_blend_op(pass.alpha_blend_op[i]);
-					blend_state.render_target_write_mask[i] = pass.render_target_write_mask[i];
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::blend_state, 1, &blend_state });
-
-				api::rasterizer_desc rasterizer_state = {};
-				rasterizer_state.cull_mode = api::cull_mode::none;
-
-				subobjects.push_back({ api::pipeline_subobject_type::rasterizer_state, 1, &rasterizer_state });
-
-				const auto convert_stencil_op = [](reshadefx::stencil_op value) {
-					switch (value) {
-					case reshadefx::stencil_op::zero: return api::stencil_op::zero;
-					default:
-					case reshadefx::stencil_op::keep: return api::stencil_op::keep;
-					case reshadefx::stencil_op::replace: return api::stencil_op::replace;
-					case reshadefx::stencil_op::increment_saturate: return api::stencil_op::increment_saturate;
-					case reshadefx::stencil_op::decrement_saturate: return api::stencil_op::decrement_saturate;
-					case reshadefx::stencil_op::invert: return api::stencil_op::invert;
-					case reshadefx::stencil_op::increment: return api::stencil_op::increment;
-					case reshadefx::stencil_op::decrement: return api::stencil_op::decrement;
-					}
-				};
-				const auto convert_stencil_func = [](reshadefx::stencil_func value) {
-					switch (value)
-					{
-					case reshadefx::stencil_func::never: return api::compare_op::never;
-					case reshadefx::stencil_func::less: return api::compare_op::less;
-					case reshadefx::stencil_func::equal: return api::compare_op::equal;
-					case reshadefx::stencil_func::less_equal: return api::compare_op::less_equal;
-					case reshadefx::stencil_func::greater: return api::compare_op::greater;
-					case reshadefx::stencil_func::not_equal: return api::compare_op::not_equal;
-					case reshadefx::stencil_func::greater_equal: return api::compare_op::greater_equal;
-					default:
-					case reshadefx::stencil_func::always: return api::compare_op::always;
-					}
-				};
-
-				api::depth_stencil_desc depth_stencil_state = {};
-				depth_stencil_state.depth_enable = false;
-				depth_stencil_state.depth_write_mask = false;
-				depth_stencil_state.depth_func = api::compare_op::always;
-				depth_stencil_state.stencil_enable = pass.stencil_enable;
-				depth_stencil_state.front_stencil_read_mask = pass.stencil_read_mask;
-				depth_stencil_state.front_stencil_write_mask = pass.stencil_write_mask;
-				depth_stencil_state.front_stencil_func = convert_stencil_func(pass.stencil_comparison_func);
-				depth_stencil_state.front_stencil_fail_op = convert_stencil_op(pass.stencil_fail_op);
-				depth_stencil_state.front_stencil_depth_fail_op = convert_stencil_op(pass.stencil_depth_fail_op);
-				depth_stencil_state.front_stencil_pass_op = convert_stencil_op(pass.stencil_pass_op);
-				depth_stencil_state.back_stencil_read_mask = depth_stencil_state.front_stencil_read_mask;
-				depth_stencil_state.back_stencil_write_mask = depth_stencil_state.front_stencil_write_mask;
-				depth_stencil_state.back_stencil_func = depth_stencil_state.front_stencil_func;
-				depth_stencil_state.back_stencil_fail_op = depth_stencil_state.front_stencil_fail_op;
-				depth_stencil_state.back_stencil_depth_fail_op = depth_stencil_state.front_stencil_depth_fail_op;
-				depth_stencil_state.back_stencil_pass_op = depth_stencil_state.front_stencil_pass_op;
-
-				subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_state, 1, &depth_stencil_state });
-
-				if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
-				{
-					effect.errors += "error: internal compiler error";
-
-					log::message(log::level::error, "Failed to create graphics pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
-					goto exit_failure;
 				}
 			}
 
@@ -2760,7 +2888,8 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				if (!sampler_texture->semantic.empty())
 				{
 					if (sampler_texture->semantic == "COLOR")
-						srv = _effect_permutations[permutation_index].color_srv[binding.srgb];
+						srv = _effect_permutations[permutation_index].color_srv[binding.srgb],
+						pass.samples_back_buffer = true;
 					else if (const auto it = _texture_semantic_bindings.find(sampler_texture->semantic); it != _texture_semantic_bindings.end())
 						srv = binding.srgb ? it->second.second : it->second.first;
 					else
@@ -2778,6 +2907,11 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				else
 				{
 					srv = sampler_texture->srv[binding.srgb];
+
+					// Only textures that can be rendered to or written as storage can be in a state other than shader resource when sampled
+					if ((sampler_texture->rtv[0] != 0 || !sampler_texture->uav.empty()) &&
+						std::find(pass.sampled_resources.cbegin(), pass.sampled_resources.cend(), sampler_texture->resource) == pass.sampled_resources.cend())
+						pass.sampled_resources.push_back(sampler_texture->resource);
 				}
 
 				assert(srv != 0);
@@ -2813,7 +2947,19 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			}
 		}
 
+		// Without knowing which passes sample the back buffer, it would have to be copied before the first pass and after every other pass that rendered to it
+		tech.permutations[permutation_index].max_back_buffer_copies = 0;
+		for (size_t pass_index = 0; pass_index < tech.permutations[permutation_index].passes.size(); ++pass_index)
+		{
+			if (pass_index == 0 || (tech.permutations[permutation_index].passes[pass_index - 1].cs_entry_point.empty() && tech.permutations[permutation_index].passes[pass_index - 1].render_target_names[0].empty()))
+				tech.permutations[permutation_index].max_back_buffer_copies++;
+		}
+
 		tech.permutations[permutation_index].created = true;
+
+		// Pipelines of techniques that are not enabled are only created once they are first enabled (see 'enable_technique'), except for those that are likely to be toggled soon
+		if ((tech.enabled || (_technique_prewarming && tech.toggle_key_data[0] != 0)) && !compile_technique(tech, permutation_index))
+			goto exit_failure;
 	}
 
 	if (!descriptor_writes.empty())
@@ -2831,56 +2977,454 @@ exit_failure:
 
 	return false;
 }
-void reshade::runtime::destroy_effect(size_t effect_index, bool unload)
+bool reshade::runtime::create_technique_pipelines(technique &tech, size_t permutation_index)
 {
-	assert(effect_index < _effects.size());
-
-	for (technique &tech : _techniques)
-	{
-		if (tech.effect_index != effect_index)
-			continue;
-
-		for (technique::permutation &permutation : tech.permutations)
-		{
-			for (technique::pass &pass : permutation.passes)
-			{
-				_device->destroy_pipeline(pass.pipeline);
-				pass.pipeline = {};
+	effect &effect = _effects[tech.effect_index];
+	const effect::permutation &permutation = effect.permutations[permutation_index];
 
-				_device->free_descriptor_table(pass.texture_table);
-				pass.texture_table = {};
-				_device->free_descriptor_table(pass.storage_table);
-				pass.storage_table = {};
+	assert(tech.permutations[permutation_index].created && !tech.permutations[permutation_index].pipelines_created);
 
-				std::fill_n(pass.render_target_views, 8, api::resource_view {});
-				pass.modified_resources.clear();
-				pass.generate_mipmap_views.clear();
-			}
+	const std::chrono::high_resolution_clock::time_point time_pipelines_started = std::chrono::high_resolution_clock::now();
 
-			permutation.created = false;
-		}
+	// Build specialization constants
+	std::vector<uint32_t> spec_data;
+	std::vector<uint32_t> spec_constants;
+	for (const reshadefx::uniform &spec_constant : permutation.module.spec_constants)
+	{
+		uint32_t id = static_cast<uint32_t>(spec_constants.size());
+		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
+		spec_constants.push_back(id);
 	}
 
-	effect &effect = _effects[effect_index];
+	for (size_t pass_index = 0; pass_index < tech.permutations[permutation_index].passes.size(); ++pass_index)
 	{
-		_device->destroy_resource(effect.cb);
-		effect.cb = {};
-
-		_device->destroy_query_heap(effect.query_heap);
-		effect.query_heap = {};
+		technique::pass &pass = tech.permutations[permutation_index].passes[pass_index];
 
-		for (effect::permutation &permutation : effect.permutations)
-		{
-			_device->free_descriptor_table(permutation.cb_table);
-			permutation.cb_table = {};
-			_device->free_descriptor_table(permutation.sampler_table);
-			permutation.sampler_table = {};
+		// Pipelines of previous passes may exist if creation failed for a later pass the last time
+		if (pass.pipeline != 0)
+			continue;
 
-			_device->destroy_pipeline_layout(permutation.layout);
-			permutation.layout = {};
+		std::vector<api::pipeline_subobject> subobjects;
 
-			permutation.texture_semantic_to_binding.clear();
-		}
+		if (_effect_pipeline_cache != 0)
+			subobjects.push_back({ api::pipeline_subobject_type::pipeline_cache, 1, &_effect_pipeline_cache });
+
+		if (!pass.cs_entry_point.empty())
+		{
+			api::shader_desc cs_desc = {};
+			const std::string &cs = permutation.cso.at(pass.cs_entry_point);
+			cs_desc.code = cs.data();
+			cs_desc.code_size = cs.size();
+			if (_renderer_id & 0x20000)
+			{
+				cs_desc.entry_point = pass.cs_entry_point.c_str();
+				cs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+				cs_desc.spec_constant_ids = spec_constants.data();
+				cs_desc.spec_constant_values = spec_data.data();
+			}
+
+			subobjects.push_back({ api::pipeline_subobject_type::compute_shader, 1, &cs_desc });
+
+			if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
+			{
+				effect.errors += "error: internal compiler error";
+
+				log::message(log::level::error, "Failed to create compute pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
+				return false;
+			}
+		}
+		else
+		{
+			api::shader_desc vs_desc = {};
+			if (!pass.vs_entry_point.empty())
+			{
+				const std::string &vs = permutation.cso.at(pass.vs_entry_point);
+				vs_desc.code = vs.data();
+				vs_desc.code_size = vs.size();
+				if (_renderer_id & 0x20000)
+				{
+					vs_desc.entry_point = pass.vs_entry_point.c_str();
+					vs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+					vs_desc.spec_constant_ids = spec_constants.data();
+					vs_desc.spec_constant_values = spec_data.data();
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::vertex_shader, 1, &vs_desc });
+			}
+
+			api::shader_desc ps_desc = {};
+			if (!pass.ps_entry_point.empty())
+			{
+				const std::string &ps = permutation.cso.at(pass.ps_entry_point);
+				ps_desc.code = ps.data();
+				ps_desc.code_size = ps.size();
+				if (_renderer_id & 0x20000)
+				{
+					ps_desc.entry_point = pass.ps_entry_point.c_str();
+					ps_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+					ps_desc.spec_constant_ids = spec_constants.data();
+					ps_desc.spec_constant_values = spec_data.data();
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::pixel_shader, 1, &ps_desc });
+			}
+
+			api::format render_target_formats[8] = {};
+			if (pass.render_target_names[0].empty())
+			{
+				render_target_formats[0] = api::format_to_default_typed(_effect_permutations[permutation_index].color_format, pass.srgb_write_enable);
+
+				subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, 1, &render_target_formats[0] });
+			}
+			else
+			{
+				// Render target views were already looked up when the effect was created
+				int render_target_count = 0;
+				for (; render_target_count < 8 && pass.render_target_views[render_target_count] != 0; ++render_target_count)
+				{
+					const api::resource_desc res_desc = _device->get_resource_desc(_device->get_resource_from_view(pass.render_target_views[render_target_count]));
+					render_target_formats[render_target_count] = api::format_to_default_typed(res_desc.texture.format, pass.srgb_write_enable);
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, static_cast<uint32_t>(render_target_count), render_target_formats });
+			}
+
+			// Only need to attach stencil if stencil is actually used in this pass
+			if (pass.stencil_enable &&
+				pass.viewport_width == _effect_permutations[permutation_index].width &&
+				pass.viewport_height == _effect_permutations[permutation_index].height)
+			{
+				subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_format, 1, &_effect_permutations[permutation_index].stencil_format });
+			}
+
+			subobjects.push_back({ api::pipeline_subobject_type::max_vertex_count, 1, &pass.num_vertices });
+
+			api::primitive_topology topology = static_cast<api::primitive_topology>(pass.topology);
+			subobjects.push_back({ api::pipeline_subobject_type::primitive_topology, 1, &topology });
+
+			const auto convert_blend_op = [](reshadefx::blend_op value) {
+				switch (value)
+				{
+				default:
+				case reshadefx::blend_op::add: return api::blend_op::add;
+				case reshadefx::blend_op::subtract: return api::blend_op::subtract;
+				case reshadefx::blend_op::reverse_subtract: return api::blend_op::reverse_subtract;
+				case reshadefx::blend_op::min: return api::blend_op::min;
+				case reshadefx::blend_op::max: return api::blend_op::max;
+				}
+			};
+			const auto convert_blend_factor = [](reshadefx::blend_factor value) {
+				switch (value) {
+				case reshadefx::blend_factor::zero: return api::blend_factor::zero;
+				default:
+				case reshadefx::blend_factor::one: return api::blend_factor::one;
+				case reshadefx::blend_factor::source_color: return api::blend_factor::source_color;
+				case reshadefx::blend_factor::one_minus_source_color: return api::blend_factor::one_minus_source_color;
+				case reshadefx::blend_factor::dest_color: return api::blend_factor::dest_color;
+				case reshadefx::blend_factor::one_minus_dest_color: return api::blend_factor::one_minus_dest_color;
+				case reshadefx::blend_factor::source_alpha: return api::blend_factor::source_alpha;
+				case reshadefx::blend_factor::one_minus_source_alpha: return api::blend_factor::one_minus_source_alpha;
+				case reshadefx::blend_factor::dest_alpha: return api::blend_factor::dest_alpha;
+				case reshadefx::blend_factor::one_minus_dest_alpha: return api::blend_factor::one_minus_dest_alpha;
+				}
+			};
+
+			// Technically should check for 'api::device_caps::independent_blend' support, but render target write masks are supported in D3D9, when rest is not, so just always set ...
+			api::blend_desc blend_state = {};
+			for (int i = 0; i < 8; ++i)
+			{
+				blend_state.blend_enable[i] = pass.blend_enable[i];
+				blend_state.source_color_blend_factor[i] = convert_blend_factor(pass.source_color_blend_factor[i]);
+				blend_state.dest_color_blend_factor[i] = convert_blend_factor(pass.dest_color_blend_factor[i]);
+				blend_state.color_blend_op[i] = convert_blend_op(pass.color_blend_op[i]);
+				blend_state.source_alpha_blend_factor[i] = convert_blend_factor(pass.source_alpha_blend_factor[i]);
+				blend_state.dest_alpha_blend_factor[i] = convert_blend_factor(pass.dest_alpha_blend_factor[i]);
+				blend_state.alpha_blend_op[i] = convert_blend_op(pass.alpha_blend_op[i]);
+				blend_state.render_target_write_mask[i] = pass.render_target_write_mask[i];
+			}
+
+			subobjects.push_back({ api::pipeline_subobject_type::blend_state, 1, &blend_state });
+
+			api::rasterizer_desc rasterizer_state = {};
+			rasterizer_state.cull_mode = api::cull_mode::none;
+
+			subobjects.push_back({ api::pipeline_subobject_type::rasterizer_state, 1, &rasterizer_state });
+
+			const auto convert_stencil_op = [](reshadefx::stencil_op value) {
+				switch (value) {
+				case reshadefx::stencil_op::zero: return api::stencil_op::zero;
+				default:
+				case reshadefx::stencil_op::keep: return api::stencil_op::keep;
+				case reshadefx::stencil_op::replace: return api::stencil_op::replace;
+				case reshadefx::stencil_op::increment_saturate: return api::stencil_op::increment_saturate;
+				case reshadefx::stencil_op::decrement_saturate: return api::stencil_op::decrement_saturate;
+				case reshadefx::stencil_op::invert: return api::stencil_op::invert;
+				case reshadefx::stencil_op::increment: return api::stencil_op::increment;
+				case reshadefx::stencil_op::decrement: return api::stencil_op::decrement;
+				}
+			};
+			const auto convert_stencil_func = [](reshadefx::stencil_func value) {
+				switch (value)
+				{
+				case reshadefx::stencil_func::never: return api::compare_op::never;
+				case reshadefx::stencil_func::less: return api::compare_op::less;
+				case reshadefx::stencil_func::equal: return api::compare_op::equal;
+				case reshadefx::stencil_func::less_equal: return api::compare_op::less_equal;
+				case reshadefx::stencil_func::greater: return api::compare_op::greater;
+				case reshadefx::stencil_func::not_equal: return api::compare_op::not_equal;
+				case reshadefx::stencil_func::greater_equal: return api::compare_op::greater_equal;
+				default:
+				case reshadefx::stencil_func::always: return api::compare_op::always;
+				}
+			};
+
+			api::depth_stencil_desc depth_stencil_state = {};
+			depth_stencil_state.depth_enable = false;
+			depth_stencil_state.depth_write_mask = false;
+			depth_stencil_state.depth_func = api::compare_op::always;
+			depth_stencil_state.stencil_enable = pass.stencil_enable;
+			depth_stencil_state.front_stencil_read_mask = pass.stencil_read_mask;
+			depth_stencil_state.front_stencil_write_mask = pass.stencil_write_mask;
+			depth_stencil_state.front_stencil_func = convert_stencil_func(pass.stencil_comparison_func);
+			depth_stencil_state.front_stencil_fail_op = convert_stencil_op(pass.stencil_fail_op);
+			depth_stencil_state.front_stencil_depth_fail_op = convert_stencil_op(pass.stencil_depth_fail_op);
+			depth_stencil_state.front_stencil_pass_op = convert_stencil_op(pass.stencil_pass_op);
+			depth_stencil_state.back_stencil_read_mask = depth_stencil_state.front_stencil_read_mask;
+			depth_stencil_state.back_stencil_write_mask = depth_stencil_state.front_stencil_write_mask;
+			depth_stencil_state.back_stencil_func = depth_stencil_state.front_stencil_func;
+			depth_stencil_state.back_stencil_fail_op = depth_stencil_state.front_stencil_fail_op;
+			depth_stencil_state.back_stencil_depth_fail_op = depth_stencil_state.front_stencil_depth_fail_op;
+			depth_stencil_state.back_stencil_pass_op = depth_stencil_state.front_stencil_pass_op;
+
+			subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_state, 1, &depth_stencil_state });
+
+			if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
+			{
+				effect.errors += "error: internal compiler error";
+
+				log::message(log::level::error, "Failed to create graphics pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
+				return false;
+			}
+		}
+	}
+
+	tech.permutations[permutation_index].pipelines_created = true;
+
+	if (permutation_index == 0)
+		effect.pipeline_duration += std::chrono::high_resolution_clock::now() - time_pipelines_started;
+
+	return true;
+}
+bool reshade::runtime::compile_technique(technique &tech, size_t permutation_index)
+{
+	if (tech.permutations[permutation_index].pipelines_created)
+		return true;
+
+	effect::permutation &permutation = _effects[tech.effect_index].permutations[permutation_index];
+
+	// Assemble entry points that were skipped while loading the effect in the background and only create the pipelines once all of them are available (see 'update_assembled_entry_points')
+	bool assembled = true;
+	for (const technique::pass &pass : tech.permutations[permutation_index].passes)
+	{
+		for (const std::string *entry_point_name : { &pass.vs_entry_point, &pass.ps_entry_point, &pass.cs_entry_point })
+		{
+			if (entry_point_name->empty() || permutation.cso.find(*entry_point_name) != permutation.cso.end())
+				continue;
+
+			assembled = false;
+
+			// Entry points may be shared by multiple techniques, so avoid assembling them more than once
+			if (std::find(permutation.assembling_entry_points.cbegin(), permutation.assembling_entry_points.cend(), *entry_point_name) != permutation.assembling_entry_points.cend())
+				continue;
+
+			if (permutation.codegen == nullptr)
+			{
+				log::message(log::level::error, "Entry point '%s' in '%s' is missing!", entry_point_name->c_str(), _effects[tech.effect_index].source_file.u8string().c_str());
+				return false;
+			}
+
+			permutation.assembling_entry_points.push_back(*entry_point_name);
+
+			_worker_pool.submit([this, effect_index = tech.effect_index, permutation_index, codegen = permutation.codegen, name = *entry_point_name, cache_id = permutation.entry_point_cache_id + *entry_point_name]() {
+				assembled_entry_point entry_point { effect_index, permutation_index, codegen, name };
+
+				if (load_effect_cache(cache_id, "cso", entry_point.cso) &&
+					load_effect_cache(cache_id, "asm", entry_point.assembly))
+				{
+					entry_point.success = true;
+				}
+				else
+				{
+					entry_point.cso.clear();
+					entry_point.assembly.clear();
+
+					entry_point.success = codegen->assemble_code_for_entry_point(name, entry_point.cso, entry_point.assembly, entry_point.errors);
+
+					if (entry_point.success)
+					{
+						save_effect_cache(cache_id, "cso", entry_point.cso);
+						save_effect_cache(cache_id, "asm", entry_point.assembly);
+					}
+				}
+
+				const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+				_assembled_entry_points.push_back(std::move(entry_point));
+			});
+		}
+	}
+
+	// Pipelines can only be created after the effect was, which will call this again (see 'create_effect')
+	if (!assembled || !tech.permutations[permutation_index].created)
+		return true;
+
+	return create_technique_pipelines(tech, permutation_index);
+}
+void reshade::runtime::update_assembled_entry_points()
+{
+	std::vector<assembled_entry_point> assembled_entry_points;
+	{
+		const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+
+		if (_assembled_entry_points.empty())
+			return;
+
+		assembled_entry_points.swap(_assembled_entry_points);
+	}
+
+	std::vector<std::pair<size_t, size_t>> updated_permutations;
+
+	for (assembled_entry_point &entry_point : assembled_entry_points)
+	{
+		if (entry_point.effect_index >= _effects.size() || entry_point.permutation_index >= _effects[entry_point.effect_index].permutations.size())
+			continue;
+
+		effect &effect = _effects[entry_point.effect_index];
+		effect::permutation &permutation = effect.permutations[entry_point.permutation_index];
+
+		// Ignore entry points that were assembled for a previous version of the effect, which was reloaded in the meantime
+		if (permutation.codegen != entry_point.codegen)
+			continue;
+
+		permutation.assembling_entry_points.erase(std::remove(permutation.assembling_entry_points.begin(), permutation.assembling_entry_points.end(), entry_point.name), permutation.assembling_entry_points.end());
+
+		effect.errors += entry_point.errors;
+
+		if (!entry_point.success)
+		{
+			log::message(log::level::error, "Failed to compile entry point '%s' in '%s':\n%s", entry_point.name.c_str(), effect.source_file.u8string().c_str(), entry_point.errors.c_str());
+
+			// Disable all techniques using this entry point, since they cannot be rendered
+			for (technique &tech : _techniques)
+			{
+				if (tech.effect_index != entry_point.effect_index || entry_point.permutation_index >= tech.permutations.size())
+					continue;
+
+				if (std::find_if(tech.permutations[entry_point.permutation_index].passes.cbegin(), tech.permutations[entry_point.permutation_index].passes.cend(),
+						[&name = entry_point.name](const technique::pass &pass) {
+							return pass.vs_entry_point == name || pass.ps_entry_point == name || pass.cs_entry_point == name;
+						}) != tech.permutations[entry_point.permutation_index].passes.cend())
+					disable_technique(tech);
+			}
+			continue;
+		}
+
+		permutation.cso[entry_point.name] = std::move(entry_point.cso);
+		permutation.assembly[entry_point.name] = std::move(entry_point.assembly);
+
+		// Release the code generator again once all entry points were assembled
+		if (permutation.cso.size() == permutation.module.entry_points.size())
+			permutation.codegen.reset();
+
+		if (std::find(updated_permutations.cbegin(), updated_permutations.cend(), std::make_pair(entry_point.effect_index, entry_point.permutation_index)) == updated_permutations.cend())
+			updated_permutations.emplace_back(entry_point.effect_index, entry_point.permutation_index);
+	}
+
+	// Create pipelines of all techniques that were waiting on these entry points
+	for (technique &tech : _techniques)
+	{
+		if (!tech.enabled && !(_technique_prewarming && tech.toggle_key_data[0] != 0))
+			continue;
+
+		for (const auto [effect_index, permutation_index] : updated_permutations)
+		{
+			if (tech.effect_index != effect_index || permutation_index >= tech.permutations.size() || !tech.permutations[permutation_index].created)
+				continue;
+
+			if (!compile_technique(tech, permutation_index))
+				disable_technique(tech);
+		}
+	}
+}
+template <typename T>
+void reshade::runtime::destroy_effect_object(T object, void(api::device:: *destroy_func)(T))
+{
+	if (object == 0)
+		return;
+
+	if (_defer_effect_object_destruction)
+		// Assume there are never more frames in flight than the constant buffer ring has copies (see 'render_technique')
+		_deferred_effect_object_destructions.emplace_back(_frame_count + effect::num_cb_copies, [device = _device, object, destroy_func]() { (device->*destroy_func)(object); });
+	else
+		(_device->*destroy_func)(object);
+}
+
+void reshade::runtime::destroy_effect(size_t effect_index, bool unload)
+{
+	assert(effect_index < _effects.size());
+
+	for (technique &tech : _techniques)
+	{
+		if (tech.effect_index != effect_index)
+			continue;
+
+		for (technique::permutation &permutation : tech.permutations)
+		{
+			for (technique::pass &pass : permutation.passes)
+			{
+				destroy_effect_object(pass.pipeline, &api::device::destroy_pipeline);
+				pass.pipeline = {};
+
+				destroy_effect_object(pass.texture_table, &api::device::free_descriptor_table);
+				pass.texture_table = {};
+				destroy_effect_object(pass.storage_table, &api::device::free_descriptor_table);
+				pass.storage_table = {};
+
+				std::fill_n(pass.render_target_views, 8, api::resource_view {});
+				pass.modified_resources.clear();
+				pass.generate_mipmap_views.clear();
+			}
+
+			permutation.created = false;
+			permutation.pipelines_created = false;
+		}
+	}
+
+	effect &effect = _effects[effect_index];
+	{
+		if (effect.cb_mapped != nullptr)
+			_device->unmap_buffer_region(effect.cb);
+		effect.cb_mapped = nullptr;
+		destroy_effect_object(effect.cb, &api::device::destroy_resource);
+		effect.cb = {};
+
+		destroy_effect_object(effect.query_heap, &api::device::destroy_query_heap);
+		effect.query_heap = {};
+
+		for (effect::permutation &permutation : effect.permutations)
+		{
+			for (api::descriptor_table &cb_table : permutation.cb_tables)
+			{
+				destroy_effect_object(cb_table, &api::device::free_descriptor_table);
+				cb_table = {};
+			}
+			destroy_effect_object(permutation.sampler_table, &api::device::free_descriptor_table);
+			permutation.sampler_table = {};
+
+			destroy_effect_object(permutation.layout, &api::device::destroy_pipeline_layout);
+			permutation.layout = {};
+
+			permutation.texture_semantic_to_binding.clear();
+		}
 
 		effect.created = false;
 	}
@@ -3120,6 +3664,9 @@ bool reshade::runtime::create_texture(texture &tex)
 	if (!tex.semantic.empty())
 		return true;
 
+	if (!tex.transient_technique.empty() && tex.shared.size() == 1)
+		return create_transient_texture(tex);
+
 	api::resource_type type = api::resource_type::unknown;
 	api::resource_view_type view_type = api::resource_view_type::unknown;
 
@@ -3244,6 +3791,11 @@ bool reshade::runtime::create_texture(texture &tex)
 
 	_device->set_resource_name(tex.resource, tex.unique_name.c_str());
 
+	const uint64_t memory_size = calc_texture_memory_size(_device->get_resource_desc(tex.resource));
+	_texture_memory_size += memory_size;
+	_texture_memory_size_peak = std::max(_texture_memory_size_peak, _texture_memory_size);
+	_texture_memory_size_unaliased += memory_size;
+
 	// Always create shader resource views
 	{
 		if (!_device->create_resource_view(tex.resource, api::resource_usage::shader_resource, api::resource_view_desc(view_type, view_format, 0, tex.levels, 0, UINT32_MAX), &tex.srv[0]))
@@ -3305,25 +3857,98 @@ bool reshade::runtime::create_texture(texture &tex)
 
 	return true;
 }
+bool reshade::runtime::create_transient_texture(texture &tex)
+{
+	assert(tex.shared.size() == 1 && tex.resource == 0);
+
+	// Find an allocation with a matching description that no other texture of the same technique uses yet
+	auto allocation = std::find_if(_transient_textures.begin(), _transient_textures.end(),
+		[&tex](const transient_texture_allocation &item) {
+			return item.tex.matches_description(tex) && std::none_of(item.references.begin(), item.references.end(),
+				[&tex](const transient_texture_allocation::reference &reference) {
+					return reference.effect_index == tex.shared[0] && reference.technique_name == tex.transient_technique;
+				});
+		});
+	if (allocation == _transient_textures.end())
+	{
+		transient_texture_allocation new_allocation { tex, {} };
+		new_allocation.tex.transient_technique.clear();
+
+		if (!create_texture(new_allocation.tex))
+		{
+			destroy_texture(new_allocation.tex);
+			return false;
+		}
+
+		allocation = _transient_textures.insert(_transient_textures.end(), std::move(new_allocation));
+	}
+	else
+	{
+		_texture_memory_size_unaliased += calc_texture_memory_size(_device->get_resource_desc(allocation->tex.resource));
+	}
+
+	allocation->references.push_back({ tex.unique_name, tex.shared[0], tex.transient_technique });
+
+	tex.transient_resource = true;
+	tex.resource = allocation->tex.resource;
+	std::copy_n(allocation->tex.srv, 2, tex.srv);
+	std::copy_n(allocation->tex.rtv, 2, tex.rtv);
+
+	return true;
+}
 void reshade::runtime::destroy_texture(texture &tex)
 {
-	_device->destroy_resource(tex.resource);
+	if (tex.transient_resource)
+	{
+		const auto allocation = std::find_if(_transient_textures.begin(), _transient_textures.end(),
+			[&tex](const transient_texture_allocation &item) { return item.tex.resource == tex.resource; });
+		assert(allocation != _transient_textures.end());
+
+		allocation->references.erase(std::remove_if(allocation->references.begin(), allocation->references.end(),
+			[&tex](const transient_texture_allocation::reference &reference) { return reference.texture_name == tex.unique_name; }), allocation->references.end());
+
+		// Only destroy the shared resource once the last texture referencing it is gone
+		if (allocation->references.empty())
+		{
+			destroy_texture(allocation->tex);
+			_transient_textures.erase(allocation);
+		}
+		else
+		{
+			_texture_memory_size_unaliased -= calc_texture_memory_size(_device->get_resource_desc(tex.resource));
+		}
+
+		tex.transient_resource = false;
+		tex.resource = {};
+		std::fill_n(tex.srv, 2, api::resource_view {});
+		std::fill_n(tex.rtv, 2, api::resource_view {});
+		return;
+	}
+
+	if (tex.resource != 0)
+	{
+		const uint64_t memory_size = calc_texture_memory_size(_device->get_resource_desc(tex.resource));
+		_texture_memory_size -= memory_size;
+		_texture_memory_size_unaliased -= memory_size;
+	}
+
+	destroy_effect_object(tex.resource, &api::device::destroy_resource);
 	tex.resource = {};
 
-	_device->destroy_resource_view(tex.srv[0]);
+	destroy_effect_object(tex.srv[0], &api::device::destroy_resource_view);
 	if (tex.srv[1] != tex.srv[0])
-		_device->destroy_resource_view(tex.srv[1]);
+		destroy_effect_object(tex.srv[1], &api::device::destroy_resource_view);
 	tex.srv[0] = {};
 	tex.srv[1] = {};
 
-	_device->destroy_resource_view(tex.rtv[0]);
+	destroy_effect_object(tex.rtv[0], &api::device::destroy_resource_view);
 	if (tex.rtv[1] != tex.rtv[0])
-		_device->destroy_resource_view(tex.rtv[1]);
+		destroy_effect_object(tex.rtv[1], &api::device::destroy_resource_view);
 	tex.rtv[0] = {};
 	tex.rtv[1] = {};
 
 	for (const api::resource_view uav : tex.uav)
-		_device->destroy_resource_view(uav);
+		destroy_effect_object(uav, &api::device::destroy_resource_view);
 	tex.uav.clear();
 }
 
@@ -3416,7 +4041,7 @@ void reshade::runtime::load_effects(bool force_load_all)
 
 	ini_file &preset = ini_file::load_cache(_current_preset_path);
 
-	// Have to be initialized at this point or else the threads spawned below will immediately exit without reducing the remaining effects count
+	// Have to be initialized at this point or else the jobs submitted below will immediately exit without reducing the remaining effects count
 	assert(_is_initialized);
 
 	// Reload preprocessor definitions from current preset before compiling to avoid having to recompile again when preset is applied in 'update_effects'
@@ -3425,27 +4050,41 @@ void reshade::runtime::load_effects(bool force_load_all)
 	for (const std::filesystem::path &effect_file : effect_files)
 		preset.get(effect_file.filename().u8string(), "PreprocessorDefinitions", _preset_preprocessor_definitions[effect_file.filename().u8string()]);
 
+	// Read the dependency information recorded during previous loads, so that effects whose files did not change can be loaded from cache
+	if (!_no_effect_cache)
+		_effect_cache_index.load(g_reshade_base_path / _effect_cache_path / L"reshade-effects.cache");
+
 	// Allocate space for effects which are placed in this array during the 'load_effect' call
 	const size_t offset = _effects.size();
 	_effects.resize(offset + effect_files.size());
 	_reload_remaining_effects = effect_files.size();
 
 	// Now that we have a list of files, load them in parallel
-	// Split workload into batches instead of launching a thread for every file to avoid launch overhead and stutters due to too many threads being in flight
-	size_t num_splits = std::min(effect_files.size(), static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1));
-#ifndef _WIN64
-	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
-	num_splits = std::min(num_splits, static_cast<size_t>(4));
-#endif
+	// Start with the effects that took the longest to load last time, so that they do not end up holding up the entire reload at the end
+	// Effects that were not loaded before are started first too, since there is no telling how long they take
+	std::vector<std::pair<size_t, std::chrono::high_resolution_clock::duration>> load_order;
+	load_order.reserve(effect_files.size());
+	for (size_t i = 0; i < effect_files.size(); ++i)
+	{
+		const auto duration_it = _last_effect_load_durations.find(effect_files[i].u8string());
+		load_order.emplace_back(i, duration_it != _last_effect_load_durations.end() ? duration_it->second : std::chrono::high_resolution_clock::duration::max());
+	}
+	std::stable_sort(load_order.begin(), load_order.end(),
+		[](const std::pair<size_t, std::chrono::high_resolution_clock::duration> &lhs, const std::pair<size_t, std::chrono::high_resolution_clock::duration> &rhs) {
+			return lhs.second > rhs.second;
+		});
+
+	// Keep track of the submitted jobs, so the runtime cannot be destroyed while they are still running
+	for (const std::pair<size_t, std::chrono::high_resolution_clock::duration> &load_item : load_order)
+	{
+		const size_t i = load_item.first;
 
-	// Keep track of the spawned threads, so the runtime cannot be destroyed while they are still running
-	for (size_t n = 0; n < num_splits; ++n)
-		_worker_threads.emplace_back([this, effect_files, offset, num_splits, n, &preset, force_load_all]() {
+		_worker_pool.submit([this, source_file = effect_files[i], effect_index = offset + i, &preset, force_load_all]() {
 			// Abort loading when initialization state changes (indicating that 'on_reset' was called in the meantime)
-			for (size_t i = 0; i < effect_files.size() && _is_initialized; ++i)
-				if (i * num_splits / effect_files.size() == n)
-					load_effect(effect_files[i], preset, offset + i, 0, force_load_all || effect_files[i].extension() == L".addonfx");
-		});
+			if (_is_initialized)
+				load_effect(source_file, preset, effect_index, 0, force_load_all || source_file.extension() == L".addonfx");
+		}, &_reload_jobs);
+	}
 }
 bool reshade::runtime::reload_effect(size_t effect_index)
 {
@@ -3458,6 +4097,19 @@ bool reshade::runtime::reload_effect(size_t effect_index)
 	// Make sure no effect resources are currently in use
 	_graphics_queue->wait_idle();
 
+	// Wait for effects compiling in the background and discard the version of this one, so that it does not replace the one loaded below when they are swapped in (see 'update_effects')
+	if (_staged_effects_remaining != std::numeric_limits<size_t>::max())
+	{
+		_worker_pool.wait(_staged_jobs);
+
+		_staged_effects.erase(
+			std::remove_if(_staged_effects.begin(), _staged_effects.end(),
+				[effect_index](const std::pair<size_t, effect> &staged_effect) { return staged_effect.first == effect_index; }),
+			_staged_effects.end());
+		if (_staged_effects.empty())
+			_staged_effects_remaining = std::numeric_limits<size_t>::max();
+	}
+
 	const std::filesystem::path source_file = _effects[effect_index].source_file;
 	destroy_effect(effect_index);
 
@@ -3490,30 +4142,158 @@ void reshade::runtime::reload_effects(bool force_load_all)
 
 	load_effects(force_load_all);
 }
-void reshade::runtime::destroy_effects()
+bool reshade::runtime::reload_effects_in_background(const std::vector<std::filesystem::path> &changed_files)
 {
-	// Make sure no threads are still accessing effect data
-	for (std::thread &thread : _worker_threads)
-		if (thread.joinable())
-			thread.join();
-	_worker_threads.clear();
-
-#if RESHADE_GUI
-	_effect_filter[0] = '\0';
-	_preview_texture = std::numeric_limits<size_t>::max();
-#endif
+	// Cannot start while another background reload is still compiling
+	if (_staged_effects_remaining != std::numeric_limits<size_t>::max())
+		return false;
+
+	std::vector<size_t> effect_indices;
+	for (const std::filesystem::path &changed_file : changed_files)
+	{
+		if (const auto it = _effect_file_dependencies.find(changed_file.u8string());
+			it != _effect_file_dependencies.end())
+			effect_indices.insert(effect_indices.end(), it->second.second.begin(), it->second.second.end());
+	}
+
+	std::sort(effect_indices.begin(), effect_indices.end());
+	effect_indices.erase(std::unique(effect_indices.begin(), effect_indices.end()), effect_indices.end());
+
+	if (effect_indices.empty())
+		return false;
+
+	// Update last write times before compiling, so that the same change is not picked up again, but changes made while compiling are
+	std::error_code ec;
+	for (const std::filesystem::path &changed_file : changed_files)
+		if (const auto it = _effect_file_dependencies.find(changed_file.u8string());
+			it != _effect_file_dependencies.end())
+			it->second.first = std::filesystem::last_write_time(changed_file, ec);
+
+	assert(_staged_effects.empty());
+	for (size_t effect_index : effect_indices)
+		_staged_effects.emplace_back(effect_index, effect());
+
+	_staged_effects_remaining = _staged_effects.size();
+
+	const ini_file &preset = ini_file::load_cache(_current_preset_path);
+
+	for (std::pair<size_t, effect> &staged_effect : _staged_effects)
+	{
+		_worker_pool.submit([this, source_file = _effects[staged_effect.first].source_file, &staged_effect, &preset]() {
+			load_effect(source_file, preset, staged_effect.first, 0, true, true, &staged_effect.second);
+
+			_staged_effects_remaining--;
+		}, &_staged_jobs);
+	}
+
+	return true;
+}
+void reshade::runtime::update_effect_file_dependencies()
+{
+	// Keep the last write times of files that were tracked before, since reading them again could hide changes made while effects were compiling in the background
+	std::unordered_map<std::string, std::pair<std::filesystem::file_time_type, std::vector<size_t>>> previous_effect_file_dependencies = std::move(_effect_file_dependencies);
+	_effect_file_dependencies.clear();
+
+	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+	{
+		const effect &effect = _effects[effect_index];
+		if (effect.skipped)
+			continue;
+
+		_effect_file_dependencies[effect.source_file.u8string()].second.push_back(effect_index);
+		for (const std::filesystem::path &included_file : effect.included_files)
+			_effect_file_dependencies[included_file.u8string()].second.push_back(effect_index);
+	}
+
+	std::error_code ec;
+	for (auto &[file, dependency] : _effect_file_dependencies)
+	{
+		if (const auto it = previous_effect_file_dependencies.find(file);
+			it != previous_effect_file_dependencies.end())
+			dependency.first = it->second.first;
+		else
+			dependency.first = std::filesystem::last_write_time(std::filesystem::u8path(file), ec);
+	}
+}
+void reshade::runtime::check_effect_files_for_changes()
+{
+	// Another background reload cannot be started until the current one was swapped in, so keep any changes queued until then
+	if (_effect_file_check_running || _staged_effects_remaining != std::numeric_limits<size_t>::max())
+		return;
+
+	if (!_changed_effect_files.empty())
+	{
+		std::vector<std::filesystem::path> changed_files;
+		for (const std::pair<std::string, std::filesystem::file_time_type> &changed_file : _changed_effect_files)
+			changed_files.push_back(std::filesystem::u8path(changed_file.first));
+		_changed_effect_files.clear();
+
+		log::message(log::level::info, "Detected changes to %zu effect file(s), reloading dependent effects.", changed_files.size());
+
+		reload_effects_in_background(changed_files);
+		return;
+	}
+
+	if (_effect_file_dependencies.empty() || _last_present_time - _last_effect_file_check_time < std::chrono::seconds(1))
+		return;
+	_last_effect_file_check_time = _last_present_time;
+
+	std::vector<std::pair<std::string, std::filesystem::file_time_type>> files;
+	files.reserve(_effect_file_dependencies.size());
+	for (const auto &[file, dependency] : _effect_file_dependencies)
+		files.emplace_back(file, dependency.first);
+
+	// Query file times on a worker thread, since file system access can be slow and should not stall the present thread
+	_effect_file_check_running = true;
+	_worker_pool.submit([this, files = std::move(files)]() {
+		std::error_code ec;
+		for (const std::pair<std::string, std::filesystem::file_time_type> &file : files)
+		{
+			const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(std::filesystem::u8path(file.first), ec);
+			if (!ec && last_write_time != file.second)
+				_changed_effect_files.emplace_back(file.first, last_write_time);
+		}
+
+		_effect_file_check_running = false;
+	});
+}
+void reshade::runtime::destroy_effects()
+{
+	// Make sure no jobs are still accessing effect data
+	_worker_pool.wait_idle();
+
+#if RESHADE_GUI
+	_effect_filter[0] = '\0';
+	_preview_texture = std::numeric_limits<size_t>::max();
+#endif
 
 	// Reset the effect creation queue
 	_reload_create_queue.clear();
 	_reload_required_effects.clear();
 	_reload_remaining_effects = std::numeric_limits<size_t>::max();
 
+	// Discard any effects that were compiled in the background, since everything is loaded from scratch again anyway
+	_staged_effects.clear();
+	_staged_effects_remaining = std::numeric_limits<size_t>::max();
+	_changed_effect_files.clear();
+	_effect_file_dependencies.clear();
+	_assembled_entry_points.clear();
+
 	// Make sure no effect resources are currently in use (do this even when the effect list is empty, since it is dependent upon by 'on_reset')
 	_graphics_queue->wait_idle();
 
+	for (const std::pair<uint64_t, std::function<void()>> &deferred_destruction : _deferred_effect_object_destructions)
+		deferred_destruction.second();
+	_deferred_effect_object_destructions.clear();
+
 	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
 		destroy_effect(effect_index);
 
+	// Remember how long each effect took to load, so that the next reload can start with the most expensive ones
+	for (const effect &effect : _effects)
+		if (effect.load_duration.count() != 0)
+			_last_effect_load_durations[effect.source_file.u8string()] = effect.load_duration;
+
 	// Reset the effect list after all resources have been destroyed
 	_effects.clear();
 
@@ -3523,7 +4303,7 @@ void reshade::runtime::destroy_effects()
 	_effect_sampler_states.clear();
 
 	// Textures and techniques should have been cleaned up by the calls to 'destroy_effect' above
-	assert(_textures.empty());
+	assert(_textures.empty() && _transient_textures.empty());
 	assert(_techniques.empty() && _technique_sorting.empty());
 }
 
@@ -3566,6 +4346,9 @@ bool reshade::runtime::save_effect_cache(const std::string &id, const std::strin
 }
 void reshade::runtime::clear_effect_cache()
 {
+	_effect_cache_index.clear();
+	reshadefx::file_cache::instance().clear();
+
 	std::error_code ec;
 
 	// Find all cached effect files and delete them
@@ -3576,7 +4359,7 @@ void reshade::runtime::clear_effect_cache()
 
 		const std::filesystem::path filename = entry.path().filename();
 		const std::filesystem::path extension = entry.path().extension();
-		if (filename.wstring().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm"))
+		if (filename.wstring().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".pps" && extension != L".cso" && extension != L".asm" && extension != L".cache"))
 			continue;
 
 		std::filesystem::remove(entry, ec);
@@ -3601,6 +4384,10 @@ auto reshade::runtime::add_effect_permutation(uint32_t width, uint32_t height, a
 		it != _effect_permutations.end())
 		return std::distance(_effect_permutations.begin(), it);
 
+	// Effects compiling in the background access the permutation list, so cannot add to it until they finished
+	if (_staged_effects_remaining != std::numeric_limits<size_t>::max())
+		return std::numeric_limits<size_t>::max();
+
 	effect_permutation permutation;
 	permutation.width = width;
 	permutation.height = height;
@@ -3664,7 +4451,52 @@ void reshade::runtime::update_effects()
 	if (_frame_count == 0 && !_no_reload_on_init)
 		reload_effects();
 
-	if (!is_loading() && !_is_in_preset_transition && !_reload_required_effects.empty())
+	// Replace effects that finished compiling in the background, so that their previous versions stop rendering in the same frame the new ones start
+	bool swap_staged_effects = false;
+	if (!is_loading() && _staged_effects_remaining == 0)
+	{
+		swap_staged_effects = true;
+
+		// Previous versions may still be referenced by frames in flight, so destroy their objects later, rather than waiting for the GPU here
+		_defer_effect_object_destruction = true;
+		for (const std::pair<size_t, effect> &staged_effect : _staged_effects)
+			destroy_effect(staged_effect.first);
+		_defer_effect_object_destruction = false;
+
+#if RESHADE_ADDON
+		// Call event after destroying the effects, so add-ons get a chance to release any handles they hold to variables and techniques
+		invoke_addon_event<addon_event::reshade_reloaded_effects>(this);
+#endif
+
+		// Make sure 'is_loading' is true while merging the effects, which then continues like any other reload below
+		_reload_remaining_effects = _staged_effects.size();
+
+		const ini_file &preset = ini_file::load_cache(_current_preset_path);
+
+		for (std::pair<size_t, effect> &staged_effect : _staged_effects)
+		{
+			const size_t effect_index = staged_effect.first;
+			effect &effect = _effects[effect_index] = std::move(staged_effect.second);
+
+			for (uniform &variable : effect.uniforms)
+				reset_uniform_value(variable);
+
+			// Effect is already compiled, so this only merges its textures and techniques with those of the other effects
+			load_effect(effect.source_file, preset, effect_index, 0, true);
+		}
+
+		_staged_effects.clear();
+		_staged_effects_remaining = std::numeric_limits<size_t>::max();
+	}
+
+	if (_effect_auto_reload && !is_loading())
+		check_effect_files_for_changes();
+
+	if (!is_loading())
+		update_assembled_entry_points();
+
+	// Effects compiling in the background would replace those reloaded here when they are swapped in, so wait for that to happen first
+	if (!is_loading() && !_is_in_preset_transition && !_reload_required_effects.empty() && _staged_effects_remaining == std::numeric_limits<size_t>::max())
 	{
 		_reload_remaining_effects = 0;
 
@@ -3698,9 +4530,9 @@ void reshade::runtime::update_effects()
 
 				_reload_remaining_effects += 1;
 
-				_worker_threads.emplace_back([this, effect_index, permutation_index]() {
+				_worker_pool.submit([this, effect_index, permutation_index]() {
 						load_effect(_effects[effect_index].source_file, ini_file::load_cache(_current_preset_path), effect_index, permutation_index, true);
-					});
+					}, &_reload_jobs);
 			}
 
 			// Force immediate effect initialization of this permutation after reloading
@@ -3714,11 +4546,12 @@ void reshade::runtime::update_effects()
 
 	if (_reload_remaining_effects == 0)
 	{
-		// Clear the thread list now that they all have finished
-		for (std::thread &thread : _worker_threads)
-			if (thread.joinable())
-				thread.join(); // Threads have exited, but still need to join them prior to destruction
-		_worker_threads.clear();
+		// All effects have been loaded, but the jobs may still be about to return, so wait for them to finish completely (this does not wait on any screenshot jobs)
+		_worker_pool.wait(_reload_jobs);
+
+		// Persist dependency information of all effects that were pre-processed
+		if (!_no_effect_cache && _effect_cache_index.is_modified())
+			_effect_cache_index.save(g_reshade_base_path / _effect_cache_path / L"reshade-effects.cache");
 
 		// Finished loading effects, so apply preset to figure out which ones need compiling
 		load_current_preset();
@@ -3730,6 +4563,16 @@ void reshade::runtime::update_effects()
 		_last_reload_time = std::chrono::high_resolution_clock::now();
 		_reload_remaining_effects = std::numeric_limits<size_t>::max();
 
+		update_effect_file_dependencies();
+
+		// Assemble entry points of techniques that are bound to a shortcut key ahead of time, so that toggling them does not have to wait for it
+		if (_technique_prewarming)
+		{
+			for (technique &tech : _techniques)
+				if (tech.toggle_key_data[0] != 0 && !tech.enabled && _effects[tech.effect_index].compiled)
+					compile_technique(tech, 0);
+		}
+
 #if RESHADE_GUI
 		// Update all code editors after a reload
 		for (editor_instance &instance : _editors)
@@ -3751,49 +4594,54 @@ void reshade::runtime::update_effects()
 			}
 		}
 #endif
-		return;
+		if (!swap_staged_effects)
+			return;
 	}
 
 	if (_reload_remaining_effects != std::numeric_limits<size_t>::max() || _reload_create_queue.empty())
 		return;
 
-	// Pop an effect from the queue
-	const auto [effect_index, permutation_index] = _reload_create_queue.back();
-	_reload_create_queue.pop_back();
-	effect &effect = _effects[effect_index];
-
-	if (!create_effect(effect_index, permutation_index))
+	// Create one effect per frame to spread the cost, except when effects were swapped in above, since those replace versions that were rendering until now
+	do
 	{
-		_graphics_queue->wait_idle();
-
-		// Destroy all textures belonging to this effect
-		for (texture &tex : _textures)
-			if (tex.shared.size() == 1 && tex.shared[0] == effect_index)
-				destroy_texture(tex);
-		// Disable all techniques belonging to this effect
-		for (technique &tech : _techniques)
-			if (tech.effect_index == effect_index)
-				disable_technique(tech);
+		// Pop an effect from the queue
+		const auto [effect_index, permutation_index] = _reload_create_queue.back();
+		_reload_create_queue.pop_back();
+		effect &effect = _effects[effect_index];
 
-		effect.compiled = false;
-		_last_reload_successful = false;
-	}
+		if (!create_effect(effect_index, permutation_index))
+		{
+			_graphics_queue->wait_idle();
+
+			// Destroy all textures belonging to this effect
+			for (texture &tex : _textures)
+				if (tex.shared.size() == 1 && tex.shared[0] == effect_index)
+					destroy_texture(tex);
+			// Disable all techniques belonging to this effect
+			for (technique &tech : _techniques)
+				if (tech.effect_index == effect_index)
+					disable_technique(tech);
+
+			effect.compiled = false;
+			_last_reload_successful = false;
+		}
 
 #if RESHADE_GUI
-	// Update assembly in all code editors after a reload
-	for (editor_instance &instance : _editors)
-	{
-		if (!instance.generated || instance.entry_point_name.empty() || instance.permutation_index != permutation_index || instance.file_path != effect.source_file)
-			continue;
+		// Update assembly in all code editors after a reload
+		for (editor_instance &instance : _editors)
+		{
+			if (!instance.generated || instance.entry_point_name.empty() || instance.permutation_index != permutation_index || instance.file_path != effect.source_file)
+				continue;
 
-		assert(instance.effect_index == effect_index);
+			assert(instance.effect_index == effect_index);
 
-		const effect::permutation &permutation = effect.permutations[permutation_index];
+			const effect::permutation &permutation = effect.permutations[permutation_index];
 
-		if (permutation.assembly.find(instance.entry_point_name) != permutation.assembly.end())
-			open_code_editor(instance);
-	}
+			if (permutation.assembly.find(instance.entry_point_name) != permutation.assembly.end())
+				open_code_editor(instance);
+		}
 #endif
+	} while (swap_staged_effects && !_reload_create_queue.empty());
 
 #if RESHADE_ADDON
 	if (_reload_create_queue.empty())
@@ -3828,163 +4676,7 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		if (!effect.rendering || (!_effects_enabled && !effect.addon))
 			continue;
 
-		for (uniform &variable : effect.uniforms)
-		{
-			switch (variable.special)
-			{
-			case special_uniform::frame_time:
-				set_uniform_value(variable, _last_frame_duration.count() * 1e-6f);
-				break;
-			case special_uniform::frame_count:
-				if (variable.type.is_boolean())
-					set_uniform_value(variable, (_frame_count % 2) == 0);
-				else
-					set_uniform_value(variable, static_cast<unsigned int>(_frame_count % UINT_MAX));
-				break;
-			case special_uniform::random:
-				{
-					const int min = variable.annotation_as_int("min", 0, 0);
-					const int max = variable.annotation_as_int("max", 0, RAND_MAX);
-					set_uniform_value(variable, min + (std::rand() % (std::abs(max - min) + 1)));
-				}
-				break;
-			case special_uniform::ping_pong:
-				{
-					const float min = variable.annotation_as_float("min", 0, 0.0f);
-					const float max = variable.annotation_as_float("max", 0, 1.0f);
-					const float step_min = variable.annotation_as_float("step", 0);
-					const float step_max = variable.annotation_as_float("step", 1);
-					float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
-					const float smoothing = variable.annotation_as_float("smoothing");
-
-					float value[2] = { 0, 0 };
-					get_uniform_value(variable, value, 2);
-					if (value[1] >= 0)
-					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
-
-						if ((value[0] += increment) >= max)
-							value[0] = max, value[1] = -1;
-					}
-					else
-					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
-
-						if ((value[0] -= increment) <= min)
-							value[0] = min, value[1] = +1;
-					}
-					set_uniform_value(variable, value, 2);
-				}
-				break;
-			case special_uniform::date:
-				{
-					const std::time_t t = std::chrono::system_clock::to_time_t(_current_time);
-					struct tm tm; localtime_s(&tm, &t);
-
-					const int value[4] = {
-						tm.tm_year + 1900,
-						tm.tm_mon + 1,
-						tm.tm_mday,
-						tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec
-					};
-					set_uniform_value(variable, value, 4);
-				}
-				break;
-			case special_uniform::timer:
-				{
-					const unsigned long long timer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count();
-					set_uniform_value(variable, static_cast<unsigned int>(timer_ms));
-				}
-				break;
-			case special_uniform::key:
-				if (_input != nullptr)
-				{
-					const int keycode = variable.annotation_as_int("keycode");
-					if (keycode <= 7 || keycode >= 256)
-						break;
-
-					const std::string_view mode = variable.annotation_as_string("mode");
-					if (mode == "toggle" || variable.annotation_as_int("toggle"))
-					{
-						bool current_value = false;
-						get_uniform_value(variable, &current_value);
-						if (_input->is_key_pressed(keycode))
-							set_uniform_value(variable, !current_value);
-					}
-					else if (mode == "press")
-						set_uniform_value(variable, _input->is_key_pressed(keycode));
-					else
-						set_uniform_value(variable, _input->is_key_down(keycode));
-				}
-				break;
-			case special_uniform::mouse_point:
-				if (_input != nullptr)
-					set_uniform_value(variable, _input->mouse_position_x(), _input->mouse_position_y());
-				break;
-			case special_uniform::mouse_delta:
-				if (_input != nullptr)
-					set_uniform_value(variable, _input->mouse_movement_delta_x(), _input->mouse_movement_delta_y());
-				break;
-			case special_uniform::mouse_button:
-				if (_input != nullptr)
-				{
-					const int keycode = variable.annotation_as_int("keycode");
-					if (keycode < 0 || keycode >= 5)
-						break;
-
-					const std::string_view mode = variable.annotation_as_string("mode");
-					if (mode == "toggle" || variable.annotation_as_int("toggle"))
-					{
-						bool current_value = false;
-						get_uniform_value(variable, &current_value);
-						if (_input->is_mouse_button_pressed(keycode))
-							set_uniform_value(variable, !current_value);
-					}
-					else if (mode == "press")
-						set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
-					else
-						set_uniform_value(variable, _input->is_mouse_button_down(keycode));
-				}
-				break;
-			case special_uniform::mouse_wheel:
-				if (_input != nullptr)
-				{
-					const float min = variable.annotation_as_float("min");
-					const float max = variable.annotation_as_float("max");
-					float step = variable.annotation_as_float("step");
-					if (step == 0.0f)
-						step = 1.0f;
-
-					float value[2] = { 0, 0 };
-					get_uniform_value(variable, value, 2);
-					value[1] = _input->mouse_wheel_delta();
-					value[0] = value[0] + value[1] * step;
-					if (min != max)
-					{
-						value[0] = std::max(value[0], min);
-						value[0] = std::min(value[0], max);
-					}
-					set_uniform_value(variable, value, 2);
-				}
-				break;
-#if RESHADE_GUI
-			case special_uniform::overlay_open:
-				set_uniform_value(variable, _show_overlay);
-				break;
-			case special_uniform::overlay_active:
-			case special_uniform::overlay_hovered:
-				// These are set in 'draw_variable_editor' when overlay is open
-				if (!_show_overlay)
-					set_uniform_value(variable, 0);
-				break;
-#endif
-			case special_uniform::screenshot:
-				set_uniform_value(variable, _should_save_screenshot);
-				break;
-			}
-		}
+		update_special_uniforms(effect);
 	}
 
 	if (rtv == 0)
@@ -4025,6 +4717,9 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 	cmd_list->begin_debug_event("ReShade effects");
 #endif
 
+	// The application rendered a new image to the back buffer since effects were last rendered
+	_effect_permutations[permutation_index].color_tex_outdated = true;
+
 	// Render all enabled techniques
 	for (size_t technique_index : _technique_sorting)
 	{
@@ -4036,13 +4731,21 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 			continue;
 
 		if (permutation_index >= tech.permutations.size() ||
-			(!tech.permutations[permutation_index].created && _effects[effect_index].permutations[permutation_index].cso.empty()))
+			(!tech.permutations[permutation_index].created && _effects[effect_index].permutations[permutation_index].cso.empty() && _effects[effect_index].permutations[permutation_index].codegen == nullptr))
 		{
 			if (std::find(_reload_required_effects.begin(), _reload_required_effects.end(), std::make_pair(effect_index, permutation_index)) == _reload_required_effects.end())
 				_reload_required_effects.emplace_back(effect_index, permutation_index);
 			continue;
 		}
 
+		// Technique is rendered once its entry points finished assembling in the background after it was first enabled
+		if (!tech.permutations[permutation_index].pipelines_created)
+		{
+			if (tech.permutations[permutation_index].created && !compile_technique(tech, permutation_index))
+				disable_technique(tech);
+			continue;
+		}
+
 		render_technique(tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
 
 		if (tech.time_left > 0)
@@ -4053,6 +4756,8 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		}
 	}
 
+	restore_effect_resource_states(cmd_list);
+
 #ifndef NDEBUG
 	cmd_list->end_debug_event();
 #endif
@@ -4064,9 +4769,63 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		api::apply_state(cmd_list, _app_state);
 #endif
 }
+void reshade::runtime::queue_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states)
+{
+	_pending_barrier_resources.insert(_pending_barrier_resources.end(), resources, resources + count);
+	_pending_barrier_old_states.insert(_pending_barrier_old_states.end(), old_states, old_states + count);
+	_pending_barrier_new_states.insert(_pending_barrier_new_states.end(), new_states, new_states + count);
+}
+void reshade::runtime::flush_barriers(api::command_list *cmd_list)
+{
+	if (_pending_barrier_resources.empty())
+		return;
+
+	cmd_list->barrier(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_old_states.data(), _pending_barrier_new_states.data());
+
+	_pending_barrier_resources.clear();
+	_pending_barrier_old_states.clear();
+	_pending_barrier_new_states.clear();
+}
+void reshade::runtime::transition_effect_resource(api::resource resource, api::resource_usage new_state)
+{
+	// Effect resources are in shader resource state unless they are tracked here
+	const auto it = std::find_if(_effect_resource_states.begin(), _effect_resource_states.end(),
+		[resource](const std::pair<api::resource, api::resource_usage> &entry) { return entry.first == resource; });
+	const api::resource_usage old_state = it != _effect_resource_states.end() ? it->second : api::resource_usage::shader_resource;
+
+	if (old_state == new_state)
+	{
+		// Consecutive writes still need to be ordered, which is implicit for render targets in all APIs except Vulkan
+		if (new_state == api::resource_usage::unordered_access || (new_state == api::resource_usage::render_target && _device->get_api() == api::device_api::vulkan))
+			queue_barriers(1, &resource, &old_state, &new_state);
+		return;
+	}
+
+	queue_barriers(1, &resource, &old_state, &new_state);
+
+	if (new_state == api::resource_usage::shader_resource)
+		_effect_resource_states.erase(it);
+	else if (it != _effect_resource_states.end())
+		it->second = new_state;
+	else
+		_effect_resource_states.emplace_back(resource, new_state);
+}
+void reshade::runtime::restore_effect_resource_states(api::command_list *cmd_list)
+{
+	for (const std::pair<api::resource, api::resource_usage> &entry : _effect_resource_states)
+	{
+		const api::resource_usage new_state = api::resource_usage::shader_resource;
+		queue_barriers(1, &entry.first, &entry.second, &new_state);
+	}
+
+	_effect_resource_states.clear();
+
+	flush_barriers(cmd_list);
+}
+
 void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index)
 {
-	const effect &effect = _effects[tech.effect_index];
+	effect &effect = _effects[tech.effect_index];
 	const effect::permutation &permutation = effect.permutations[permutation_index];
 
 #ifndef NDEBUG
@@ -4102,38 +4861,67 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	const std::chrono::high_resolution_clock::time_point time_technique_started = std::chrono::high_resolution_clock::now();
 #endif
 
-	// Update shader constants
-	if (void *mapped_uniform_data;
-		effect.cb != 0 && _device->map_buffer_region(effect.cb, 0, effect.uniform_data_storage.size(), api::map_access::write_discard, &mapped_uniform_data))
+	// Update shader constants (only when they changed, since the constant buffer keeps its contents across techniques and frames)
+	if (effect.cb != 0 && effect.uniform_data_dirty)
 	{
-		std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
-		_device->unmap_buffer_region(effect.cb);
+		if (effect.cb_mapped != nullptr)
+		{
+			// Move on to the next copy in the constant buffer, unless that may still be in use by a frame that is in flight, which can only happen when constants changed several times this frame
+			if (const uint32_t next_index = (effect.cb_index + 1) % effect::num_cb_copies;
+				effect.cb_reuse_frame[next_index] <= _frame_count)
+				effect.cb_index = next_index;
+
+			std::memcpy(effect.cb_mapped + static_cast<size_t>(effect.cb_index) * effect.cb_stride, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
+			effect.cb_reuse_frame[effect.cb_index] = _frame_count + effect::num_cb_copies;
+
+			effect.uniform_data_dirty = false;
+		}
+		else if (void *mapped_uniform_data;
+			_device->map_buffer_region(effect.cb, 0, effect.uniform_data_storage.size(), api::map_access::write_discard, &mapped_uniform_data))
+		{
+			std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
+			_device->unmap_buffer_region(effect.cb);
+
+			effect.uniform_data_dirty = false;
+		}
+
+		if (!effect.uniform_data_dirty)
+			_uniform_upload_size += effect.uniform_data_storage.size();
 	}
 	else if (_device->get_api() == api::device_api::d3d9)
 	{
+		// Constants are part of the device state in D3D9, which other effects overwrite, so have to set them again for every technique
 		cmd_list->push_constants(api::shader_stage::all, permutation.layout, 0, 0, static_cast<uint32_t>(effect.uniform_data_storage.size() / 4), effect.uniform_data_storage.data());
+
+		_uniform_upload_size += effect.uniform_data_storage.size();
 	}
 
 	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
 
 	bool is_effect_stencil_cleared = false;
-	bool needs_implicit_back_buffer_copy = true; // First pass always needs the back buffer updated
+	uint32_t num_back_buffer_copies = 0;
+	effect_permutation &effect_permutation = _effect_permutations[permutation_index];
 
 	for (size_t pass_index = 0; pass_index < tech.permutations[permutation_index].passes.size(); ++pass_index)
 	{
-		if (needs_implicit_back_buffer_copy)
+		const technique::pass &pass = tech.permutations[permutation_index].passes[pass_index];
+
+		// Only need to update the copy of the back buffer if this pass samples it and it was rendered to since the last copy (which may have happened in a previous technique)
+		if (pass.samples_back_buffer && effect_permutation.color_tex_outdated)
 		{
-			// Save back buffer of previous pass
-			const api::resource resources[2] = { back_buffer_resource, _effect_permutations[permutation_index].color_tex};
+			const api::resource resources[2] = { back_buffer_resource, effect_permutation.color_tex };
 			const api::resource_usage state_old[2] = { api::resource_usage::render_target, api::resource_usage::shader_resource };
 			const api::resource_usage state_new[2] = { api::resource_usage::copy_source, api::resource_usage::copy_dest };
 
-			cmd_list->barrier(2, resources, state_old, state_new);
-			cmd_list->copy_texture_region(back_buffer_resource, 0, nullptr, _effect_permutations[permutation_index].color_tex, 0, nullptr);
-			cmd_list->barrier(2, resources, state_new, state_old);
-		}
+			queue_barriers(2, resources, state_old, state_new);
+			flush_barriers(cmd_list);
+			cmd_list->copy_texture_region(back_buffer_resource, 0, nullptr, effect_permutation.color_tex, 0, nullptr);
+			// Transition back together with the resources of the pass below
+			queue_barriers(2, resources, state_new, state_old);
 
-		const technique::pass &pass = tech.permutations[permutation_index].passes[pass_index];
+			effect_permutation.color_tex_outdated = false;
+			num_back_buffer_copies++;
+		}
 
 #ifndef NDEBUG
 		cmd_list->begin_debug_event((pass.name.empty() ? "Pass " + std::to_string(pass_index) : pass.name).c_str());
@@ -4144,23 +4932,20 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			cmd_list->end_query(effect.query_heap, api::query_type::timestamp, query_base_index + static_cast<uint32_t>((1 + pass_index) * 2));
 #endif
 
-		const uint32_t num_barriers = static_cast<uint32_t>(pass.modified_resources.size());
+		// Resources stay in the state the last pass using them needed, so only have to transition those this pass uses differently, all in a single batch
+		for (const api::resource resource : pass.sampled_resources)
+			transition_effect_resource(resource, api::resource_usage::shader_resource);
+		for (const api::resource resource : pass.modified_resources)
+			transition_effect_resource(resource, pass.cs_entry_point.empty() ? api::resource_usage::render_target : api::resource_usage::unordered_access);
+		flush_barriers(cmd_list);
 
 		if (!pass.cs_entry_point.empty())
 		{
-			// Compute shaders do not write to the back buffer, so no update necessary
-			needs_implicit_back_buffer_copy = false;
-
 			cmd_list->bind_pipeline(api::pipeline_stage::all_compute, pass.pipeline);
 
-			temp_mem<api::resource_usage> state_old, state_new;
-			std::fill_n(state_old.p, num_barriers, api::resource_usage::shader_resource);
-			std::fill_n(state_new.p, num_barriers, api::resource_usage::unordered_access);
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_old.p, state_new.p);
-
 			// Reset bindings on every pass (since they get invalidated by the call to 'generate_mipmaps' below)
 			if (effect.cb != 0)
-				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, 0, permutation.cb_table);
+				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, 0, permutation.cb_tables[effect.cb_index]);
 			if (permutation.sampler_table != 0)
 				assert(!sampler_with_resource_view),
 				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, 1, permutation.sampler_table);
@@ -4170,19 +4955,11 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, sampler_with_resource_view ? 2 : 3, pass.storage_table);
 
 			cmd_list->dispatch(pass.viewport_width, pass.viewport_height, pass.viewport_dispatch_z);
-
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_new.p, state_old.p);
 		}
 		else
 		{
 			cmd_list->bind_pipeline(api::pipeline_stage::all_graphics, pass.pipeline);
 
-			// Transition resource state for render targets
-			temp_mem<api::resource_usage> state_old, state_new;
-			std::fill_n(state_old.p, num_barriers, api::resource_usage::shader_resource);
-			std::fill_n(state_new.p, num_barriers, api::resource_usage::render_target);
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_old.p, state_new.p);
-
 			// Setup render targets
 			uint32_t render_target_count = 0;
 			api::render_pass_depth_stencil_desc depth_stencil = {};
@@ -4190,15 +4967,13 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 			if (pass.render_target_names[0].empty())
 			{
-				needs_implicit_back_buffer_copy = true;
+				effect_permutation.color_tex_outdated = true;
 
 				render_target[0].view = pass.srgb_write_enable ? back_buffer_rtv_srgb : back_buffer_rtv;
 				render_target_count = 1;
 			}
 			else
 			{
-				needs_implicit_back_buffer_copy = false;
-
 				for (int i = 0; i < 8 && pass.render_target_views[i] != 0; ++i, ++render_target_count)
 					render_target[i].view = pass.render_target_views[i];
 			}
@@ -4224,7 +4999,7 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 			// Reset bindings on every pass (since they get invalidated by the call to 'generate_mipmaps' below)
 			if (effect.cb != 0)
-				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, 0, permutation.cb_table);
+				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, 0, permutation.cb_tables[effect.cb_index]);
 			if (permutation.sampler_table != 0)
 				assert(!sampler_with_resource_view),
 				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, 1, permutation.sampler_table);
@@ -4289,9 +5064,6 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			cmd_list->draw(pass.num_vertices, 1, 0, 0);
 
 			cmd_list->end_render_pass();
-
-			// Transition resource state back to shader access
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_new.p, state_old.p);
 		}
 
 #if RESHADE_GUI
@@ -4303,11 +5075,21 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 		cmd_list->end_debug_event();
 #endif
 
-		// Generate mipmaps for modified resources
-		for (const api::resource_view modified_texture : pass.generate_mipmap_views)
-			cmd_list->generate_mipmaps(modified_texture);
+		// Generate mipmaps for modified resources (which expects them to be in shader resource state)
+		if (!pass.generate_mipmap_views.empty())
+		{
+			for (const api::resource resource : pass.modified_resources)
+				transition_effect_resource(resource, api::resource_usage::shader_resource);
+			flush_barriers(cmd_list);
+
+			for (const api::resource_view modified_texture : pass.generate_mipmap_views)
+				cmd_list->generate_mipmaps(modified_texture);
+		}
 	}
 
+	_back_buffer_copies += num_back_buffer_copies;
+	_back_buffer_copies_saved += tech.permutations[permutation_index].max_back_buffer_copies - num_back_buffer_copies;
+
 #if RESHADE_GUI
 	const std::chrono::high_resolution_clock::time_point time_technique_finished = std::chrono::high_resolution_clock::now();
 
@@ -4322,10 +5104,27 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 #endif
 
 #if RESHADE_ADDON
+	// Add-ons expect effect resources to be in their default state
+	if (has_addon_event<addon_event::reshade_render_technique>())
+		restore_effect_resource_states(cmd_list);
+
 	invoke_addon_event<addon_event::reshade_render_technique>(const_cast<runtime *>(this), api::effect_technique { reinterpret_cast<uintptr_t>(&tech) }, cmd_list, back_buffer_rtv, back_buffer_rtv_srgb);
+
+	// Add-ons may render to the back buffer in the event above
+	if (has_addon_event<addon_event::reshade_render_technique>())
+		effect_permutation.color_tex_outdated = true;
 #endif
 }
 
+// Distributes the work of the JPEG XL encoder over the worker threads of the runtime, instead of creating new threads for every call
+static void jxl_parallel_runner(void *runner_opaque, void *opaque, void fun(void *, size_t), size_t count)
+{
+	static_cast<reshade::thread_pool *>(runner_opaque)->parallel_for(count, [opaque, fun](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			fun(opaque, i);
+	});
+}
+
 void reshade::runtime::save_texture(const texture &tex)
 {
 	if (tex.type == reshadefx::texture_type::texture_3d)
@@ -4357,99 +5156,79 @@ void reshade::runtime::save_texture(const texture &tex)
 
 	_last_screenshot_save_successful = true;
 
-	if (std::vector<uint8_t> pixels(static_cast<size_t>(tex.width) * static_cast<size_t>(tex.height) * 4);
-		get_texture_data(tex.resource, api::resource_usage::shader_resource, pixels.data(), api::format::r8g8b8a8_unorm))
-	{
-		_worker_threads.emplace_back([this, screenshot_path, pixels = std::move(pixels), width = tex.width, height = tex.height]() mutable {
-			// Default to a save failure unless it is reported to succeed below
-			bool save_success = false;
+	// Copy is only read back a few frames later, at which point the data is converted and written to disk on a worker thread
+	queue_texture_readback(tex.resource, api::resource_usage::shader_resource, api::format::r8g8b8a8_unorm, [this, screenshot_path, width = tex.width, height = tex.height](std::vector<uint8_t> &pixels) {
+		// Default to a save failure unless it is reported to succeed below
+		bool save_success = false;
 
-			if (FILE *const file = _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
-			{
-				const auto write_callback = [](void *context, void *data, int size) {
-					fwrite(data, 1, size, static_cast<FILE *>(context));
-				};
+		if (FILE *const file = _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
+		{
+			const auto write_callback = [](void *context, void *data, int size) {
+				fwrite(data, 1, size, static_cast<FILE *>(context));
+			};
 
-				switch (_screenshot_format)
-				{
-				case 0:
-					save_success = stbi_write_bmp_to_func(write_callback, file, width, height, 4, pixels.data()) != 0;
-					break;
-				case 1:
+			switch (_screenshot_format)
+			{
+			case 0:
+				save_success = stbi_write_bmp_to_func(write_callback, file, width, height, 4, pixels.data()) != 0;
+				break;
+			case 1:
 #if 1
-					if (std::vector<uint8_t> encoded_data;
-						fpng::fpng_encode_image_to_memory(pixels.data(), width, height, 4, encoded_data))
-						save_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size();
+				if (std::vector<uint8_t> encoded_data;
+					fpng::fpng_encode_image_to_memory(pixels.data(), width, height, 4, encoded_data))
+					save_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size();
 #else
-					save_success = stbi_write_png_to_func(write_callback, file, width, height, 4, pixels.data(), 0) != 0;
+				save_success = stbi_write_png_to_func(write_callback, file, width, height, 4, pixels.data(), 0) != 0;
 #endif
-					break;
-				case 2:
-					save_success = stbi_write_jpg_to_func(write_callback, file, width, height, 4, pixels.data(), _screenshot_jpeg_quality) != 0;
-					break;
-				case 3:
-					JxlColorEncoding color_encoding;
-					color_encoding.color_space = JXL_COLOR_SPACE_RGB;
-					color_encoding.white_point = JXL_WHITE_POINT_D65;
-					color_encoding.primaries = JXL_PRIMARIES_SRGB;
-					color_encoding.transfer_function = JXL_TRANSFER_FUNCTION_SRGB;
-					color_encoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
-					color_encoding.is_float = false;
+				break;
+			case 2:
+				save_success = stbi_write_jpg_to_func(write_callback, file, width, height, 4, pixels.data(), _screenshot_jpeg_quality) != 0;
+				break;
+			case 3:
+				JxlColorEncoding color_encoding;
+				color_encoding.color_space = JXL_COLOR_SPACE_RGB;
+				color_encoding.white_point = JXL_WHITE_POINT_D65;
+				color_encoding.primaries = JXL_PRIMARIES_SRGB;
+				color_encoding.transfer_function = JXL_TRANSFER_FUNCTION_SRGB;
+				color_encoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
+				color_encoding.is_float = false;
+
+				uint8_t *encoded_data = nullptr;
+				const size_t encoded_size = JxlSimpleLosslessEncode(
+					pixels.data(),
+					width,
+					static_cast<size_t>(width) * 4,
+					height,
+					4,
+					/* bitdepth = */ 8,
+					/* big_endian = */ false,
+					/* effort = */ 2,
+					&encoded_data,
+					&_worker_pool,
+					jxl_parallel_runner,
+					color_encoding);
+
+				if (encoded_data && encoded_size > 0)
+				{
+					save_success = fwrite(encoded_data, 1, encoded_size, file) == encoded_size;
+					free(encoded_data);
+				}
+				break;
+			}
 
-					uint8_t *encoded_data = nullptr;
-					const size_t encoded_size = JxlSimpleLosslessEncode(
-						pixels.data(),
-						width,
-						static_cast<size_t>(width) * 4,
-						height,
-						4,
-						/* bitdepth = */ 8,
-						/* big_endian = */ false,
-						/* effort = */ 2,
-						&encoded_data,
-						nullptr,
-						[](void *, void *opaque, void fun(void *, size_t), size_t count) {
-							const size_t num_splits = std::min(count, static_cast<size_t>(std::thread::hardware_concurrency()));
-							if (num_splits == 1)
-							{
-								for (size_t i = 0; i < count; ++i)
-									fun(opaque, i);
-								return;
-							}
-							std::vector<std::thread> worker_threads;
-							for (size_t n = 0; n < num_splits; ++n)
-								worker_threads.emplace_back([count, opaque, fun, num_splits, n]() {
-									for (size_t i = 0; i < count; ++i)
-										if (i * num_splits / count == n)
-											fun(opaque, i);
-								});
-							for (std::thread &thread : worker_threads)
-								thread.join();
-						},
-						color_encoding);
+			if (ferror(file))
+				save_success = false;
 
-					if (encoded_data && encoded_size > 0)
-					{
-						save_success = fwrite(encoded_data, 1, encoded_size, file) == encoded_size;
-						free(encoded_data);
-					}
-					break;
-				}
-
-				if (ferror(file))
-					save_success = false;
-
-				fclose(file);
-			}
+			fclose(file);
+		}
 
-			if (_last_screenshot_save_successful)
-			{
-				_last_screenshot_time = std::chrono::high_resolution_clock::now();
-				_last_screenshot_file = screenshot_path;
-				_last_screenshot_save_successful = save_success;
-			}
-		});
-	}
+		if (_last_screenshot_save_successful)
+		{
+			_last_screenshot_time = std::chrono::high_resolution_clock::now();
+			_last_screenshot_file = screenshot_path;
+			_last_screenshot_save_successful = save_success;
+		}
+	});
 }
 void reshade::runtime::update_texture(texture &tex, uint32_t width, uint32_t height, uint32_t depth, const void *pixels)
 {
@@ -4546,6 +5325,7 @@ void reshade::runtime::reset_uniform_value(uniform &variable)
 	if (variable.special != reshade::special_uniform::none)
 	{
 		std::memset(_effects[variable.effect_index].uniform_data_storage.data() + variable.offset, 0, variable.size);
+		_effects[variable.effect_index].uniform_data_dirty = true;
 		return;
 	}
 
@@ -4581,6 +5361,285 @@ static bool force_floating_point_value(const reshadefx::type &type, uint32_t ren
 	return false;
 }
 
+static inline uint32_t encode_special_uniform_value(const reshade::special_uniform_update &update, float value)
+{
+	uint32_t data;
+	if (update.as_float)
+		std::memcpy(&data, &value, sizeof(data));
+	else
+		data = static_cast<uint32_t>(static_cast<int32_t>(value));
+	return data;
+}
+static inline uint32_t encode_special_uniform_value(const reshade::special_uniform_update &update, int32_t value)
+{
+	return update.as_float ? encode_special_uniform_value(update, static_cast<float>(value)) : static_cast<uint32_t>(value);
+}
+static inline uint32_t encode_special_uniform_value(const reshade::special_uniform_update &update, uint32_t value)
+{
+	return update.as_float ? encode_special_uniform_value(update, static_cast<float>(value)) : value;
+}
+static inline uint32_t encode_special_uniform_value(const reshade::special_uniform_update &update, bool value)
+{
+	return update.as_float ? encode_special_uniform_value(update, value ? 1.0f : 0.0f) : (value ? 1u : 0u);
+}
+static inline float decode_special_uniform_value(const reshade::special_uniform_update &update, uint32_t data)
+{
+	float value;
+	if (update.as_float)
+		std::memcpy(&value, &data, sizeof(value));
+	else if (update.is_signed)
+		value = static_cast<float>(static_cast<int32_t>(data));
+	else
+		value = static_cast<float>(data);
+	return value;
+}
+
+void reshade::runtime::compile_special_uniform_updates(effect &effect) const
+{
+	effect.special_uniform_updates.clear();
+
+	for (size_t uniform_index = 0; uniform_index < effect.uniforms.size(); ++uniform_index)
+	{
+		const uniform &variable = effect.uniforms[uniform_index];
+
+		special_uniform_update update = {};
+		update.special = variable.special;
+		update.as_float = variable.type.is_floating_point() || force_floating_point_value(variable.type, _renderer_id);
+		update.is_signed = variable.type.is_signed();
+		update.is_boolean = variable.type.is_boolean();
+		update.direct = !variable.type.is_array() && !variable.type.is_matrix();
+		update.uniform_index = static_cast<uint32_t>(uniform_index);
+		update.offset = variable.offset;
+		update.size = variable.size;
+
+		switch (variable.special)
+		{
+		case special_uniform::frame_time:
+		case special_uniform::frame_count:
+		case special_uniform::date:
+		case special_uniform::timer:
+		case special_uniform::mouse_point:
+		case special_uniform::mouse_delta:
+#if RESHADE_GUI
+		case special_uniform::overlay_open:
+		case special_uniform::overlay_active:
+		case special_uniform::overlay_hovered:
+#endif
+		case special_uniform::screenshot:
+			break;
+		case special_uniform::random:
+			update.random.min = variable.annotation_as_int("min", 0, 0);
+			update.random.max = variable.annotation_as_int("max", 0, RAND_MAX);
+			break;
+		case special_uniform::ping_pong:
+			update.ping_pong.min = variable.annotation_as_float("min", 0, 0.0f);
+			update.ping_pong.max = variable.annotation_as_float("max", 0, 1.0f);
+			update.ping_pong.step_min = variable.annotation_as_float("step", 0);
+			update.ping_pong.step_max = variable.annotation_as_float("step", 1);
+			update.ping_pong.smoothing = variable.annotation_as_float("smoothing");
+			break;
+		case special_uniform::key:
+		case special_uniform::mouse_button:
+			{
+				const int keycode = variable.annotation_as_int("keycode");
+				// Variables with an invalid key code are never updated
+				if (variable.special == special_uniform::key ? (keycode <= 7 || keycode >= 256) : (keycode < 0 || keycode >= 5))
+					continue;
+				update.input.keycode = static_cast<unsigned int>(keycode);
+
+				const std::string_view mode = variable.annotation_as_string("mode");
+				if (mode == "toggle" || variable.annotation_as_int("toggle"))
+					update.mode = special_uniform_update::input_mode::toggle;
+				else if (mode == "press")
+					update.mode = special_uniform_update::input_mode::press;
+				else
+					update.mode = special_uniform_update::input_mode::down;
+			}
+			break;
+		case special_uniform::mouse_wheel:
+			update.mouse_wheel.min = variable.annotation_as_float("min");
+			update.mouse_wheel.max = variable.annotation_as_float("max");
+			update.mouse_wheel.step = variable.annotation_as_float("step");
+			if (update.mouse_wheel.step == 0.0f)
+				update.mouse_wheel.step = 1.0f;
+			break;
+		default:
+			continue;
+		}
+
+		effect.special_uniform_updates.push_back(update);
+	}
+}
+
+void reshade::runtime::update_special_uniforms(effect &effect)
+{
+#if RESHADE_ADDON
+	// Add-ons may intercept changes to uniform variables, so need to go through the regular setter that notifies them if any are listening
+	const bool notify_addons = has_addon_event<addon_event::reshade_set_uniform_value>();
+#else
+	constexpr bool notify_addons = false;
+#endif
+
+	const auto read_values = [this, &effect](const special_uniform_update &update, uint32_t *data, size_t count) {
+		if (update.direct)
+			std::memcpy(data, effect.uniform_data_storage.data() + update.offset, std::min(count * 4, static_cast<size_t>(update.size)));
+		else
+			get_uniform_value_data(effect.uniforms[update.uniform_index], reinterpret_cast<uint8_t *>(data), count * 4, 0);
+	};
+
+	for (const special_uniform_update &update : effect.special_uniform_updates)
+	{
+		// Encoded values to write, with unused components set to zero
+		uint32_t data[4] = {};
+		size_t count = 4;
+
+		switch (update.special)
+		{
+		case special_uniform::frame_time:
+			data[0] = encode_special_uniform_value(update, _last_frame_duration.count() * 1e-6f);
+			break;
+		case special_uniform::frame_count:
+			if (update.is_boolean)
+				data[0] = encode_special_uniform_value(update, (_frame_count % 2) == 0);
+			else
+				data[0] = encode_special_uniform_value(update, static_cast<uint32_t>(_frame_count % UINT_MAX));
+			break;
+		case special_uniform::random:
+			data[0] = encode_special_uniform_value(update, static_cast<int32_t>(update.random.min + (std::rand() % (std::abs(update.random.max - update.random.min) + 1))));
+			break;
+		case special_uniform::ping_pong:
+			{
+				const float min = update.ping_pong.min;
+				const float max = update.ping_pong.max;
+				float increment = update.ping_pong.step_max == 0 ? update.ping_pong.step_min : (update.ping_pong.step_min + std::fmod(static_cast<float>(std::rand()), update.ping_pong.step_max - update.ping_pong.step_min + 1));
+
+				count = 2;
+				read_values(update, data, count);
+				float value[2] = { decode_special_uniform_value(update, data[0]), decode_special_uniform_value(update, data[1]) };
+				if (value[1] >= 0)
+				{
+					increment = std::max(increment - std::max(0.0f, update.ping_pong.smoothing - (max - value[0])), 0.05f);
+					increment *= _last_frame_duration.count() * 1e-9f;
+
+					if ((value[0] += increment) >= max)
+						value[0] = max, value[1] = -1;
+				}
+				else
+				{
+					increment = std::max(increment - std::max(0.0f, update.ping_pong.smoothing - (value[0] - min)), 0.05f);
+					increment *= _last_frame_duration.count() * 1e-9f;
+
+					if ((value[0] -= increment) <= min)
+						value[0] = min, value[1] = +1;
+				}
+				data[0] = encode_special_uniform_value(update, value[0]);
+				data[1] = encode_special_uniform_value(update, value[1]);
+			}
+			break;
+		case special_uniform::date:
+			{
+				const std::time_t t = std::chrono::system_clock::to_time_t(_current_time);
+				struct tm tm; localtime_s(&tm, &t);
+
+				data[0] = encode_special_uniform_value(update, static_cast<int32_t>(tm.tm_year + 1900));
+				data[1] = encode_special_uniform_value(update, static_cast<int32_t>(tm.tm_mon + 1));
+				data[2] = encode_special_uniform_value(update, static_cast<int32_t>(tm.tm_mday));
+				data[3] = encode_special_uniform_value(update, static_cast<int32_t>(tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec));
+			}
+			break;
+		case special_uniform::timer:
+			{
+				const unsigned long long timer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count();
+				data[0] = encode_special_uniform_value(update, static_cast<uint32_t>(timer_ms));
+			}
+			break;
+		case special_uniform::key:
+		case special_uniform::mouse_button:
+			{
+				if (_input == nullptr)
+					continue;
+
+				const bool is_key = update.special == special_uniform::key;
+
+				switch (update.mode)
+				{
+				case special_uniform_update::input_mode::toggle:
+					if (!(is_key ? _input->is_key_pressed(update.input.keycode) : _input->is_mouse_button_pressed(update.input.keycode)))
+						continue;
+					read_values(update, data, 1);
+					data[0] = encode_special_uniform_value(update, data[0] == 0);
+					break;
+				case special_uniform_update::input_mode::press:
+					data[0] = encode_special_uniform_value(update, is_key ? _input->is_key_pressed(update.input.keycode) : _input->is_mouse_button_pressed(update.input.keycode));
+					break;
+				case special_uniform_update::input_mode::down:
+					data[0] = encode_special_uniform_value(update, is_key ? _input->is_key_down(update.input.keycode) : _input->is_mouse_button_down(update.input.keycode));
+					break;
+				}
+			}
+			break;
+		case special_uniform::mouse_point:
+			if (_input == nullptr)
+				continue;
+			data[0] = encode_special_uniform_value(update, static_cast<uint32_t>(_input->mouse_position_x()));
+			data[1] = encode_special_uniform_value(update, static_cast<uint32_t>(_input->mouse_position_y()));
+			break;
+		case special_uniform::mouse_delta:
+			if (_input == nullptr)
+				continue;
+			data[0] = encode_special_uniform_value(update, static_cast<int32_t>(_input->mouse_movement_delta_x()));
+			data[1] = encode_special_uniform_value(update, static_cast<int32_t>(_input->mouse_movement_delta_y()));
+			break;
+		case special_uniform::mouse_wheel:
+			{
+				if (_input == nullptr)
+					continue;
+
+				count = 2;
+				read_values(update, data, count);
+				float value[2] = { decode_special_uniform_value(update, data[0]), 0 };
+				value[1] = _input->mouse_wheel_delta();
+				value[0] = value[0] + value[1] * update.mouse_wheel.step;
+				if (update.mouse_wheel.min != update.mouse_wheel.max)
+				{
+					value[0] = std::max(value[0], update.mouse_wheel.min);
+					value[0] = std::min(value[0], update.mouse_wheel.max);
+				}
+				data[0] = encode_special_uniform_value(update, value[0]);
+				data[1] = encode_special_uniform_value(update, value[1]);
+			}
+			break;
+#if RESHADE_GUI
+		case special_uniform::overlay_open:
+			data[0] = encode_special_uniform_value(update, _show_overlay);
+			break;
+		case special_uniform::overlay_active:
+		case special_uniform::overlay_hovered:
+			// These are set in 'draw_variable_editor' when overlay is open
+			if (_show_overlay)
+				continue;
+			break;
+#endif
+		case special_uniform::screenshot:
+			data[0] = encode_special_uniform_value(update, _should_save_screenshot);
+			break;
+		}
+
+		if (update.direct && !notify_addons)
+		{
+			// Most special variables do not change every frame, so avoid marking the constant buffer for an update unless necessary
+			if (const size_t size = std::min(count * 4, static_cast<size_t>(update.size));
+				std::memcmp(effect.uniform_data_storage.data() + update.offset, data, size) != 0)
+			{
+				std::memcpy(effect.uniform_data_storage.data() + update.offset, data, size);
+				effect.uniform_data_dirty = true;
+			}
+		}
+		else
+			set_uniform_value_data(effect.uniforms[update.uniform_index], reinterpret_cast<const uint8_t *>(data), count * 4, 0);
+	}
+}
+
 void reshade::runtime::get_uniform_value_data(const uniform &variable, uint8_t *data, size_t size, size_t base_index) const
 {
 	size = std::min(size, static_cast<size_t>(variable.size));
@@ -4688,6 +5747,8 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	if (assert(base_index < array_length); base_index >= array_length)
 		return;
 
+	_effects[variable.effect_index].uniform_data_dirty = true;
+
 	if (variable.type.is_matrix())
 	{
 		for (size_t a = base_index, i = 0; a < array_length; ++a)
@@ -4828,33 +5889,27 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 
 	_last_screenshot_save_successful = true;
 
-	if (std::vector<uint8_t> pixels(static_cast<size_t>(_width) * static_cast<size_t>(_height) * (screenshot_format >= 4 ? 6 : 4));
-		get_texture_data(
-			_back_buffer_resolved != 0 ? _back_buffer_resolved : _swapchain->get_current_back_buffer(),
-			_back_buffer_resolved != 0 ? api::resource_usage::render_target : api::resource_usage::present,
-			pixels.data(),
-			screenshot_format >= 4 ? (_back_buffer_format == api::format::r16g16b16a16_float ? api::format::r16g16b16_float : api::format::r16g16b16_unorm) : api::format::r8g8b8a8_unorm))
-	{
-		const bool include_preset =
-			_screenshot_include_preset &&
-			postfix != "Before" && postfix != "Overlay" &&
-			ini_file::flush_cache(_current_preset_path);
+	const bool include_preset =
+		_screenshot_include_preset &&
+		postfix != "Before" && postfix != "Overlay" &&
+		ini_file::flush_cache(_current_preset_path);
 
-		// Play screenshot sound
-		if (!_screenshot_sound_path.empty())
-			utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
+	const api::resource back_buffer_resource = _back_buffer_resolved != 0 ? _back_buffer_resolved : _swapchain->get_current_back_buffer();
+	const api::resource_usage back_buffer_state = _back_buffer_resolved != 0 ? api::resource_usage::render_target : api::resource_usage::present;
+	const api::format quantization_format = screenshot_format >= 4 ? (_back_buffer_format == api::format::r16g16b16a16_float ? api::format::r16g16b16_float : api::format::r16g16b16_unorm) : api::format::r8g8b8a8_unorm;
 
-		_worker_threads.emplace_back([this, screenshot_count, screenshot_format, screenshot_path, postfix, pixels = std::move(pixels), include_preset]() mutable {
+	// Copy is only read back a few frames later, at which point the data is converted and written to disk on a worker thread, so this does not stall the render thread
+	if (queue_texture_readback(back_buffer_resource, back_buffer_state, quantization_format, [this, width = _width, height = _height, back_buffer_format = _back_buffer_format, back_buffer_color_space = _back_buffer_color_space, clear_alpha = _screenshot_clear_alpha, jpeg_quality = _screenshot_jpeg_quality, screenshot_count, screenshot_format, screenshot_path, postfix, include_preset](std::vector<uint8_t> &pixels) {
 			// Remove alpha channel
 			int comp = 4;
 			if (screenshot_format >= 4)
 			{
 				comp = 3;
 			}
-			else if (_screenshot_clear_alpha)
+			else if (clear_alpha)
 			{
 				comp = 3;
-				for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
+				for (size_t i = 0; i < static_cast<size_t>(width) * static_cast<size_t>(height); ++i)
 					*reinterpret_cast<uint32_t *>(pixels.data() + 3 * i) = *reinterpret_cast<const uint32_t *>(pixels.data() + 4 * i);
 			}
 
@@ -4877,79 +5932,42 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 				switch (screenshot_format)
 				{
 				case 0:
-					save_success = stbi_write_bmp_to_func(write_callback, file, _width, _height, comp, pixels.data()) != 0;
+					save_success = stbi_write_bmp_to_func(write_callback, file, width, height, comp, pixels.data()) != 0;
 					break;
 				case 1:
 #if 1
 					if (std::vector<uint8_t> encoded_data;
-						fpng::fpng_encode_image_to_memory(pixels.data(), _width, _height, comp, encoded_data))
+						fpng::fpng_encode_image_to_memory(pixels.data(), width, height, comp, encoded_data))
 						save_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size();
 #else
-					save_success = stbi_write_png_to_func(write_callback, file, _width, _height, comp, pixels.data(), 0) != 0;
+					save_success = stbi_write_png_to_func(write_callback, file, width, height, comp, pixels.data(), 0) != 0;
 #endif
 					break;
 				case 2:
-					save_success = stbi_write_jpg_to_func(write_callback, file, _width, _height, comp, pixels.data(), _screenshot_jpeg_quality) != 0;
+					save_success = stbi_write_jpg_to_func(write_callback, file, width, height, comp, pixels.data(), jpeg_quality) != 0;
 					break;
 				case 4: // HDR PNG
-					if (_back_buffer_format == api::format::r16g16b16a16_float)
+					if (back_buffer_format == api::format::r16g16b16a16_float)
 					{
-						if (!fpng::fpng_cpu_supports_sse41())
-						{
-							// Technically requires F16C instruction set, not just SSE4.1
-							save_success = false;
-							break;
-						}
+						const format_conversion::transfer_function transfer = back_buffer_color_space == api::color_space::hdr10_hlg ? format_conversion::transfer_function::hlg : format_conversion::transfer_function::pq;
 
-						for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
-						{
-							uint16_t *const pixel = reinterpret_cast<uint16_t *>(pixels.data()) + i * 3;
-							alignas(16) uint16_t result[4] = { pixel[0], pixel[1], pixel[2] };
-
-							// Convert 16-bit floating point values to 32-bit floating point
-							auto rgba_float_srgb = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(result)));
-
-							// Convert BT.709/sRGB to BT.2020 primaries
-							auto rgba_float_bt2100 = _mm_max_ps(_mm_setzero_ps(),
-								_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b00000000), _mm_setr_ps(0.627403914928436279296875f,     0.069097287952899932861328125f,    0.01639143936336040496826171875f, 0.0f)),
-								_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b01010101), _mm_setr_ps(0.3292830288410186767578125f,    0.9195404052734375f,               0.08801330626010894775390625f,    0.0f)),
-								           _mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b10101010), _mm_setr_ps(0.0433130674064159393310546875f, 0.011362315155565738677978515625f, 0.895595252513885498046875f,      0.0f)))));
-
-							// Convert linear to PQ
-							// PQ constants as per Rec. ITU-R BT.2100-3 Table 4
-							const float PQ_m1 = 0.1593017578125f;
-							const float PQ_m2 = 78.84375f;
-							const float PQ_c1 = 0.8359375f;
-							const float PQ_c2 = 18.8515625f;
-							const float PQ_c3 = 18.6875f;
-
-							auto rgba_float_bt2100_pq = _mm_div_ps(rgba_float_bt2100, _mm_set_ps1(125.0f));
-							alignas(16) float temp[4];
-							_mm_store_ps(temp, rgba_float_bt2100_pq);
-							rgba_float_bt2100_pq = _mm_setr_ps(std::powf(temp[0], PQ_m1), std::powf(temp[1], PQ_m1), std::powf(temp[2], PQ_m1), 0.0f);
-							rgba_float_bt2100_pq = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps1(PQ_c2), rgba_float_bt2100_pq), _mm_set_ps1(PQ_c1)), _mm_add_ps(_mm_mul_ps(_mm_set_ps1(PQ_c3), rgba_float_bt2100_pq), _mm_set_ps1(1.0f)));
-							_mm_store_ps(temp, rgba_float_bt2100_pq);
-							rgba_float_bt2100_pq = _mm_setr_ps(std::powf(temp[0], PQ_m2), std::powf(temp[1], PQ_m2), std::powf(temp[2], PQ_m2), 0.0f);
-
-							// Convert to integers and pack into 16-bit range
-							_mm_storel_epi64(reinterpret_cast<__m128i *>(result), _mm_packus_epi32(_mm_cvtps_epi32(_mm_mul_ps(rgba_float_bt2100_pq, _mm_set_ps1(65536.0f))), _mm_setzero_si128()));
-
-							pixel[0] = result[0];
-							pixel[1] = result[1];
-							pixel[2] = result[2];
-						}
+						// Convert scRGB to BT.2020 primaries and encode with the transfer function the file is tagged with below, in place and in parallel bands of pixels
+						_worker_pool.parallel_for(static_cast<size_t>(width) * static_cast<size_t>(height), [&pixels, transfer](size_t begin, size_t end) {
+							uint16_t *const rgb = reinterpret_cast<uint16_t *>(pixels.data()) + begin * 3;
+							format_conversion::encode_scrgb_to_bt2100(rgb, rgb, end - begin, transfer);
+						}, 16384);
 					}
 
 					save_success = stbi_write_hdr_png_to_func(
 						write_callback,
 						file,
-						_width,
-						_height,
+						width,
+						height,
 						comp,
 						reinterpret_cast<uint16_t *>(pixels.data()),
 						0,
 						static_cast<unsigned char>(JXL_PRIMARIES_2100),
-						static_cast<unsigned char>(_back_buffer_color_space == api::color_space::hdr10_hlg ? JXL_TRANSFER_FUNCTION_HLG : JXL_TRANSFER_FUNCTION_PQ)) != 0;
+						static_cast<unsigned char>(back_buffer_color_space == api::color_space::hdr10_hlg ? JXL_TRANSFER_FUNCTION_HLG : JXL_TRANSFER_FUNCTION_PQ)) != 0;
 					break;
 				case 3:
 				case 5: // HDR JPEG XL
@@ -4957,9 +5975,9 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 					color_encoding.color_space = JXL_COLOR_SPACE_RGB;
 					color_encoding.white_point = JXL_WHITE_POINT_D65;
 					color_encoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
-					color_encoding.is_float = _back_buffer_format == api::format::r16g16b16a16_float;
+					color_encoding.is_float = back_buffer_format == api::format::r16g16b16a16_float;
 
-					switch (_back_buffer_color_space)
+					switch (back_buffer_color_space)
 					{
 					default:
 					case api::color_space::srgb:
@@ -4983,33 +6001,16 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 					uint8_t *encoded_data = nullptr;
 					const size_t encoded_size = JxlSimpleLosslessEncode(
 						pixels.data(),
-						_width,
-						static_cast<size_t>(_width) * comp * (screenshot_format >= 4 ? 2 : 1),
-						_height,
+						width,
+						static_cast<size_t>(width) * comp * (screenshot_format >= 4 ? 2 : 1),
+						height,
 						comp,
 						screenshot_format >= 4 ? 16 : 8,
 						/* big_endian = */ false,
 						/* effort = */ 2,
 						&encoded_data,
-						nullptr,
-						[](void *, void *opaque, void fun(void *, size_t), size_t count) {
-							const size_t num_splits = std::min(count, static_cast<size_t>(std::thread::hardware_concurrency()));
-							if (num_splits == 1)
-							{
-								for (size_t i = 0; i < count; ++i)
-									fun(opaque, i);
-								return;
-							}
-							std::vector<std::thread> worker_threads;
-							for (size_t n = 0; n < num_splits; ++n)
-								worker_threads.emplace_back([count, opaque, fun, num_splits, n]() {
-									for (size_t i = 0; i < count; ++i)
-										if (i * num_splits / count == n)
-											fun(opaque, i);
-								});
-							for (std::thread &thread : worker_threads)
-								thread.join();
-						},
+						&_worker_pool,
+						jxl_parallel_runner,
 						color_encoding);
 
 					if (encoded_data && encoded_size > 0)
@@ -5055,7 +6056,11 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 				_last_screenshot_file = screenshot_path;
 				_last_screenshot_save_successful = save_success;
 			}
-		});
+		}))
+	{
+		// Play screenshot sound
+		if (!_screenshot_sound_path.empty())
+			utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
 	}
 }
 bool reshade::runtime::execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count, std::string_view postfix)
@@ -5104,6 +6109,25 @@ bool reshade::runtime::execute_screenshot_post_save_command(const std::filesyste
 	return true;
 }
 
+static bool convert_texture_data(reshade::thread_pool &pool, const reshade::api::subresource_data &mapped_data, uint32_t width, uint32_t height, reshade::api::format intermediate_format, uint8_t *pixels, reshade::api::format quantization_format)
+{
+	if (!reshade::format_conversion::is_supported(intermediate_format, quantization_format))
+	{
+		reshade::log::message(reshade::log::level::error, "Screenshots are not supported for format %u!", static_cast<uint32_t>(intermediate_format));
+		return false;
+	}
+
+	const uint32_t pixels_row_pitch = reshade::api::format_row_pitch(quantization_format, width);
+
+	// Convert bands of rows in parallel, since a single thread cannot saturate memory bandwidth for large images
+	pool.parallel_for(height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; ++y)
+			reshade::format_conversion::convert(static_cast<const uint8_t *>(mapped_data.data) + y * mapped_data.row_pitch, intermediate_format, pixels + y * pixels_row_pitch, quantization_format, width);
+	}, 64);
+
+	return true;
+}
+
 bool reshade::runtime::get_texture_data(api::resource resource, api::resource_usage state, uint8_t *pixels, api::format quantization_format)
 {
 	assert(quantization_format != api::format::unknown && quantization_format == api::format_to_default_typed(quantization_format, 0));
@@ -5132,140 +6156,231 @@ bool reshade::runtime::get_texture_data(api::resource resource, api::resource_us
 	_device->destroy_fence(copy_sync_fence);
 
 	// Copy data from intermediate image into output buffer
-	api::subresource_data mapped_data = {};
-	if (_device->map_texture_region(intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+	bool success = false;
+	if (api::subresource_data mapped_data = {};
+		_device->map_texture_region(intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+	{
+		success = convert_texture_data(_worker_pool, mapped_data, desc.texture.width, desc.texture.height, intermediate_format, pixels, quantization_format);
+
+		_device->unmap_texture_region(intermediate, 0);
+	}
+
+	_device->destroy_resource(intermediate);
+
+	return success;
+}
+bool reshade::runtime::queue_texture_readback(api::resource resource, api::resource_usage state, api::format quantization_format, std::function<void(std::vector<uint8_t> &pixels)> callback)
+{
+	assert(quantization_format != api::format::unknown && quantization_format == api::format_to_default_typed(quantization_format, 0));
+
+	const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+	const api::resource_desc desc = _device->get_resource_desc(resource);
+	const api::format intermediate_format = api::format_to_default_typed(desc.texture.format, 0);
+
+	// Find a free slot, preferring one that already has a texture of matching dimensions and format, so that it does not have to be recreated
+	size_t slot_index = std::numeric_limits<size_t>::max();
+	size_t oldest_slot_index = 0;
+	for (size_t i = 0; i < std::size(_readback_slots); ++i)
 	{
-		auto mapped_pixels = static_cast<const uint8_t *>(mapped_data.data);
-		const uint32_t pixels_row_pitch = api::format_row_pitch(quantization_format, desc.texture.width);
+		const readback_slot &slot = _readback_slots[i];
 
-		for (size_t y = 0; y < desc.texture.height; ++y, pixels += pixels_row_pitch, mapped_pixels += mapped_data.row_pitch)
+		if (slot.state != readback_state::free)
 		{
-			if (quantization_format == intermediate_format)
-			{
-				std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
-				continue;
-			}
+			if (slot.fence_value < _readback_slots[oldest_slot_index].fence_value || _readback_slots[oldest_slot_index].state == readback_state::free)
+				oldest_slot_index = i;
+			continue;
+		}
 
-			if (quantization_format == api::format::r8g8b8a8_unorm)
-			{
-				switch (intermediate_format)
-				{
-				case api::format::r8_unorm:
-					for (size_t x = 0; x < desc.texture.width; ++x)
-					{
-						pixels[x * 4 + 0] = mapped_pixels[x];
-						pixels[x * 4 + 1] = 0;
-						pixels[x * 4 + 2] = 0;
-						pixels[x * 4 + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r8g8_unorm:
-					for (size_t x = 0; x < desc.texture.width; ++x)
-					{
-						pixels[x * 4 + 0] = mapped_pixels[x * 2 + 0];
-						pixels[x * 4 + 1] = mapped_pixels[x * 2 + 1];
-						pixels[x * 4 + 2] = 0;
-						pixels[x * 4 + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r8g8b8x8_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 0];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 2];
-						pixels[x + 3] = 0xFF;
-					}
-					continue;
-				case api::format::b8g8r8a8_unorm:
-					// Format is BGRA, but output should be RGBA, so flip channels
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 2];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 0];
-						pixels[x + 3] = mapped_pixels[x + 3];
-					}
-					continue;
-				case api::format::b8g8r8x8_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 2];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 0];
-						pixels[x + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r10g10b10a2_unorm:
-				case api::format::b10g10r10a2_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						const auto offset_r = intermediate_format == api::format::b10g10r10a2_unorm ? 2 : 0;
-						const auto offset_g = 1;
-						const auto offset_b = intermediate_format == api::format::b10g10r10a2_unorm ? 0 : 2;
-						const auto offset_a = 3;
-
-						const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
-						// Divide by 4 to get 10-bit range (0-1023) into 8-bit range (0-255)
-						pixels[x + offset_r] = (( rgba & 0x000003FFu)        /  4) & 0xFF;
-						pixels[x + offset_g] = (((rgba & 0x000FFC00u) >> 10) /  4) & 0xFF;
-						pixels[x + offset_b] = (((rgba & 0x3FF00000u) >> 20) /  4) & 0xFF;
-						pixels[x + offset_a] = (((rgba & 0xC0000000u) >> 30) * 85) & 0xFF;
-					}
-					continue;
-				}
-			}
-			else if (quantization_format == api::format::r16g16b16_unorm)
-			{
-				switch (intermediate_format)
-				{
-				case api::format::r10g10b10a2_unorm:
-				case api::format::b10g10r10a2_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint16_t) * 3)
-					{
-						const auto offset_r = intermediate_format == api::format::b10g10r10a2_unorm ? 2 : 0;
-						const auto offset_g = 1;
-						const auto offset_b = intermediate_format == api::format::b10g10r10a2_unorm ? 0 : 2;
-
-						const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + (x / (sizeof(uint16_t) * 3)) * 4);
-						// Multiply by 64 to get 10-bit range (0-1023) into 16-bit range (0-65535)
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_r] = ( (rgba & 0x000003FFu)        * 64) & 0xFFFF;
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_g] = (((rgba & 0x000FFC00u) >> 10) * 64) & 0xFFFF;
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_b] = (((rgba & 0x3FF00000u) >> 20) * 64) & 0xFFFF;
-					}
-					continue;
-				}
-			}
-			else if (quantization_format == api::format::r16g16b16_float && intermediate_format == api::format::r16g16b16a16_float)
-			{
-				for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint16_t) * 3)
-				{
-					std::memcpy(pixels + x, mapped_pixels + (x / 3) * 4, sizeof(uint16_t) * 3);
-				}
-				continue;
-			}
-			else if (quantization_format == api::format::r10g10b10a2_unorm && intermediate_format == api::format::b10g10r10a2_unorm)
+		if (slot_index == std::numeric_limits<size_t>::max() ||
+			(slot.desc.texture.width == desc.texture.width && slot.desc.texture.height == desc.texture.height && slot.desc.texture.format == intermediate_format))
+			slot_index = i;
+	}
+
+	// All slots are still in flight, so have to wait for the oldest one to become available again (this is the only case in which this blocks)
+	if (slot_index == std::numeric_limits<size_t>::max())
+	{
+		flush_texture_readback(oldest_slot_index);
+		slot_index = oldest_slot_index;
+	}
+
+	readback_slot &slot = _readback_slots[slot_index];
+
+	if (slot.desc.texture.width != desc.texture.width || slot.desc.texture.height != desc.texture.height || slot.desc.texture.format != intermediate_format)
+	{
+		_device->destroy_resource(slot.resource);
+		slot.resource = {};
+
+		slot.desc = api::resource_desc(desc.texture.width, desc.texture.height, 1, 1, intermediate_format, 1, api::memory_heap::readback, api::resource_usage::copy_dest);
+
+		if (!_device->create_resource(slot.desc, nullptr, api::resource_usage::copy_dest, &slot.resource))
+		{
+			log::message(log::level::error, "Failed to create system memory texture for screenshot capture!");
+			slot.desc = {};
+			return false;
+		}
+
+		_device->set_resource_name(slot.resource, "ReShade readback texture");
+	}
+
+	// Reserve the memory the converted pixels are written to up front, so that the number of readbacks waiting to be encoded stays bounded
+	const size_t pixels_size = static_cast<size_t>(api::format_row_pitch(quantization_format, desc.texture.width)) * desc.texture.height;
+	if (!_readback_buffers.try_acquire(pixels_size, slot.pixels))
+	{
+		// All buffers are in use, so apply back-pressure: Push all pending readbacks through to encoding and then wait for one of them to finish and release its buffer
+		for (size_t i = 0; i < std::size(_readback_slots); ++i)
+			if (i != slot_index && _readback_slots[i].state != readback_state::free)
+				flush_texture_readback(i);
+
+		_readback_buffers.acquire(pixels_size, slot.pixels);
+	}
+
+	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+	cmd_list->barrier(resource, state, api::resource_usage::copy_source);
+	cmd_list->copy_texture_region(resource, 0, nullptr, slot.resource, 0, nullptr);
+	cmd_list->barrier(resource, api::resource_usage::copy_source, state);
+
+	slot.quantization_format = quantization_format;
+	slot.callback = std::move(callback);
+	slot.state = readback_state::copying;
+
+	// Copy is mapped in 'update_texture_readbacks' once the fence signals its completion, which typically happens a frame or two later
+	slot.fence_value = ++_readback_fence_value;
+	if (_readback_fence == 0 || !_graphics_queue->signal(_readback_fence, slot.fence_value))
+	{
+		// Without a fence there is no way to tell when the copy finished, so fall back to waiting for it right away
+		_graphics_queue->wait_idle();
+		slot.fence_value = 0;
+	}
+
+	_readback_duration += std::chrono::high_resolution_clock::now() - time_started;
+
+	return true;
+}
+void reshade::runtime::update_texture_readbacks()
+{
+	const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+	bool has_readback_work = _readback_duration.count() != 0;
+
+	const uint64_t completed_fence_value = _readback_fence != 0 ? _device->get_completed_fence_value(_readback_fence) : 0;
+
+	for (size_t slot_index = 0; slot_index < std::size(_readback_slots); ++slot_index)
+	{
+		readback_slot &slot = _readback_slots[slot_index];
+
+		switch (slot.state)
+		{
+		case readback_state::copying:
+			if (slot.fence_value <= completed_fence_value)
 			{
-				// Format is BGRA, but output should be RGBA, so flip channels
-				for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint32_t))
-				{
-					const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
-					*reinterpret_cast<uint32_t *>(pixels + x) = ((rgba & 0x000003FFu) << 20) | ((rgba & 0x3FF00000u) >> 20) | (rgba & 0xC00FFC00u);
-				}
-				continue;
+				map_texture_readback(slot_index);
+				has_readback_work = true;
 			}
+			break;
+		case readback_state::converted:
+			// Mapping has to be released on the render thread, since not all graphics APIs allow doing that from other threads
+			_device->unmap_texture_region(slot.resource, 0);
+			slot.state = readback_state::free;
+			has_readback_work = true;
+			break;
+		}
+	}
 
-			// Unsupported quantization, return an error below
-			mapped_data.data = nullptr;
+	// Statistics include the time spent queuing readbacks during the previous frame, so that this reflects the entire hitch caused on the render thread
+	if (has_readback_work)
+	{
+		_readback_duration += std::chrono::high_resolution_clock::now() - time_started;
+		_last_readback_duration = _readback_duration;
+		_peak_readback_duration = std::max(_peak_readback_duration, _readback_duration);
+	}
+	_readback_duration = {};
+}
+void reshade::runtime::map_texture_readback(size_t slot_index)
+{
+	readback_slot &slot = _readback_slots[slot_index];
+	assert(slot.state == readback_state::copying);
 
-			log::message(log::level::error, "Screenshots are not supported for format %u!", static_cast<uint32_t>(desc.texture.format));
-			break;
+	if (!_device->map_texture_region(slot.resource, 0, nullptr, api::map_access::read_only, &slot.mapped_data))
+	{
+		log::message(log::level::error, "Failed to map system memory texture for screenshot capture!");
+		_readback_buffers.release(slot.pixels);
+		slot.callback = nullptr;
+		slot.state = readback_state::free;
+		return;
+	}
+
+	slot.state = readback_state::mapped;
+
+	// Convert and encode the data on a worker thread, reading directly from the mapped memory
+	_worker_pool.submit([this, slot_index]() {
+		std::vector<uint8_t> pixels;
+		std::function<void(std::vector<uint8_t> &pixels)> callback;
+		if (convert_texture_readback(slot_index, pixels, callback))
+		{
+			if (callback != nullptr)
+				callback(pixels);
+
+			_readback_buffers.release(pixels);
 		}
+	});
+}
+bool reshade::runtime::convert_texture_readback(size_t slot_index, std::vector<uint8_t> &pixels, std::function<void(std::vector<uint8_t> &pixels)> &callback)
+{
+	readback_slot &slot = _readback_slots[slot_index];
 
-		_device->unmap_texture_region(intermediate, 0);
+	// Both a worker and the render thread (in 'flush_texture_readback') may try to convert a slot, so only continue for whichever claims it first
+	if (readback_state expected = readback_state::mapped;
+		!slot.state.compare_exchange_strong(expected, readback_state::converting))
+		return false;
+
+	pixels = std::move(slot.pixels);
+	slot.pixels = {};
+	callback = std::move(slot.callback);
+	slot.callback = nullptr;
+
+	// Drop the callback if conversion fails, but still hand out the buffer, so that the caller returns it to the pool
+	if (!convert_texture_data(_worker_pool, slot.mapped_data, slot.desc.texture.width, slot.desc.texture.height, slot.desc.texture.format, pixels.data(), slot.quantization_format))
+		callback = nullptr;
+
+	// The mapped memory is no longer accessed after this point, so the render thread may unmap and reuse the slot
+	slot.state = readback_state::converted;
+
+	return true;
+}
+void reshade::runtime::flush_texture_readback(size_t slot_index)
+{
+	readback_slot &slot = _readback_slots[slot_index];
+
+	if (slot.state == readback_state::copying)
+	{
+		if (slot.fence_value != 0 && !_device->wait(_readback_fence, slot.fence_value))
+			_graphics_queue->wait_idle();
+
+		map_texture_readback(slot_index);
 	}
 
-	_device->destroy_resource(intermediate);
+	// Convert right away if no worker picked up the slot yet, so that this does not have to wait on other jobs queued in the pool
+	std::vector<uint8_t> pixels;
+	std::function<void(std::vector<uint8_t> &pixels)> callback;
+	if (convert_texture_readback(slot_index, pixels, callback))
+	{
+		// Encoding is still done on a worker thread
+		_worker_pool.submit([this, callback = std::move(callback), pixels = std::move(pixels)]() mutable {
+			if (callback != nullptr)
+				callback(pixels);
 
-	return mapped_data.data != nullptr;
+			_readback_buffers.release(pixels);
+		});
+	}
+
+	// Otherwise a worker may be in the middle of converting, which only takes a few milliseconds
+	while (slot.state == readback_state::converting)
+		std::this_thread::yield();
+
+	if (slot.state == readback_state::converted)
+	{
+		_device->unmap_texture_region(slot.resource, 0);
+		slot.state = readback_state::free;
+	}
 }
@@ -8,6 +8,9 @@
 #include "reshade_api.hpp"
 #include "state_block.hpp"
 #include "imgui_code_editor.hpp"
+#include "effect_cache_index.hpp"
+#include "thread_pool.hpp"
+#include "buffer_pool.hpp"
 #include <atomic>
 #include <thread>
 #include <chrono>
@@ -22,6 +25,8 @@ namespace reshade
 	struct uniform;
 	struct texture;
 	struct technique;
+	struct transient_texture_allocation;
+	struct assembled_entry_point;
 
 	/// <summary>
 	/// The main ReShade post-processing effect runtime.
@@ -181,12 +186,19 @@ namespace reshade
 
 		bool switch_to_next_preset(std::filesystem::path filter_path, bool reversed = false);
 
-		bool load_effect(const std::filesystem::path &source_file, const class ini_file &preset, size_t effect_index, size_t permutation_index, bool force_load = false, bool preprocess_required = false);
+		bool load_effect(const std::filesystem::path &source_file, const class ini_file &preset, size_t effect_index, size_t permutation_index, bool force_load = false, bool preprocess_required = false, effect *staged_effect = nullptr);
 		bool create_effect(size_t effect_index, size_t permutation_index);
 		void destroy_effect(size_t effect_index, bool unload = true);
+		template <typename T>
+		void destroy_effect_object(T object, void(api::device:: *destroy_func)(T));
+
+		bool compile_technique(technique &technique, size_t permutation_index);
+		bool create_technique_pipelines(technique &technique, size_t permutation_index);
+		void update_assembled_entry_points();
 
 		void load_textures(size_t effect_index);
 		bool create_texture(texture &texture);
+		bool create_transient_texture(texture &texture);
 		void destroy_texture(texture &texture);
 
 		void enable_technique(technique &technique);
@@ -197,8 +209,12 @@ namespace reshade
 		void load_effects(bool force_load_all = false);
 		bool reload_effect(size_t effect_index);
 		void reload_effects(bool force_load_all = false);
+		bool reload_effects_in_background(const std::vector<std::filesystem::path> &changed_files);
 		void destroy_effects();
 
+		void update_effect_file_dependencies();
+		void check_effect_files_for_changes();
+
 		bool load_effect_cache(const std::string &id, const std::string &type, std::string &data) const;
 		bool save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const;
 		void clear_effect_cache();
@@ -208,11 +224,19 @@ namespace reshade
 		void update_effects();
 		void render_technique(technique &technique, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index);
 
+		void queue_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states);
+		void flush_barriers(api::command_list *cmd_list);
+		void transition_effect_resource(api::resource resource, api::resource_usage new_state);
+		void restore_effect_resource_states(api::command_list *cmd_list);
+
 		void save_texture(const texture &texture);
 		void update_texture(texture &texture, uint32_t width, uint32_t height, uint32_t depth, const void *pixels);
 
 		void reset_uniform_value(uniform &variable);
 
+		void compile_special_uniform_updates(effect &effect) const;
+		void update_special_uniforms(effect &effect);
+
 		void get_uniform_value_data(const uniform &variable, uint8_t *data, size_t size, size_t base_index) const;
 		template <typename T>
 		std::enable_if_t<std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, float>>
@@ -233,6 +257,11 @@ namespace reshade
 		bool get_preprocessor_definition(const std::string &effect_name, const std::string &name, int scope_mask, std::vector<std::pair<std::string, std::string>> *&scope, std::vector<std::pair<std::string, std::string>>::iterator &value) const;
 
 		bool get_texture_data(api::resource resource, api::resource_usage state, uint8_t *pixels, api::format quantization_format);
+		bool queue_texture_readback(api::resource resource, api::resource_usage state, api::format quantization_format, std::function<void(std::vector<uint8_t> &pixels)> callback);
+		void update_texture_readbacks();
+		void map_texture_readback(size_t slot_index);
+		bool convert_texture_readback(size_t slot_index, std::vector<uint8_t> &pixels, std::function<void(std::vector<uint8_t> &pixels)> &callback);
+		void flush_texture_readback(size_t slot_index);
 
 		bool execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count, std::string_view postfix);
 
@@ -283,6 +312,10 @@ namespace reshade
 		bool _no_reload_on_init = false;
 		bool _performance_mode = false;
 		bool _effect_load_skipping = false;
+		bool _effect_auto_reload = false;
+		// Off by default, since the contents of aliased textures are overwritten by other techniques before the end of the frame, which breaks viewing them in the overlay, saving them and reading them from add-ons
+		bool _transient_texture_aliasing = false;
+		bool _technique_prewarming = true;
 		unsigned int _reload_key_data[4] = {};
 
 		std::vector<std::pair<std::string, std::string>> _global_preprocessor_definitions;
@@ -290,6 +323,8 @@ namespace reshade
 		std::vector<std::pair<size_t, size_t>> _reload_required_effects;
 
 		std::filesystem::path _effect_cache_path;
+		reshadefx::effect_cache_index _effect_cache_index;
+		api::pipeline_cache _effect_pipeline_cache = {};
 		std::vector<std::filesystem::path> _effect_search_paths;
 		std::vector<std::filesystem::path> _texture_search_paths;
 
@@ -300,11 +335,30 @@ namespace reshade
 
 		std::vector<effect> _effects;
 		std::vector<texture> _textures;
+		std::vector<transient_texture_allocation> _transient_textures;
 		std::vector<technique> _techniques;
 		std::vector<size_t> _technique_sorting;
 
-		std::vector<std::thread> _worker_threads;
+		thread_pool _worker_pool;
+		thread_pool::group _reload_jobs;
+		std::unordered_map<std::string, std::chrono::high_resolution_clock::duration> _last_effect_load_durations;
 		std::chrono::high_resolution_clock::time_point _last_reload_time;
+
+		// Dependency graph from every file an effect was loaded from (the effect file and all included files) to the last write time and the indices of all effects depending on it
+		std::unordered_map<std::string, std::pair<std::filesystem::file_time_type, std::vector<size_t>>> _effect_file_dependencies;
+		std::chrono::high_resolution_clock::time_point _last_effect_file_check_time;
+		std::atomic<bool> _effect_file_check_running = false;
+		std::vector<std::pair<std::string, std::filesystem::file_time_type>> _changed_effect_files;
+
+		// Effects that are recompiled in the background while their previous version keeps rendering, until all of them finished and they can be swapped in at the start of a frame
+		std::vector<std::pair<size_t, effect>> _staged_effects;
+		std::atomic<size_t> _staged_effects_remaining = std::numeric_limits<size_t>::max();
+		thread_pool::group _staged_jobs;
+		// Objects of replaced effects that may still be referenced by frames in flight, with the frame count after which they can be destroyed
+		bool _defer_effect_object_destruction = false;
+		std::vector<std::pair<uint64_t, std::function<void()>>> _deferred_effect_object_destructions;
+		// Entry points of techniques that were enabled after their effect was loaded, which finished assembling in the background and are waiting to be added to their effect at the start of a frame
+		std::vector<assembled_entry_point> _assembled_entry_points;
 		#pragma endregion
 
 		#pragma region Effect Rendering
@@ -319,6 +373,8 @@ namespace reshade
 			api::format stencil_format = api::format::unknown;
 			api::resource stencil_tex = {};
 			api::resource_view stencil_dsv = {};
+			// Set when the back buffer may have been rendered to since it was last copied to the color texture
+			bool color_tex_outdated = true;
 		};
 		std::vector<effect_permutation> _effect_permutations;
 
@@ -339,6 +395,23 @@ namespace reshade
 		std::vector<api::resource_view> _back_buffer_targets;
 
 		api::state_block _app_state = {};
+
+		// Effect resources that were left in a state other than shader resource by the last pass using them, until all techniques finished rendering
+		std::vector<std::pair<api::resource, api::resource_usage>> _effect_resource_states;
+		std::vector<api::resource> _pending_barrier_resources;
+		std::vector<api::resource_usage> _pending_barrier_old_states;
+		std::vector<api::resource_usage> _pending_barrier_new_states;
+
+		size_t _uniform_upload_size = 0;
+		size_t _last_uniform_upload_size = 0;
+		uint32_t _back_buffer_copies = 0;
+		uint32_t _back_buffer_copies_saved = 0;
+		uint32_t _last_back_buffer_copies = 0;
+		uint32_t _last_back_buffer_copies_saved = 0;
+		// Memory used by effect textures, and the memory they would use if transient textures did not share allocations
+		uint64_t _texture_memory_size = 0;
+		uint64_t _texture_memory_size_peak = 0;
+		uint64_t _texture_memory_size_unaliased = 0;
 		#pragma endregion
 
 		#pragma region Screenshot
@@ -365,6 +438,36 @@ namespace reshade
 		bool _screenshot_directory_creation_successful = true;
 		std::filesystem::path _last_screenshot_file;
 		std::chrono::high_resolution_clock::time_point _last_screenshot_time;
+
+		enum class readback_state
+		{
+			free,
+			copying,
+			mapped,
+			converting,
+			converted
+		};
+
+		struct readback_slot
+		{
+			api::resource resource = {};
+			api::resource_desc desc;
+			api::format quantization_format = api::format::unknown;
+			uint64_t fence_value = 0;
+			api::subresource_data mapped_data = {};
+			std::vector<uint8_t> pixels;
+			std::function<void(std::vector<uint8_t> &pixels)> callback;
+			std::atomic<readback_state> state = readback_state::free;
+		};
+
+		readback_slot _readback_slots[4];
+		// Pixel buffers stay in use until the callback finished encoding, so this limits the memory used by readbacks that are still waiting to be written to disk
+		buffer_pool _readback_buffers { std::size(_readback_slots) };
+		api::fence _readback_fence = {};
+		uint64_t _readback_fence_value = 0;
+		std::chrono::high_resolution_clock::duration _readback_duration = {};
+		std::chrono::high_resolution_clock::duration _last_readback_duration = {};
+		std::chrono::high_resolution_clock::duration _peak_readback_duration = {};
 		#pragma endregion
 
 		#pragma region Preset Switching
@@ -1282,7 +1282,7 @@ void reshade::runtime::render_technique(api::effect_technique handle, api::comma
 	const size_t effect_index = tech->effect_index;
 
 	if (permutation_index >= tech->permutations.size() ||
-		(!tech->permutations[permutation_index].created && _effects[effect_index].permutations[permutation_index].cso.empty()))
+		(!tech->permutations[permutation_index].created && _effects[effect_index].permutations[permutation_index].cso.empty() && _effects[effect_index].permutations[permutation_index].codegen == nullptr))
 	{
 		if (std::find(_reload_required_effects.begin(), _reload_required_effects.end(), std::make_pair(effect_index, permutation_index)) == _reload_required_effects.end())
 			_reload_required_effects.emplace_back(effect_index, permutation_index);
@@ -1297,13 +1297,24 @@ void reshade::runtime::render_technique(api::effect_technique handle, api::comma
 		return;
 	}
 
+	// Assemble entry points of this technique in the background if that was deferred while loading the effect
+	if (!tech->permutations[permutation_index].pipelines_created)
+	{
+		compile_technique(*tech, permutation_index);
+		return;
+	}
+
 	if (!_is_in_present_call)
 		capture_state(cmd_list, _app_state);
 
 	invoke_addon_event<addon_event::reshade_begin_effects>(this, cmd_list, rtv, rtv_srgb);
 #endif
 
+	// Cannot know what was rendered to the passed in back buffer since the last call
+	_effect_permutations[permutation_index].color_tex_outdated = true;
+
 	render_technique(*tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
+	restore_effect_resource_states(cmd_list);
 
 #if RESHADE_ADDON
 	invoke_addon_event<addon_event::reshade_finish_effects>(this, cmd_list, rtv, rtv_srgb);
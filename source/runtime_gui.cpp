@@ -2111,6 +2111,12 @@ void reshade::runtime::draw_gui_settings()
 			reload_effects(!_effect_load_skipping);
 		}
 
+		modified |= ImGui::Checkbox(_("Reload effects when their files change"), &_effect_auto_reload);
+		ImGui::SetItemTooltip(_("Watches effect files and the files they include for changes and recompiles only the effects depending on them in the background."));
+
+		modified |= ImGui::Checkbox(_("Prepare techniques with shortcut keys in the background"), &_technique_prewarming);
+		ImGui::SetItemTooltip(_("Techniques are only compiled once they are first enabled. This compiles those that can be toggled with a shortcut key ahead of time, so that they show up immediately."));
+
 		if (ImGui::Button(_("Clear effect cache"), ImVec2(ImGui::CalcItemWidth(), 0)))
 			clear_effect_cache();
 		ImGui::SetItemTooltip(_("Clear effect cache located in \"%s\"."), _effect_cache_path.u8string().c_str());
@@ -2544,6 +2550,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::TextUnformatted(_("Resolution:"));
 		ImGui::Text(_("Frame %llu:"), _frame_count + 1);
 		ImGui::TextUnformatted(_("Post-Processing:"));
+		ImGui::TextUnformatted(_("Screenshot Readback:"));
+		ImGui::TextUnformatted(_("Constant Uploads:"));
+		ImGui::TextUnformatted(_("Back Buffer Copies:"));
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
@@ -2582,6 +2591,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%ux%u", _effect_permutations[0].width, _effect_permutations[0].height);
 		ImGui::Text("%.2f fps", _imgui_context->IO.Framerate);
 		ImGui::Text("%*.3f ms CPU", cpu_digits + 4, post_processing_time_cpu * 1e-6f);
+		ImGui::Text("%*.3f ms CPU", cpu_digits + 4, std::chrono::duration_cast<std::chrono::nanoseconds>(_last_readback_duration).count() * 1e-6f);
+		ImGui::Text("%zu bytes", _last_uniform_upload_size);
+		ImGui::Text("%u", _last_back_buffer_copies);
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
@@ -2598,6 +2610,12 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%*.3f ms", gpu_digits + 4, _last_frame_duration.count() * 1e-6f);
 		if (_gather_gpu_statistics && post_processing_time_gpu != 0)
 			ImGui::Text("%*.3f ms GPU", gpu_digits + 4, (post_processing_time_gpu * 1e-6f));
+		else
+			ImGui::NewLine();
+		// Peak is the worst stall on the render thread caused by screenshots since startup (including waiting for a pixel buffer when encoding cannot keep up)
+		ImGui::Text("%*.3f ms peak, %zu/%zu buffers", gpu_digits + 4, std::chrono::duration_cast<std::chrono::nanoseconds>(_peak_readback_duration).count() * 1e-6f, _readback_buffers.num_buffers_in_use(), _readback_buffers.max_buffers());
+		ImGui::NewLine();
+		ImGui::Text("%u saved", _last_back_buffer_copies_saved);
 
 		ImGui::EndGroup();
 	}
@@ -2716,6 +2734,53 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::EndGroup();
 	}
 
+	if (ImGui::CollapsingHeader(_("Effects")) && !is_loading())
+	{
+		ImGui::BeginGroup();
+
+		for (const effect &effect : _effects)
+		{
+			if (effect.load_duration.count() == 0)
+				continue;
+
+			ImGui::TextUnformatted(effect.source_file.filename().u8string().c_str());
+		}
+
+		ImGui::EndGroup();
+		ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
+		ImGui::BeginGroup();
+
+		for (const effect &effect : _effects)
+		{
+			if (effect.load_duration.count() == 0)
+				continue;
+
+			ImGui::Text("%8.3f ms load", std::chrono::duration_cast<std::chrono::nanoseconds>(effect.load_duration).count() * 1e-6f);
+		}
+
+		ImGui::EndGroup();
+		ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
+		ImGui::BeginGroup();
+
+		for (const effect &effect : _effects)
+		{
+			if (effect.load_duration.count() == 0)
+				continue;
+
+			// Stages that were skipped because their result was found in the effect cache show up as zero
+			ImGui::Text("%.1f | %.1f | %.1f | %.1f | %.1f ms",
+				std::chrono::duration_cast<std::chrono::nanoseconds>(effect.preprocess_duration).count() * 1e-6f,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(effect.parse_duration).count() * 1e-6f,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(effect.codegen_duration).count() * 1e-6f,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(effect.assemble_duration).count() * 1e-6f,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(effect.pipeline_duration).count() * 1e-6f);
+			if (ImGui::IsItemHovered())
+				ImGui::SetTooltip(_("Preprocess | Parse | Code generation | Assembly | Pipeline creation"));
+		}
+
+		ImGui::EndGroup();
+	}
+
 	if (ImGui::CollapsingHeader(_("Render Targets & Textures"), ImGuiTreeNodeFlags_DefaultOpen) && !is_loading())
 	{
 		struct texture_format_info
@@ -2860,7 +2925,7 @@ void reshade::runtime::draw_gui_statistics()
 
 			post_processing_memory_size += memory_size;
 
-			ImGui::TextColored(ImVec4(1, 1, 1, 1), "%s%s", tex.unique_name.c_str(), tex.shared.size() > 1 ? " (pooled)" : "");
+			ImGui::TextColored(ImVec4(1, 1, 1, 1), "%s%s", tex.unique_name.c_str(), tex.shared.size() > 1 ? " (pooled)" : tex.transient_resource ? " (transient)" : "");
 			switch (tex.type)
 			{
 			case reshadefx::texture_type::texture_1d:
@@ -3050,6 +3115,8 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Separator();
 
 		ImGui::Text(_("Total memory usage: %.3f MiB"), post_processing_memory_size / memory_size_unit);
+		// Transient textures of different techniques share allocations, so the memory actually allocated can be lower than the sum of all textures
+		ImGui::Text(_("Allocated memory: %.3f MiB (%.3f MiB peak, %.3f MiB without aliasing)"), _texture_memory_size / memory_size_unit, _texture_memory_size_peak / memory_size_unit, _texture_memory_size_unaliased / memory_size_unit);
 	}
 }
 void reshade::runtime::draw_gui_log()
@@ -4659,16 +4726,20 @@ void reshade::runtime::draw_code_editor(editor_instance &instance)
 			fclose(file);
 		}
 
-		if (!is_loading() && instance.effect_index < _effects.size())
+		if (!is_loading() && _staged_effects_remaining == std::numeric_limits<size_t>::max() && instance.effect_index < _effects.size())
 		{
 			// Clear modified flag, so that errors are updated next frame (see 'update_effects')
 			instance.editor.clear_modified();
 
-			reload_effect(instance.effect_index);
+			// Recompile all effects depending on the saved file in the background, falling back to reloading only the effect the editor belongs to if the file is not known yet
+			if (!reload_effects_in_background({ instance.file_path }))
+			{
+				reload_effect(instance.effect_index);
 
-			// Reloading an effect file invalidates all textures, but the statistics window may already have drawn references to those, so need to reset it
-			if (ImGuiWindow *const statistics_window = ImGui::FindWindowByName("###statistics"))
-				statistics_window->DrawList->CmdBuffer.clear();
+				// Reloading an effect file invalidates all textures, but the statistics window may already have drawn references to those, so need to reset it
+				if (ImGuiWindow *const statistics_window = ImGui::FindWindowByName("###statistics"))
+					statistics_window->DrawList->CmdBuffer.clear();
+			}
 		}
 	}
 
@@ -8,6 +8,12 @@
 #include "effect_module.hpp"
 #include "moving_average.hpp"
 #include <algorithm>
+#include <memory>
+
+namespace reshadefx
+{
+	class codegen;
+}
 
 namespace reshade
 {
@@ -72,12 +78,58 @@ namespace reshade
 		std::vector<size_t> shared;
 		bool loaded = false;
 
+		/// <summary>
+		/// Name of the only technique using this texture if its contents do not need to persist outside of that technique, so that it can share memory with textures of other techniques.
+		/// </summary>
+		std::string transient_technique;
+		/// <summary>
+		/// Set when the resource and views are owned by an entry in the transient texture pool, rather than this texture.
+		/// </summary>
+		bool transient_resource = false;
+
 		api::resource resource = {};
 		api::resource_view srv[2] = {};
 		api::resource_view rtv[2] = {};
 		std::vector<api::resource_view> uav;
 	};
 
+	/// <summary>
+	/// Texture resource that is shared by transient textures of different techniques.
+	/// </summary>
+	struct transient_texture_allocation
+	{
+		struct reference
+		{
+			std::string texture_name;
+			size_t effect_index;
+			std::string technique_name;
+		};
+
+		texture tex;
+		/// <summary>
+		/// Textures currently referencing this allocation. Each technique can only reference it once, since its textures may be alive at the same time.
+		/// </summary>
+		std::vector<reference> references;
+	};
+
+	/// <summary>
+	/// Entry point of an effect that was assembled in the background after the effect was loaded.
+	/// </summary>
+	struct assembled_entry_point
+	{
+		size_t effect_index;
+		size_t permutation_index;
+		/// <summary>
+		/// Code generator the entry point was assembled with, to identify results that belong to a previous version of the effect.
+		/// </summary>
+		std::shared_ptr<reshadefx::codegen> codegen;
+		std::string name;
+		std::string cso;
+		std::string assembly;
+		std::string errors;
+		bool success;
+	};
+
 	struct uniform : reshadefx::uniform
 	{
 		uniform(const reshadefx::uniform &init) : reshadefx::uniform(init) {}
@@ -127,6 +179,43 @@ namespace reshade
 		special_uniform special = special_uniform::none;
 	};
 
+	/// <summary>
+	/// Update of a special uniform variable that is executed every frame, with its annotations already decoded.
+	/// </summary>
+	struct special_uniform_update
+	{
+		enum class input_mode : uint8_t
+		{
+			down,
+			press,
+			toggle
+		};
+
+		special_uniform special = special_uniform::none;
+		/// <summary>
+		/// Whether values are stored as floating-point (rather than integer) in the uniform storage, which depends on the variable type and renderer.
+		/// </summary>
+		bool as_float = false;
+		bool is_signed = false;
+		bool is_boolean = false;
+		/// <summary>
+		/// Whether the variable is laid out contiguously in the uniform storage (i.e. is not an array or matrix), so that it can be accessed directly.
+		/// </summary>
+		bool direct = false;
+		input_mode mode = input_mode::down;
+		uint32_t uniform_index = 0;
+		uint32_t offset = 0;
+		uint32_t size = 0;
+
+		union
+		{
+			struct { int min, max; } random;
+			struct { float min, max, step_min, step_max, smoothing; } ping_pong;
+			struct { float min, max, step; } mouse_wheel;
+			struct { unsigned int keycode; } input;
+		};
+	};
+
 	struct technique
 	{
 		technique(const reshadefx::technique &init) :
@@ -192,8 +281,10 @@ namespace reshade
 			api::pipeline pipeline = {};
 			api::descriptor_table texture_table = {};
 			api::descriptor_table storage_table = {};
+			std::vector<api::resource> sampled_resources;
 			std::vector<api::resource> modified_resources;
 			std::vector<api::resource_view> generate_mipmap_views;
+			bool samples_back_buffer = false;
 
 			moving_average<uint64_t, 60> average_gpu_duration;
 		};
@@ -201,7 +292,12 @@ namespace reshade
 		struct permutation
 		{
 			std::vector<pass> passes;
+			uint32_t max_back_buffer_copies = 0;
 			bool created = false;
+			/// <summary>
+			/// Set once the pipelines of all passes were created, which is deferred until the technique is first enabled (see 'compile_technique').
+			/// </summary>
+			bool pipelines_created = false;
 		};
 
 		std::vector<permutation> permutations;
@@ -219,13 +315,31 @@ namespace reshade
 		bool compiled = false;
 		bool preprocessed = false;
 		std::string errors;
+		std::chrono::high_resolution_clock::duration load_duration = {};
+		std::chrono::high_resolution_clock::duration preprocess_duration = {};
+		std::chrono::high_resolution_clock::duration parse_duration = {};
+		std::chrono::high_resolution_clock::duration codegen_duration = {};
+		std::chrono::high_resolution_clock::duration assemble_duration = {};
+		std::chrono::high_resolution_clock::duration pipeline_duration = {};
 
 		std::vector<std::filesystem::path> included_files;
 		std::vector<std::pair<std::string, std::string>> definitions;
 
 		std::vector<uniform> uniforms;
 		std::vector<uint8_t> uniform_data_storage;
+		bool uniform_data_dirty = true;
+		std::vector<special_uniform_update> special_uniform_updates;
+
+		/// <summary>
+		/// Number of copies of the uniform storage the constant buffer holds when it is persistently mapped.
+		/// </summary>
+		static constexpr uint32_t num_cb_copies = 4;
+
 		api::resource cb = {};
+		uint8_t *cb_mapped = nullptr;
+		uint32_t cb_stride = 0;
+		uint32_t cb_index = 0;
+		uint64_t cb_reuse_frame[num_cb_copies] = {};
 
 		struct binding
 		{
@@ -243,8 +357,15 @@ namespace reshade
 			std::unordered_map<std::string, std::string> cso;
 			std::unordered_map<std::string, std::string> assembly;
 
+			/// <summary>
+			/// Code generator kept after loading as long as there are entry points that were not assembled yet, because none of the techniques using them were enabled.
+			/// </summary>
+			std::shared_ptr<reshadefx::codegen> codegen;
+			std::string entry_point_cache_id;
+			std::vector<std::string> assembling_entry_points;
+
 			api::pipeline_layout layout = {};
-			api::descriptor_table cb_table = {};
+			api::descriptor_table cb_tables[num_cb_copies] = {};
 			api::descriptor_table sampler_table = {};
 
 			std::vector<binding> texture_semantic_to_binding;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#include "thread_pool.hpp"
+#include <cassert>
+#include <algorithm> // std::find_if, std::max, std::min
+
+static thread_local const reshade::thread_pool *s_current_pool = nullptr;
+static thread_local size_t s_current_worker_index = 0;
+
+reshade::thread_pool::thread_pool(size_t num_threads) :
+	_num_threads(std::max<size_t>(num_threads, 1)),
+	_workers(_num_threads)
+{
+}
+reshade::thread_pool::~thread_pool()
+{
+	{	const std::lock_guard<std::mutex> lock(_wake_mutex);
+		_stop = true;
+	}
+	_wake_condition.notify_all();
+
+	for (worker &worker : _workers)
+		if (worker.thread.joinable())
+			worker.thread.join();
+
+	// All jobs should have been waited on before destroying the pool
+	assert(_unfinished_jobs == 0);
+}
+
+bool reshade::thread_pool::is_worker_thread() const
+{
+	return s_current_pool == this;
+}
+
+void reshade::thread_pool::submit(std::function<void()> job, group *group)
+{
+	std::call_once(_started, &thread_pool::start, this);
+
+	if (group != nullptr)
+		group->_pending++;
+	_unfinished_jobs++;
+
+	// Jobs submitted from a worker go into its own queue, to keep related work local, everything else is distributed round-robin
+	const size_t worker_index = is_worker_thread() ? s_current_worker_index : _next_worker++ % _num_threads;
+	{
+		worker &worker = _workers[worker_index];
+		const std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.queue.emplace_back(std::move(job), group);
+	}
+
+	{	const std::lock_guard<std::mutex> lock(_wake_mutex);
+		_queued_jobs++;
+	}
+	_wake_condition.notify_one();
+}
+
+void reshade::thread_pool::wait(group &group)
+{
+	if (is_worker_thread())
+	{
+		// Only help with jobs of the same group, to avoid nesting unrelated (and potentially long running) work on this stack
+		while (group._pending != 0)
+		{
+			if (try_execute_one(s_current_worker_index, &group))
+				continue;
+
+			// Remaining jobs of the group are running on other workers, so wait for them (with a timeout, in case they queue more jobs this worker could help with)
+			std::unique_lock<std::mutex> lock(_wake_mutex);
+			_finished_condition.wait_for(lock, std::chrono::milliseconds(1), [&group]() { return group._pending == 0; });
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_wake_mutex);
+	_finished_condition.wait(lock, [&group]() { return group._pending == 0; });
+}
+void reshade::thread_pool::wait_idle()
+{
+	assert(!is_worker_thread());
+
+	std::unique_lock<std::mutex> lock(_wake_mutex);
+	_finished_condition.wait(lock, [this]() { return _unfinished_jobs == 0; });
+}
+
+void reshade::thread_pool::parallel_for(size_t count, const std::function<void(size_t begin, size_t end)> &job, size_t min_chunk_size)
+{
+	min_chunk_size = std::max<size_t>(min_chunk_size, 1);
+
+	// Use a few more chunks than there are threads, so that idle workers can steal the remaining ones when some chunks take longer than others
+	const size_t num_chunks = std::min((count + min_chunk_size - 1) / min_chunk_size, (_num_threads + 1) * 2);
+	if (num_chunks <= 1)
+	{
+		if (count != 0)
+			job(0, count);
+		return;
+	}
+
+	group chunks;
+	for (size_t i = 1; i < num_chunks; ++i)
+		submit([&job, begin = count * i / num_chunks, end = count * (i + 1) / num_chunks]() { job(begin, end); }, &chunks);
+
+	job(0, count / num_chunks);
+
+	wait(chunks);
+}
+
+void reshade::thread_pool::start()
+{
+	for (size_t i = 0; i < _num_threads; ++i)
+		_workers[i].thread = std::thread(&thread_pool::thread_main, this, i);
+}
+
+void reshade::thread_pool::thread_main(size_t worker_index)
+{
+	s_current_pool = this;
+	s_current_worker_index = worker_index;
+
+	while (true)
+	{
+		if (try_execute_one(worker_index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(_wake_mutex);
+		_wake_condition.wait(lock, [this]() { return _stop || _queued_jobs != 0; });
+
+		if (_stop && _queued_jobs == 0)
+			break;
+	}
+}
+
+bool reshade::thread_pool::try_execute_one(size_t worker_index, const group *filter)
+{
+	std::pair<std::function<void()>, group *> job;
+
+	// Take from the own queue first, then try to steal from the other queues
+	// Always take the oldest job, so that jobs submitted first (the most expensive ones) are started first too
+	for (size_t i = 0; i < _num_threads && !job.first; ++i)
+	{
+		worker &worker = _workers[(worker_index + i) % _num_threads];
+		const std::lock_guard<std::mutex> lock(worker.mutex);
+
+		const auto job_it = filter == nullptr ? worker.queue.begin() : std::find_if(worker.queue.begin(), worker.queue.end(),
+			[filter](const std::pair<std::function<void()>, group *> &queued_job) { return queued_job.second == filter; });
+		if (job_it == worker.queue.end())
+			continue;
+
+		job = std::move(*job_it);
+		worker.queue.erase(job_it);
+	}
+
+	if (!job.first)
+		return false;
+
+	_queued_jobs--;
+
+	job.first();
+
+	// Update counters while holding the lock, so that waiting threads cannot miss the notification
+	{	const std::lock_guard<std::mutex> lock(_wake_mutex);
+		if (job.second != nullptr)
+			job.second->_pending--;
+		_unfinished_jobs--;
+	}
+	_finished_condition.notify_all();
+
+	return true;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// A persistent pool of worker threads with per-thread job queues.
+	/// Idle workers steal jobs from the queues of other workers, so that a worker which happens to receive a few expensive jobs does not hold up the rest.
+	/// </summary>
+	class thread_pool
+	{
+	public:
+		/// <summary>
+		/// A set of jobs that can be waited on together.
+		/// </summary>
+		class group
+		{
+			friend class thread_pool;
+
+			std::atomic<size_t> _pending = 0;
+		};
+
+		/// <summary>
+		/// Creates a new pool. The worker threads are only started once the first job is submitted.
+		/// </summary>
+		/// <param name="num_threads">Number of worker threads to use.</param>
+		explicit thread_pool(size_t num_threads);
+		~thread_pool();
+
+		/// <summary>
+		/// Gets the number of worker threads in this pool.
+		/// </summary>
+		size_t num_threads() const { return _num_threads; }
+
+		/// <summary>
+		/// Gets a boolean indicating whether the calling thread is a worker of this pool.
+		/// </summary>
+		bool is_worker_thread() const;
+
+		/// <summary>
+		/// Queues a job for execution on one of the worker threads.
+		/// Jobs are started roughly in submission order, so submit the most expensive jobs first.
+		/// </summary>
+		/// <param name="job">Function to execute.</param>
+		/// <param name="group">Optional group to add this job to.</param>
+		void submit(std::function<void()> job, group *group = nullptr);
+
+		/// <summary>
+		/// Blocks until all jobs in the specified <paramref name="group"/> have finished.
+		/// When called from a worker thread, this executes queued jobs of the group while waiting, so that jobs can wait on jobs they spawned without dead-locking the pool.
+		/// </summary>
+		void wait(group &group);
+		/// <summary>
+		/// Blocks until all jobs submitted to this pool have finished.
+		/// </summary>
+		void wait_idle();
+
+		/// <summary>
+		/// Splits the range from zero to <paramref name="count"/> into contiguous chunks, executes them on the worker threads and blocks until all have finished.
+		/// The calling thread executes one of the chunks itself, so this may also be called from a worker thread.
+		/// </summary>
+		/// <param name="count">Number of elements in the range.</param>
+		/// <param name="job">Function to execute for every chunk, with the first and one past the last element index of the chunk as arguments.</param>
+		/// <param name="min_chunk_size">Minimum number of elements per chunk, so that chunks are not too small to be worth distributing.</param>
+		void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)> &job, size_t min_chunk_size = 1);
+
+	private:
+		struct worker
+		{
+			std::mutex mutex;
+			std::deque<std::pair<std::function<void()>, group *>> queue;
+			std::thread thread;
+		};
+
+		void start();
+		void thread_main(size_t worker_index);
+		bool try_execute_one(size_t worker_index, const group *filter = nullptr);
+
+		const size_t _num_threads;
+		std::vector<worker> _workers;
+		std::once_flag _started;
+		std::atomic<bool> _stop = false;
+		std::atomic<size_t> _next_worker = 0;
+		std::atomic<size_t> _queued_jobs = 0;
+		std::atomic<size_t> _unfinished_jobs = 0;
+		std::mutex _wake_mutex;
+		std::condition_variable _wake_condition;
+		std::condition_variable _finished_condition;
+	};
+}
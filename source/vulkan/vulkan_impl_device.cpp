@@ -1387,6 +1387,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 	uint32_t max_attribute_size = 2 * sizeof(float); // Default triangle attributes
 	uint32_t max_recursion_depth = 1;
 	api::pipeline_flags flags = api::pipeline_flags::none;
+	api::pipeline_cache cache = { 0 };
 
 	for (uint32_t i = 0; i < subobject_count; ++i)
 	{
@@ -1524,6 +1525,10 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 			assert(subobjects[i].count == 1);
 			flags = *static_cast<const api::pipeline_flags *>(subobjects[i].data);
 			break;
+		case api::pipeline_subobject_type::pipeline_cache:
+			assert(subobjects[i].count == 1);
+			cache = *static_cast<const api::pipeline_cache *>(subobjects[i].data);
+			break;
 		default:
 			assert(false);
 			goto exit_failure;
@@ -1705,7 +1710,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateRayTracingPipelinesKHR(_orig, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateRayTracingPipelinesKHR(_orig, VK_NULL_HANDLE, (VkPipelineCache)cache.handle, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
 			*out_pipeline = { (uint64_t)object };
 			return true;
@@ -1729,6 +1734,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 {
 	api::shader_desc cs_desc = {};
 	api::pipeline_flags flags = api::pipeline_flags::none;
+	api::pipeline_cache cache = { 0 };
 	std::vector<pnext_link_restore> pnext_restore_links;
 
 	for (uint32_t i = 0; i < subobject_count; ++i)
@@ -1746,6 +1752,10 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 			assert(subobjects[i].count == 1);
 			flags = *static_cast<const api::pipeline_flags *>(subobjects[i].data);
 			break;
+		case api::pipeline_subobject_type::pipeline_cache:
+			assert(subobjects[i].count == 1);
+			cache = *static_cast<const api::pipeline_cache *>(subobjects[i].data);
+			break;
 		default:
 			assert(false);
 			goto exit_failure;
@@ -1769,7 +1779,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateComputePipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateComputePipelines(_orig, (VkPipelineCache)cache.handle, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
 			restore_pnext_links(pnext_restore_links);
 			*out_pipeline = { (uint64_t)object };
@@ -1808,6 +1818,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 	uint32_t viewport_count = 1;
 	std::vector<api::pipeline> libraries;
 	api::pipeline_flags flags = api::pipeline_flags::none;
+	api::pipeline_cache cache = { 0 };
 	std::vector<pnext_link_restore> pnext_restore_links;
 
 	for (uint32_t i = 0; i < subobject_count; ++i)
@@ -1899,6 +1910,10 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 			assert(subobjects[i].count == 1);
 			flags = *static_cast<const api::pipeline_flags *>(subobjects[i].data);
 			break;
+		case api::pipeline_subobject_type::pipeline_cache:
+			assert(subobjects[i].count == 1);
+			cache = *static_cast<const api::pipeline_cache *>(subobjects[i].data);
+			break;
 		default:
 			assert(false);
 			goto exit_failure;
@@ -2236,7 +2251,7 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 #endif
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateGraphicsPipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateGraphicsPipelines(_orig, (VkPipelineCache)cache.handle, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
 			restore_pnext_links(pnext_restore_links);
 
@@ -3069,6 +3084,36 @@ bool reshade::vulkan::device_impl::get_pipeline_shader_group_handles(api::pipeli
 #endif
 }
 
+bool reshade::vulkan::device_impl::create_pipeline_cache(const void *initial_data, size_t initial_data_size, api::pipeline_cache *out_cache)
+{
+	VkPipelineCacheCreateInfo create_info { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	create_info.initialDataSize = initial_data_size;
+	create_info.pInitialData = initial_data;
+
+	// Implementations validate the header of the initial data and ignore it if it was created by a different driver or device
+	if (VkPipelineCache object = VK_NULL_HANDLE;
+		vk.CreatePipelineCache(_orig, &create_info, nullptr, &object) == VK_SUCCESS)
+	{
+		*out_cache = { (uint64_t)object };
+		return true;
+	}
+	else
+	{
+		*out_cache = { 0 };
+		return false;
+	}
+}
+void reshade::vulkan::device_impl::destroy_pipeline_cache(api::pipeline_cache cache)
+{
+	vk.DestroyPipelineCache(_orig, (VkPipelineCache)cache.handle, nullptr);
+}
+bool reshade::vulkan::device_impl::get_pipeline_cache_data(api::pipeline_cache cache, size_t *out_size, void *out_data)
+{
+	assert(cache != 0 && out_size != nullptr);
+
+	return vk.GetPipelineCacheData(_orig, (VkPipelineCache)cache.handle, out_size, out_data) == VK_SUCCESS;
+}
+
 reshade::vulkan::command_list_immediate_impl *reshade::vulkan::device_impl::get_immediate_command_list()
 {
 	// Choosing the right queue is a delicate situation, since it is possible to deadlock when choosing a queue (and using 'flush') that is waiting on a fence yet to be signaled by the current thread
@@ -12,6 +12,7 @@
 #include <vk_mem_alloc.h>
 #pragma warning(pop)
 #include "reshade_api_object_impl.hpp"
+#include "lockfree_linear_map.hpp"
 #include <mutex>
 #include <shared_mutex>
 #include <vector>
@@ -25,6 +26,8 @@ namespace reshade::vulkan
 	class command_list_immediate_impl;
 	class command_queue_impl;
 
+#pragma warning(push)
+#pragma warning(disable: 4324) // Structure was padded due to alignment specifier (from the command buffer table)
 	class device_impl : public api::api_object_impl<VkDevice, api::device>
 	{
 		friend class command_list_impl;
@@ -109,6 +112,10 @@ namespace reshade::vulkan
 
 		bool get_pipeline_shader_group_handles(api::pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) final;
 
+		bool create_pipeline_cache(const void *initial_data, size_t initial_data_size, api::pipeline_cache *out_cache) final;
+		void destroy_pipeline_cache(api::pipeline_cache cache) final;
+		bool get_pipeline_cache_data(api::pipeline_cache cache, size_t *out_size, void *out_data) final;
+
 		command_list_immediate_impl *get_immediate_command_list();
 
 		template <VkObjectType type>
@@ -117,12 +124,16 @@ namespace reshade::vulkan
 			assert(object != VK_NULL_HANDLE);
 			uint64_t private_data = reinterpret_cast<uint64_t>(new object_data<type>(std::move(initial_data)));
 			_dispatch_table.SetPrivateData(_orig, type, (uint64_t)object, _private_data_slot, private_data);
+			if constexpr (type == VK_OBJECT_TYPE_COMMAND_BUFFER)
+				register_command_buffer(object, reinterpret_cast<object_data<type> *>(private_data));
 			return reinterpret_cast<object_data<type> *>(private_data);
 		}
 		template <VkObjectType type>
 		void register_object(typename object_data<type>::Handle object, object_data<type> *private_data)
 		{
 			_dispatch_table.SetPrivateData(_orig, type, (uint64_t)object, _private_data_slot, reinterpret_cast<uint64_t>(private_data));
+			if constexpr (type == VK_OBJECT_TYPE_COMMAND_BUFFER)
+				register_command_buffer(object, private_data);
 		}
 
 		template <VkObjectType type, bool destroy = true>
@@ -138,6 +149,9 @@ namespace reshade::vulkan
 				delete reinterpret_cast<object_data<type> *>(private_data);
 			}
 
+			if constexpr (type == VK_OBJECT_TYPE_COMMAND_BUFFER)
+				_command_buffer_table.erase(object);
+
 			_dispatch_table.SetPrivateData(_orig, type, (uint64_t)object, _private_data_slot, 0);
 		}
 
@@ -145,6 +159,10 @@ namespace reshade::vulkan
 		object_data<type> *get_private_data_for_object(typename object_data<type>::Handle object) const
 		{
 			assert(object != VK_NULL_HANDLE);
+			// Command buffers are looked up on every recorded command, so avoid calling into the driver for them
+			if constexpr (type == VK_OBJECT_TYPE_COMMAND_BUFFER)
+				if (object_data<type> *const private_data = _command_buffer_table.at(object))
+					return private_data;
 			uint64_t private_data = 0;
 			_dispatch_table.GetPrivateData(_orig, type, (uint64_t)object, _private_data_slot, &private_data);
 			assert(private_data != 0 || optional);
@@ -162,11 +180,22 @@ namespace reshade::vulkan
 	private:
 		bool create_descriptor_set_layout(const api::pipeline_layout_param &param, VkDescriptorSetLayout *out_set_layout, std::vector<VkSampler> &embedded_samplers);
 
+		void register_command_buffer(VkCommandBuffer object, object_data<VK_OBJECT_TYPE_COMMAND_BUFFER> *private_data)
+		{
+			// Handles may be reused by the driver without the previous object having been unregistered (e.g. when a command pool is destroyed), so remove any stale entry first
+			// Look ups in between fall back to the private data slot, which already holds the new value
+			_command_buffer_table.erase(object);
+			_command_buffer_table.emplace(object, private_data);
+		}
+
 		VmaAllocator _alloc = nullptr;
 		VkDescriptorPool _descriptor_pool = VK_NULL_HANDLE;
 		VkPrivateDataSlot _private_data_slot = VK_NULL_HANDLE;
+		// Side table for the private data of command buffers, falls back to the private data slot when the table is full
+		lockfree_linear_map<VkCommandBuffer, object_data<VK_OBJECT_TYPE_COMMAND_BUFFER> *, 8192> _command_buffer_table;
 
 		std::shared_mutex _mutex;
 		std::unordered_map<size_t, VkRenderPassBeginInfo> _render_pass_lookup;
 	};
+#pragma warning(pop)
 }
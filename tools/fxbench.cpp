@@ -0,0 +1,979 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#if !defined(_MSC_VER) && !defined(__declspec)
+// The add-on API headers use MSVC extensions in parts that are not needed for benchmarking event dispatch
+#define __declspec(x)
+#define __uuidof(x) (*static_cast<const x *>(nullptr))
+#endif
+
+#include "effect_lexer.hpp"
+#include "effect_parser.hpp"
+#include "effect_codegen.hpp"
+#include "effect_preprocessor.hpp"
+#include "format_conversion.hpp"
+#include "addon_manager.hpp"
+#include "reshade_api_object_impl.hpp"
+#include "lockfree_linear_map.hpp"
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options] <benchmark>
+
+Benchmarks:
+  lexer                     Tokenize the pre-processed input the same way the parser does.
+  preprocessor              Pre-process the input, including all files it includes.
+  spirv                     Generate and assemble SPIR-V code for a synthetic effect with a large number of constants.
+  conversion                Convert a 3840x2160 image between all formats supported for screenshots, with every instruction set the processor supports, then verify that they match the scalar implementation and that HDR encoding stays within 1 code value of the exact transfer functions.
+  addon                     Invoke add-on events with a recursion guard the way the effect runtime does for every technique, with callbacks of 8 add-ons registered (uses the size as number of invocations per iteration).
+  private_data              Store and retrieve private data of 4 different GUIDs on API objects, compared to the previous hash map storage (uses the size as number of objects).
+  lockfree_map              Look up present and missing keys in lock-free maps of different sizes and load, also after adding and removing many keys, then stress test concurrent look ups, additions and removals on multiple threads (uses the size as number of look ups per iteration).
+  hooks                     Call a replica of the Vulkan draw hook against a stub dispatch table, with and without a draw callback registered (uses the size as number of draws per iteration).
+
+Options:
+  -h, --help                Print this help.
+  -n <value>                Number of iterations to run (default 10).
+  --size <value>            Scale of the synthetic input (default 1000).
+  --input <path>            Use the specified effect file as input instead of a synthetic one (the file is not pre-processed for the spirv benchmark).
+	)", path);
+}
+
+// Add-on state usually provided by the add-on manager, which cannot be linked here since it depends on the operating system
+std::vector<reshade::addon_event_callback> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
+uint64_t reshade::addon_event_mask[(static_cast<uint32_t>(reshade::addon_event::max) + 63) / 64] = {};
+std::list<reshade::addon_info> reshade::addon_loaded_info;
+thread_local const reshade::addon_info *reshade::addon_current = nullptr;
+
+static std::string generate_constant_heavy_effect(unsigned int size)
+{
+	std::string source;
+	source.reserve(size * 256);
+
+	source += "float4 VS(uint id : SV_VertexID) : SV_Position { return float4(id == 2 ? 3.0 : -1.0, id == 1 ? -3.0 : 1.0, 0.0, 1.0); }\n";
+
+	// Every matrix and kernel weight is unique, so that none of the constants can be deduplicated
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		source += "static const float4x4 M" + std::to_string(i) + " = float4x4(";
+		for (unsigned int k = 0; k < 16; ++k)
+			source += (k != 0 ? ", " : "") + std::to_string(i * 16 + k) + ".5";
+		source += ");\n";
+	}
+
+	source += "float4 PS(float4 pos : SV_Position) : SV_Target\n{\n\tfloat4 result = 0.0;\n";
+	for (unsigned int i = 0; i < size; ++i)
+		source += "\tresult += mul(M" + std::to_string(i) + ", pos) * " + std::to_string(i) + ".25 + float4(" + std::to_string(i) + ", 1, 2, 3);\n";
+	source += "\treturn result;\n}\n";
+
+	source += "technique Benchmark { pass { VertexShader = VS; PixelShader = PS; } }\n";
+
+	return source;
+}
+
+static size_t count_spirv_instructions(const std::string &code)
+{
+	const uint32_t *const words = reinterpret_cast<const uint32_t *>(code.data());
+	const size_t num_words = code.size() / sizeof(uint32_t);
+
+	size_t num_instructions = 0;
+	// Skip the 5 word module header
+	for (size_t offset = 5; offset < num_words; ++num_instructions)
+	{
+		const uint32_t word_count = words[offset] >> 16;
+		if (word_count == 0)
+			break;
+		offset += word_count;
+	}
+
+	return num_instructions;
+}
+
+static bool preprocess(const std::filesystem::path &path, const std::string &source, std::string &output)
+{
+	reshadefx::preprocessor pp;
+	pp.add_include_path(path.empty() ? std::filesystem::current_path() : path.parent_path());
+
+	if (!(path.empty() ? pp.append_string(source) : pp.append_file(path)))
+	{
+		fputs(pp.errors().c_str(), stderr);
+		return false;
+	}
+
+	output = pp.output();
+	return true;
+}
+
+static int benchmark_preprocessor(unsigned int iterations, const std::filesystem::path &path, const std::string &source)
+{
+	std::string output;
+	std::chrono::high_resolution_clock::duration total_duration = {};
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		if (!preprocess(path, source, output))
+			return 1;
+
+		total_duration += std::chrono::high_resolution_clock::now() - time_started;
+	}
+
+	const double total_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(total_duration).count();
+
+	printf("preprocessor: %u iterations, %zu output bytes per iteration, %.3f ms per iteration, %.1f MB/s\n",
+		iterations, output.size(), total_seconds * 1000.0 / iterations, output.size() * iterations / total_seconds / 1e6);
+
+	return 0;
+}
+
+static int benchmark_lexer(unsigned int iterations, const std::string &source)
+{
+	size_t num_tokens = 0;
+	std::chrono::high_resolution_clock::duration total_duration = {};
+
+	// Share the same input between all iterations, so that only tokenization is measured
+	const std::shared_ptr<const std::string> input = std::make_shared<const std::string>(source);
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		// Use the same flags as the parser
+		reshadefx::lexer lexer(input);
+		while (lexer.lex().id != reshadefx::tokenid::end_of_file)
+			num_tokens++;
+
+		total_duration += std::chrono::high_resolution_clock::now() - time_started;
+	}
+
+	const double total_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(total_duration).count();
+
+	printf("lexer: %u iterations, %zu tokens per iteration, %.3f ms per iteration, %.1f MB/s, %.0f tokens/s\n",
+		iterations, num_tokens / iterations, total_seconds * 1000.0 / iterations, source.size() * iterations / total_seconds / 1e6, num_tokens / total_seconds);
+
+	return 0;
+}
+
+static int benchmark_spirv(unsigned int iterations, const std::string &source)
+{
+	size_t num_instructions = 0;
+	std::chrono::high_resolution_clock::duration total_duration = {};
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		const std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(true, false, false));
+
+		reshadefx::parser parser;
+		if (!parser.parse(source, codegen.get()))
+		{
+			fputs(parser.errors().c_str(), stderr);
+			return 1;
+		}
+
+		// SPIR-V has no intermediate text representation, so assemble every entry point to get the actual modules
+		std::vector<std::string> modules;
+		for (const std::pair<std::string, reshadefx::shader_type> &entry_point : codegen->module().entry_points)
+		{
+			std::string cso, assembly, errors;
+			if (!codegen->assemble_code_for_entry_point(entry_point.first, cso, assembly, errors))
+			{
+				fputs(errors.c_str(), stderr);
+				return 1;
+			}
+
+			modules.push_back(std::move(cso));
+		}
+
+		total_duration += std::chrono::high_resolution_clock::now() - time_started;
+
+		for (const std::string &code : modules)
+			num_instructions += count_spirv_instructions(code);
+	}
+
+	const double total_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(total_duration).count();
+
+	printf("spirv: %u iterations, %zu instructions per iteration, %.3f ms per iteration, %.0f instructions/s\n",
+		iterations, num_instructions / iterations, total_seconds * 1000.0 / iterations, num_instructions / total_seconds);
+
+	return 0;
+}
+
+static double half_to_double(uint16_t value)
+{
+	const int exponent = (value >> 10) & 0x1F;
+	const int mantissa = value & 0x3FF;
+	const double magnitude = exponent == 0 ? std::ldexp(mantissa, -24) : exponent == 31 ? INFINITY : std::ldexp(mantissa | 0x400, exponent - 25);
+	return (value & 0x8000) ? -magnitude : magnitude;
+}
+
+static bool verify_conversion()
+{
+	using namespace reshade;
+
+	// Odd number of pixels, so that the remainder loops of the vectorized kernels are covered too
+	const size_t num_pixels = 65536 + 7;
+
+	// Any bit pattern is valid for the integer formats
+	std::vector<uint32_t> source(num_pixels * 2);
+	std::mt19937 random_engine(42);
+	for (uint32_t &value : source)
+		value = random_engine();
+	std::vector<uint16_t> dest(num_pixels * 4), reference(num_pixels * 4);
+
+	const struct { api::format source_format, dest_format; const char *name; } conversions[] = {
+		{ api::format::r8_unorm, api::format::r8g8b8a8_unorm, "r8 -> rgba8" },
+		{ api::format::r8g8_unorm, api::format::r8g8b8a8_unorm, "rg8 -> rgba8" },
+		{ api::format::r8g8b8x8_unorm, api::format::r8g8b8a8_unorm, "rgbx8 -> rgba8" },
+		{ api::format::b8g8r8a8_unorm, api::format::r8g8b8a8_unorm, "bgra8 -> rgba8" },
+		{ api::format::b8g8r8x8_unorm, api::format::r8g8b8a8_unorm, "bgrx8 -> rgba8" },
+		{ api::format::r10g10b10a2_unorm, api::format::r8g8b8a8_unorm, "rgb10a2 -> rgba8" },
+		{ api::format::b10g10r10a2_unorm, api::format::r8g8b8a8_unorm, "bgr10a2 -> rgba8" },
+		{ api::format::r10g10b10a2_unorm, api::format::r16g16b16_unorm, "rgb10a2 -> rgb16" },
+		{ api::format::b10g10r10a2_unorm, api::format::r16g16b16_unorm, "bgr10a2 -> rgb16" },
+		{ api::format::r16g16b16a16_float, api::format::r16g16b16_float, "rgba16f -> rgb16f" },
+		{ api::format::b10g10r10a2_unorm, api::format::r10g10b10a2_unorm, "bgr10a2 -> rgb10a2" },
+	};
+	const char *const instruction_set_names[] = { "scalar", "sse2", "ssse3", "avx2" };
+
+	const format_conversion::instruction_set supported_instruction_set = format_conversion::get_instruction_set();
+
+	bool success = true;
+
+	// The vectorized kernels have to match the scalar ones exactly
+	for (const auto &conversion : conversions)
+	{
+		const size_t dest_size = num_pixels * api::format_row_pitch(conversion.dest_format, 1);
+
+		format_conversion::set_instruction_set(format_conversion::instruction_set::scalar);
+		format_conversion::convert(source.data(), conversion.source_format, reference.data(), conversion.dest_format, num_pixels);
+
+		for (int instruction_set = 1; instruction_set <= static_cast<int>(supported_instruction_set); ++instruction_set)
+		{
+			format_conversion::set_instruction_set(static_cast<format_conversion::instruction_set>(instruction_set));
+
+			std::memset(dest.data(), 0, dest_size);
+			format_conversion::convert(source.data(), conversion.source_format, dest.data(), conversion.dest_format, num_pixels);
+
+			size_t mismatches = 0;
+			for (size_t i = 0; i < dest_size; ++i)
+				mismatches += reinterpret_cast<const uint8_t *>(dest.data())[i] != reinterpret_cast<const uint8_t *>(reference.data())[i];
+
+			printf("conversion: %-22s %-7s %zu bytes differ from scalar\n", conversion.name, instruction_set_names[instruction_set], mismatches);
+			success &= mismatches == 0;
+		}
+	}
+
+	// Encode every 16-bit floating point value on the diagonal (including infinity, but not NaN) and random finite colors off of it
+	std::vector<uint16_t> scrgb(num_pixels * 3);
+	for (size_t i = 0; i < num_pixels; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			uint16_t value = static_cast<uint16_t>(i < 65536 ? i : random_engine());
+			if (i >= 65536 && (value & 0x7C00) == 0x7C00)
+				value &= 0xBFFF;
+			if ((value & 0x7C00) == 0x7C00 && (value & 0x3FF) != 0)
+				value &= 0xFC00;
+			scrgb[i * 3 + c] = value;
+		}
+	}
+
+	// BT.709 to BT.2020 primaries, the same single precision values the conversion uses, so that only the encoding is measured
+	const double bt709_to_bt2020[3][3] = {
+		{ 0.627403914928436279296875,      0.3292830288410186767578125,      0.0433130674064159393310546875 },
+		{ 0.069097287952899932861328125,   0.9195404052734375,               0.011362315155565738677978515625 },
+		{ 0.01639143936336040496826171875, 0.08801330626010894775390625,     0.895595252513885498046875 }
+	};
+
+	for (const format_conversion::transfer_function transfer : { format_conversion::transfer_function::pq, format_conversion::transfer_function::hlg })
+	{
+		// scRGB 1.0 is 80 nits, PQ 1.0 is 10000 nits and HLG is normalized to a nominal peak of 1000 nits
+		const double scale = transfer == format_conversion::transfer_function::pq ? 80.0 / 10000.0 : 80.0 / 1000.0;
+
+		for (size_t i = 0; i < num_pixels; ++i)
+		{
+			double rgb[3];
+			for (int c = 0; c < 3; ++c)
+				rgb[c] = half_to_double(scrgb[i * 3 + c]);
+
+			for (int c = 0; c < 3; ++c)
+			{
+				const double value = std::max(0.0, bt709_to_bt2020[c][0] * rgb[0] + bt709_to_bt2020[c][1] * rgb[1] + bt709_to_bt2020[c][2] * rgb[2]) * scale;
+				const double encoded = transfer == format_conversion::transfer_function::pq ? format_conversion::encode_pq(value) : format_conversion::encode_hlg(value);
+				reference[i * 3 + c] = static_cast<uint16_t>(std::lrint(encoded * 65535.0));
+			}
+		}
+
+		for (int instruction_set = 0; instruction_set <= static_cast<int>(supported_instruction_set); ++instruction_set)
+		{
+			format_conversion::set_instruction_set(static_cast<format_conversion::instruction_set>(instruction_set));
+
+			format_conversion::encode_scrgb_to_bt2100(scrgb.data(), dest.data(), num_pixels, transfer);
+
+			int max_error = 0;
+			for (size_t i = 0; i < num_pixels * 3; ++i)
+				max_error = std::max(max_error, std::abs(static_cast<int>(dest[i]) - static_cast<int>(reference[i])));
+
+			printf("conversion: %-22s %-7s maximum error of %d code value(s)\n",
+				transfer == format_conversion::transfer_function::pq ? "rgb16f -> rgb16 (pq)" : "rgb16f -> rgb16 (hlg)", instruction_set_names[instruction_set], max_error);
+			success &= max_error <= 1;
+		}
+	}
+
+	format_conversion::set_instruction_set(supported_instruction_set);
+
+	return success;
+}
+
+static int benchmark_conversion(unsigned int iterations)
+{
+	using namespace reshade;
+
+	const size_t num_pixels = 3840 * 2160;
+
+	// Fill with random finite 16-bit floating point values (which are also valid for all other formats), so that the transfer functions take all branches
+	std::vector<uint16_t> source(num_pixels * 4);
+	std::mt19937 random_engine(42);
+	for (uint16_t &value : source)
+		value = static_cast<uint16_t>(random_engine() & 0xBBFF);
+	std::vector<uint16_t> dest(num_pixels * 4);
+
+	// A destination format of "unknown" stands for encoding scRGB to BT.2100 with the specified transfer function
+	const struct { api::format source_format, dest_format; format_conversion::transfer_function transfer; const char *name; } conversions[] = {
+		{ api::format::r8_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "r8 -> rgba8" },
+		{ api::format::r8g8_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "rg8 -> rgba8" },
+		{ api::format::r8g8b8x8_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "rgbx8 -> rgba8" },
+		{ api::format::b8g8r8a8_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "bgra8 -> rgba8" },
+		{ api::format::b8g8r8x8_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "bgrx8 -> rgba8" },
+		{ api::format::r10g10b10a2_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "rgb10a2 -> rgba8" },
+		{ api::format::b10g10r10a2_unorm, api::format::r8g8b8a8_unorm, format_conversion::transfer_function::pq, "bgr10a2 -> rgba8" },
+		{ api::format::r10g10b10a2_unorm, api::format::r16g16b16_unorm, format_conversion::transfer_function::pq, "rgb10a2 -> rgb16" },
+		{ api::format::b10g10r10a2_unorm, api::format::r16g16b16_unorm, format_conversion::transfer_function::pq, "bgr10a2 -> rgb16" },
+		{ api::format::r16g16b16a16_float, api::format::r16g16b16_float, format_conversion::transfer_function::pq, "rgba16f -> rgb16f" },
+		{ api::format::b10g10r10a2_unorm, api::format::r10g10b10a2_unorm, format_conversion::transfer_function::pq, "bgr10a2 -> rgb10a2" },
+		{ api::format::r16g16b16_float, api::format::unknown, format_conversion::transfer_function::pq, "rgb16f -> rgb16 (pq)" },
+		{ api::format::r16g16b16_float, api::format::unknown, format_conversion::transfer_function::hlg, "rgb16f -> rgb16 (hlg)" },
+	};
+	const char *const instruction_set_names[] = { "scalar", "sse2", "ssse3", "avx2" };
+
+	const format_conversion::instruction_set supported_instruction_set = format_conversion::get_instruction_set();
+
+	for (const auto &conversion : conversions)
+	{
+		const size_t source_size = num_pixels * api::format_row_pitch(conversion.source_format, 1);
+
+		for (int instruction_set = 0; instruction_set <= static_cast<int>(supported_instruction_set); ++instruction_set)
+		{
+			format_conversion::set_instruction_set(static_cast<format_conversion::instruction_set>(instruction_set));
+
+			std::chrono::high_resolution_clock::duration total_duration = {};
+
+			for (unsigned int i = 0; i < iterations; ++i)
+			{
+				const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+				if (conversion.dest_format == api::format::unknown)
+					format_conversion::encode_scrgb_to_bt2100(source.data(), dest.data(), num_pixels, conversion.transfer);
+				else
+					format_conversion::convert(source.data(), conversion.source_format, dest.data(), conversion.dest_format, num_pixels);
+
+				total_duration += std::chrono::high_resolution_clock::now() - time_started;
+			}
+
+			const double total_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(total_duration).count();
+
+			printf("conversion: %-22s %-7s %.3f ms per iteration, %.1f MB/s\n",
+				conversion.name, instruction_set_names[instruction_set], total_seconds * 1000.0 / iterations, source_size * iterations / total_seconds / 1e6);
+		}
+	}
+
+	format_conversion::set_instruction_set(supported_instruction_set);
+
+	return verify_conversion() ? 0 : 1;
+}
+
+static unsigned int s_addon_callback_invocations = 0;
+
+static void on_reshade_render_technique(reshade::api::effect_runtime *runtime, reshade::api::effect_technique technique, reshade::api::command_list *cmd_list, reshade::api::resource_view rtv, reshade::api::resource_view rtv_srgb)
+{
+	s_addon_callback_invocations++;
+
+	// Recursive invocations from within a callback are skipped for the add-on that is currently executing
+	if (technique.handle == 0)
+		reshade::invoke_addon_event<reshade::addon_event::reshade_render_technique>(runtime, reshade::api::effect_technique { 1 }, cmd_list, rtv, rtv_srgb);
+}
+static bool on_reshade_set_technique_state(reshade::api::effect_runtime *, reshade::api::effect_technique, bool)
+{
+	s_addon_callback_invocations++;
+	return false;
+}
+
+static int benchmark_addon(unsigned int iterations, unsigned int size)
+{
+	using namespace reshade;
+
+	// Register callbacks the same way 'ReShadeRegisterEventForAddon' does
+	const unsigned int num_addons = 8;
+	for (unsigned int i = 0; i < num_addons; ++i)
+	{
+		addon_info &info = addon_loaded_info.emplace_back();
+		info.name = "Add-on " + std::to_string(i);
+
+		addon_event_list[static_cast<uint32_t>(addon_event::reshade_render_technique)].push_back({ reinterpret_cast<void *>(&on_reshade_render_technique), &info });
+		addon_event_list[static_cast<uint32_t>(addon_event::reshade_set_technique_state)].push_back({ reinterpret_cast<void *>(&on_reshade_set_technique_state), &info });
+	}
+
+	std::chrono::high_resolution_clock::duration total_duration[2] = {};
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int k = 0; k < size; ++k)
+			invoke_addon_event<addon_event::reshade_render_technique>(nullptr, api::effect_technique { k & 1 }, nullptr, api::resource_view { 0 }, api::resource_view { 0 });
+
+		total_duration[0] += std::chrono::high_resolution_clock::now() - time_started;
+		time_started = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int k = 0; k < size; ++k)
+			invoke_addon_event<addon_event::reshade_set_technique_state>(nullptr, api::effect_technique { k }, (k & 1) != 0);
+
+		total_duration[1] += std::chrono::high_resolution_clock::now() - time_started;
+	}
+
+	const char *const event_names[] = { "reshade_render_technique", "reshade_set_technique_state" };
+	for (int event_index = 0; event_index < 2; ++event_index)
+	{
+		printf("addon: %-28s %.1f ns per invocation\n",
+			event_names[event_index], std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(total_duration[event_index]).count() / (static_cast<double>(iterations) * size));
+	}
+	printf("addon: %u callback invocations\n", s_addon_callback_invocations);
+
+	for (std::vector<addon_event_callback> &event_list : addon_event_list)
+		event_list.clear();
+	addon_loaded_info.clear();
+
+	return 0;
+}
+
+// Stand-ins for a dispatchable Vulkan handle and the device dispatch table, so that the overhead of the hooks can be measured without a driver
+struct stub_command_buffer_t
+{
+	void *dispatch_key;
+};
+typedef stub_command_buffer_t *stub_command_buffer;
+
+struct stub_device
+{
+	void(*CmdDraw)(stub_command_buffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+	void(*GetPrivateData)(const stub_device *device, stub_command_buffer object, uint64_t *pData);
+
+	// Drivers implement private data for dispatchable handles with a locked hash table or similar
+	mutable std::shared_mutex private_data_mutex;
+	std::unordered_map<stub_command_buffer, uint64_t> private_data;
+
+	lockfree_linear_map<stub_command_buffer, reshade::api::command_list *, 8192> command_buffer_table;
+};
+
+static lockfree_linear_map<void *, stub_device *, 8> s_stub_devices;
+static unsigned int s_stub_draw_calls = 0;
+
+static void stub_driver_cmd_draw(stub_command_buffer, uint32_t vertexCount, uint32_t, uint32_t, uint32_t)
+{
+	s_stub_draw_calls += vertexCount;
+}
+static void stub_driver_get_private_data(const stub_device *device, stub_command_buffer object, uint64_t *pData)
+{
+	const std::shared_lock<std::shared_mutex> lock(device->private_data_mutex);
+	const auto it = device->private_data.find(object);
+	*pData = it != device->private_data.end() ? it->second : 0;
+}
+
+static void on_draw(reshade::api::command_list *, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+	s_addon_callback_invocations++;
+}
+
+// Same structure as 'vkCmdDraw' in 'vulkan_hooks_command_list.cpp' before and after checking for registered callbacks and using the command buffer side table
+static void stub_vkCmdDraw_private_data(stub_command_buffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	stub_device *const device_impl = s_stub_devices.at(commandBuffer->dispatch_key);
+
+	uint64_t private_data = 0;
+	device_impl->GetPrivateData(device_impl, commandBuffer, &private_data);
+	reshade::api::command_list *const cmd_impl = reinterpret_cast<reshade::api::command_list *>(private_data);
+
+	if (reshade::invoke_addon_event<reshade::addon_event::draw>(cmd_impl, vertexCount, instanceCount, firstVertex, firstInstance))
+		return;
+
+	device_impl->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+static void stub_vkCmdDraw(stub_command_buffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	stub_device *const device_impl = s_stub_devices.at(commandBuffer->dispatch_key);
+
+	if (reshade::has_addon_event<reshade::addon_event::draw>())
+	{
+		reshade::api::command_list *cmd_impl = device_impl->command_buffer_table.at(commandBuffer);
+		if (cmd_impl == nullptr)
+		{
+			uint64_t private_data = 0;
+			device_impl->GetPrivateData(device_impl, commandBuffer, &private_data);
+			cmd_impl = reinterpret_cast<reshade::api::command_list *>(private_data);
+		}
+
+		if (reshade::invoke_addon_event<reshade::addon_event::draw>(cmd_impl, vertexCount, instanceCount, firstVertex, firstInstance))
+			return;
+	}
+
+	device_impl->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+static int benchmark_hooks(unsigned int iterations, unsigned int size)
+{
+	using namespace reshade;
+
+	void *const dispatch_key = &s_stub_devices;
+	const auto device = std::make_unique<stub_device>();
+	device->CmdDraw = &stub_driver_cmd_draw;
+	device->GetPrivateData = &stub_driver_get_private_data;
+	s_stub_devices.emplace(dispatch_key, device.get());
+
+	// Spread draws across several command buffers, like an application recording on multiple threads would
+	std::vector<stub_command_buffer_t> command_buffers(64, stub_command_buffer_t { dispatch_key });
+	for (stub_command_buffer_t &cmd : command_buffers)
+	{
+		const uint64_t private_data = reinterpret_cast<uint64_t>(&cmd);
+		device->private_data.emplace(&cmd, private_data);
+		device->command_buffer_table.emplace(&cmd, reinterpret_cast<reshade::api::command_list *>(private_data));
+	}
+
+	// Call through a pointer, the same way the application would call into the hooks
+	void(*volatile hooks[2])(stub_command_buffer, uint32_t, uint32_t, uint32_t, uint32_t) = { &stub_vkCmdDraw_private_data, &stub_vkCmdDraw };
+
+	addon_info info;
+	info.name = "Add-on";
+
+	std::chrono::high_resolution_clock::duration total_duration[2][2] = {};
+
+	for (int listeners = 0; listeners < 2; ++listeners)
+	{
+		if (listeners != 0)
+		{
+			// Register callbacks the same way 'ReShadeRegisterEventForAddon' does
+			addon_event_list[static_cast<uint32_t>(addon_event::draw)].push_back({ reinterpret_cast<void *>(&on_draw), &info });
+			addon_event_mask[static_cast<uint32_t>(addon_event::draw) / 64] |= (1ull << (static_cast<uint32_t>(addon_event::draw) % 64));
+		}
+
+		for (unsigned int i = 0; i < iterations; ++i)
+		{
+			for (int hook_index = 0; hook_index < 2; ++hook_index)
+			{
+				const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+				for (unsigned int k = 0; k < size; ++k)
+					hooks[hook_index](&command_buffers[k % command_buffers.size()], 3, 1, 0, 0);
+
+				total_duration[listeners][hook_index] += std::chrono::high_resolution_clock::now() - time_started;
+			}
+		}
+	}
+
+	const char *const hook_names[] = { "private data", "side table" };
+	for (int listeners = 0; listeners < 2; ++listeners)
+	{
+		for (int hook_index = 0; hook_index < 2; ++hook_index)
+		{
+			printf("hooks: %-13s %-12s %.1f ns per draw\n",
+				listeners != 0 ? "1 listener" : "no listeners", hook_names[hook_index], std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(total_duration[listeners][hook_index]).count() / (static_cast<double>(iterations) * size));
+		}
+	}
+	printf("hooks: %u vertices drawn, %u callback invocations\n", s_stub_draw_calls, s_addon_callback_invocations);
+
+	addon_event_list[static_cast<uint32_t>(addon_event::draw)].clear();
+	addon_event_mask[static_cast<uint32_t>(addon_event::draw) / 64] &= ~(1ull << (static_cast<uint32_t>(addon_event::draw) % 64));
+	s_stub_devices.erase(dispatch_key);
+
+	return 0;
+}
+
+// Object with the private data storage all API objects share
+class bench_object : public reshade::api::api_object_impl<uint64_t, reshade::api::api_object>
+{
+public:
+	explicit bench_object(uint64_t orig) : api_object_impl(orig) {}
+};
+
+// Object storing private data in a hash map the way API objects used to, for comparison
+class bench_object_hash_map : public reshade::api::api_object
+{
+	using guid_t = reshade::api::private_data_slots::guid_t;
+
+public:
+	explicit bench_object_hash_map(uint64_t orig) : _orig(orig) {}
+
+	uint64_t get_native() const final { return _orig; }
+
+	void get_private_data(const uint8_t guid[16], uint64_t *data) const final
+	{
+		if (const auto it = _private_data.find(*reinterpret_cast<const guid_t *>(guid));
+			it != _private_data.end())
+			*data = it->second;
+		else
+			*data = 0;
+	}
+	void set_private_data(const uint8_t guid[16], const uint64_t data) final
+	{
+		if (data != 0)
+			_private_data[*reinterpret_cast<const guid_t *>(guid)] = data;
+		else
+			_private_data.erase(*reinterpret_cast<const guid_t *>(guid));
+	}
+
+private:
+	uint64_t _orig;
+	std::unordered_map<guid_t, uint64_t, guid_t::hash, guid_t::equal> _private_data;
+};
+
+template <typename T>
+static void benchmark_private_data(unsigned int iterations, unsigned int size, const uint8_t(&guids)[4][16], std::chrono::high_resolution_clock::duration(&total_duration)[3])
+{
+	std::vector<std::unique_ptr<reshade::api::api_object>> objects(size);
+	uint64_t checksum = 0;
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int k = 0; k < size; ++k)
+			objects[k] = std::make_unique<T>(k);
+
+		total_duration[0] += std::chrono::high_resolution_clock::now() - time_started;
+		time_started = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int k = 0; k < size; ++k)
+			for (const uint8_t(&guid)[16] : guids)
+				objects[k]->set_private_data(guid, k + 1);
+
+		total_duration[1] += std::chrono::high_resolution_clock::now() - time_started;
+		time_started = std::chrono::high_resolution_clock::now();
+
+		// Add-ons typically look up their data on every draw call
+		for (unsigned int k = 0; k < size; ++k)
+		{
+			for (const uint8_t(&guid)[16] : guids)
+			{
+				uint64_t data = 0;
+				objects[k]->get_private_data(guid, &data);
+				checksum += data;
+			}
+		}
+
+		total_duration[2] += std::chrono::high_resolution_clock::now() - time_started;
+
+		for (unsigned int k = 0; k < size; ++k)
+			for (const uint8_t(&guid)[16] : guids)
+				objects[k]->set_private_data(guid, 0);
+
+		objects.clear();
+		objects.resize(size);
+	}
+
+	if (checksum != static_cast<uint64_t>(iterations) * 4 * (static_cast<uint64_t>(size) * (size + 1) / 2))
+		fprintf(stderr, "error: private data checksum mismatch\n");
+}
+
+static int benchmark_private_data(unsigned int iterations, unsigned int size)
+{
+	const uint8_t guids[4][16] = {
+		{ 0x43, 0x31, 0x9e, 0x83, 0x38, 0x7c, 0x44, 0x8e, 0x88, 0x1c, 0x7e, 0x68, 0xfc, 0x2e, 0x52, 0xc4 },
+		{ 0x0e, 0x2f, 0x4a, 0x31, 0x8a, 0x47, 0x4e, 0x1c, 0x9b, 0x56, 0x3d, 0x5c, 0x2b, 0x3f, 0x9e, 0x71 },
+		{ 0x7a, 0x0d, 0x91, 0xc2, 0x55, 0x1e, 0x4b, 0x3a, 0xa1, 0x08, 0x6f, 0xe4, 0x90, 0x17, 0x2d, 0x5b },
+		{ 0xb8, 0x64, 0x2c, 0x0f, 0xd3, 0x29, 0x41, 0x77, 0x8e, 0xca, 0x15, 0x36, 0x4d, 0x80, 0xf1, 0x9a },
+	};
+
+	std::chrono::high_resolution_clock::duration total_duration[2][3] = {};
+	benchmark_private_data<bench_object_hash_map>(iterations, size, guids, total_duration[0]);
+	benchmark_private_data<bench_object>(iterations, size, guids, total_duration[1]);
+
+	const char *const storage_names[] = { "hash map", "slots" };
+	for (int storage_index = 0; storage_index < 2; ++storage_index)
+	{
+		const auto to_ns = [&](std::chrono::high_resolution_clock::duration duration, unsigned int count) {
+			return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(duration).count() / (static_cast<double>(iterations) * size * count);
+		};
+
+		printf("private_data: %-8s %.1f ns per object creation, %.1f ns per set, %.1f ns per get\n",
+			storage_names[storage_index], to_ns(total_duration[storage_index][0], 1), to_ns(total_duration[storage_index][1], 4), to_ns(total_duration[storage_index][2], 4));
+	}
+
+	return 0;
+}
+
+template <uint32_t MAX_ENTRIES>
+static void benchmark_lockfree_map(unsigned int iterations, unsigned int size, uint32_t num_keys)
+{
+	const auto map = std::make_unique<lockfree_linear_map<void *, void *, MAX_ENTRIES>>();
+
+	// Keys are dispatch table pointers or handles in practice, which are aligned addresses
+	std::vector<void *> keys(num_keys * 2);
+	for (size_t i = 0; i < keys.size(); ++i)
+		keys[i] = reinterpret_cast<void *>(0x7ff6a0000000ull + i * 0x2a40);
+	for (uint32_t i = 0; i < num_keys; ++i)
+		map->emplace(keys[i], keys[i]);
+
+	std::chrono::high_resolution_clock::duration total_duration[2] = {};
+	size_t found = 0;
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (int missing = 0; missing < 2; ++missing)
+		{
+			const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+			for (unsigned int k = 0; k < size; ++k)
+				found += map->at(keys[(missing ? num_keys : 0) + k % num_keys]) != nullptr;
+
+			total_duration[missing] += std::chrono::high_resolution_clock::now() - time_started;
+		}
+	}
+
+	if (found != static_cast<size_t>(iterations) * size)
+		fprintf(stderr, "error: lock-free map look up results are wrong\n");
+
+	printf("lockfree_map: %4u entries, %4u keys: %.1f ns per hit, %.1f ns per miss\n",
+		MAX_ENTRIES, num_keys,
+		std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(total_duration[0]).count() / (static_cast<double>(iterations) * size),
+		std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(total_duration[1]).count() / (static_cast<double>(iterations) * size));
+}
+
+template <uint32_t MAX_ENTRIES>
+static void benchmark_lockfree_map_churn(unsigned int iterations, unsigned int size, uint32_t num_keys)
+{
+	const auto map = std::make_unique<lockfree_linear_map<void *, void *, MAX_ENTRIES>>();
+
+	// Command buffers are allocated and freed all the time, with new handles each time, so keep adding and removing different keys
+	const unsigned int num_rounds = 1000;
+	uintptr_t next_key = 0x7ff6a0000000ull;
+	std::vector<void *> keys(num_keys);
+
+	std::chrono::high_resolution_clock::duration total_duration = {};
+	size_t errors = 0;
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (unsigned int round = 0; round < num_rounds; ++round)
+		{
+			for (void *&key : keys)
+			{
+				key = reinterpret_cast<void *>(next_key += 0x2a40);
+				if (!map->emplace(key, key))
+					errors++;
+			}
+			for (void *const key : keys)
+				if (map->erase(key) != key)
+					errors++;
+		}
+
+		// Measure misses after the churn, which have to probe through all entries that were erased but not emptied again
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int k = 0; k < size; ++k)
+			errors += map->at(reinterpret_cast<void *>(next_key + (k + 1) * 0x2a40)) != nullptr;
+
+		total_duration += std::chrono::high_resolution_clock::now() - time_started;
+	}
+
+	if (errors != 0)
+		fprintf(stderr, "error: lock-free map additions, removals or look ups failed %zu times\n", errors);
+
+	printf("lockfree_map: %4u entries, %4u keys added and removed %u times: %.1f ns per miss\n",
+		MAX_ENTRIES, num_keys, num_rounds * iterations,
+		std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(total_duration).count() / (static_cast<double>(iterations) * size));
+}
+
+template <uint32_t MAX_ENTRIES>
+static bool stress_test_lockfree_map(unsigned int iterations, unsigned int num_threads, uint32_t num_permanent_keys, uint32_t num_keys_per_thread)
+{
+	const auto map = std::make_unique<lockfree_linear_map<uintptr_t, uintptr_t *, MAX_ENTRIES>>();
+	std::atomic<size_t> errors = 0;
+
+	// These keys are never removed, so must be found at all times, even while other keys in the same probe sequence are erased and added again
+	for (uintptr_t key = 1; key <= num_permanent_keys; ++key)
+		map->emplace(key << 4, reinterpret_cast<uintptr_t *>(key));
+
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back([&map, &errors, iterations, t, num_permanent_keys, num_keys_per_thread]() {
+			std::vector<uintptr_t> keys(num_keys_per_thread);
+			for (unsigned int i = 0; i < iterations; ++i)
+			{
+				for (uint32_t k = 0; k < num_keys_per_thread; ++k)
+				{
+					keys[k] = (((static_cast<uintptr_t>(t) + 1) << 24) | ((i & 0xFFFF) << 8) | k) << 4;
+					if (!map->emplace(keys[k], reinterpret_cast<uintptr_t *>(keys[k])))
+						errors++;
+				}
+
+				for (uintptr_t key = 1; key <= num_permanent_keys; ++key)
+					if (map->at(key << 4) != reinterpret_cast<uintptr_t *>(key))
+						errors++;
+				for (uint32_t k = 0; k < num_keys_per_thread; ++k)
+					if (map->at(keys[k]) != reinterpret_cast<uintptr_t *>(keys[k]))
+						errors++;
+
+				for (uint32_t k = 0; k < num_keys_per_thread; ++k)
+					if (map->erase(keys[k]) != reinterpret_cast<uintptr_t *>(keys[k]) || map->at(keys[k]) != nullptr)
+						errors++;
+			}
+		});
+	}
+
+	for (std::thread &thread : threads)
+		thread.join();
+
+	for (uintptr_t key = 1; key <= num_permanent_keys; ++key)
+		if (map->erase(key << 4) != reinterpret_cast<uintptr_t *>(key))
+			errors++;
+
+	printf("lockfree_map: %4u entries, %2u threads: %zu errors\n", MAX_ENTRIES, num_threads, errors.load());
+
+	return errors == 0;
+}
+
+static int benchmark_lockfree_map(unsigned int iterations, unsigned int size)
+{
+	// Typical use of 'g_vulkan_devices', 'g_vulkan_instances' and the OpenXR maps with a single or a few objects alive
+	benchmark_lockfree_map<8>(iterations, size, 1);
+	benchmark_lockfree_map<16>(iterations, size, 4);
+	benchmark_lockfree_map<64>(iterations, size, 32);
+	benchmark_lockfree_map<4096>(iterations, size, 2048);
+	// Typical use of the command buffer side table of the Vulkan device
+	benchmark_lockfree_map_churn<8192>(iterations, size, 256);
+
+	// Use more threads than there are processors on small machines too, so that operations are interleaved at random points
+	const unsigned int num_threads = 8;
+
+	bool success = true;
+	success &= stress_test_lockfree_map<16>(iterations * 1000, num_threads, 4, 1);
+	success &= stress_test_lockfree_map<64>(iterations * 1000, num_threads, 8, 3);
+	success &= stress_test_lockfree_map<4096>(iterations * 50, num_threads, 512, 64);
+
+	return success ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *benchmark_name = nullptr;
+	const char *input_file = nullptr;
+	unsigned int iterations = 10;
+	unsigned int size = 1000;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		if (const char *arg = argv[i]; arg[0] == '-')
+		{
+			if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+			{
+				print_usage(argv[0]);
+				return 0;
+			}
+			else if (0 == std::strcmp(arg, "-n") && i + 1 < argc)
+			{
+				iterations = std::strtoul(argv[++i], nullptr, 10);
+			}
+			else if (0 == std::strcmp(arg, "--size") && i + 1 < argc)
+			{
+				size = std::strtoul(argv[++i], nullptr, 10);
+			}
+			else if (0 == std::strcmp(arg, "--input") && i + 1 < argc)
+			{
+				input_file = argv[++i];
+			}
+			else
+			{
+				print_usage(argv[0]);
+				return 1;
+			}
+		}
+		else
+		{
+			benchmark_name = arg;
+		}
+	}
+
+	if (benchmark_name == nullptr || iterations == 0)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	// Does not need any effect source
+	if (0 == std::strcmp(benchmark_name, "conversion"))
+		return benchmark_conversion(iterations);
+	if (0 == std::strcmp(benchmark_name, "addon"))
+		return benchmark_addon(iterations, size);
+	if (0 == std::strcmp(benchmark_name, "private_data"))
+		return benchmark_private_data(iterations, size);
+	if (0 == std::strcmp(benchmark_name, "lockfree_map"))
+		return benchmark_lockfree_map(iterations, size);
+	if (0 == std::strcmp(benchmark_name, "hooks"))
+		return benchmark_hooks(iterations, size);
+
+	std::string source;
+	if (input_file != nullptr)
+	{
+		std::ifstream file(input_file);
+		if (!file)
+		{
+			fprintf(stderr, "error: could not open input file '%s'\n", input_file);
+			return 1;
+		}
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		source = stream.str();
+	}
+	else
+	{
+		source = generate_constant_heavy_effect(size);
+	}
+
+	const std::filesystem::path input_path = input_file != nullptr ? std::filesystem::u8path(input_file) : std::filesystem::path();
+
+	if (0 == std::strcmp(benchmark_name, "preprocessor"))
+		return benchmark_preprocessor(iterations, input_path, source);
+	if (0 == std::strcmp(benchmark_name, "lexer"))
+	{
+		std::string output;
+		if (!preprocess(input_path, source, output))
+			return 1;
+
+		return benchmark_lexer(iterations, output);
+	}
+	if (0 == std::strcmp(benchmark_name, "spirv"))
+		return benchmark_spirv(iterations, source);
+
+	print_usage(argv[0]);
+	return 1;
+}
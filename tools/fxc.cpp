@@ -6,10 +6,63 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
+#include "effect_cache_index.hpp"
 #include "version.h"
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <spirv.hpp>
+
+static void print_spirv_module_report(const char *entry_point_name, const std::basic_string<char> &code)
+{
+	const uint32_t *const words = reinterpret_cast<const uint32_t *>(code.data());
+	const size_t num_words = code.size() / sizeof(uint32_t);
+
+	size_t num_instructions = 0;
+	size_t num_functions = 0;
+	size_t num_types_and_constants = 0;
+	// Skip the 5 word module header
+	for (size_t offset = 5; offset < num_words; ++num_instructions)
+	{
+		const uint32_t word_count = words[offset] >> spv::WordCountShift;
+		if (word_count == 0)
+			break;
+
+		switch (words[offset] & spv::OpCodeMask)
+		{
+		case spv::OpFunction:
+			num_functions++;
+			break;
+		case spv::OpTypeVoid:
+		case spv::OpTypeBool:
+		case spv::OpTypeInt:
+		case spv::OpTypeFloat:
+		case spv::OpTypeVector:
+		case spv::OpTypeMatrix:
+		case spv::OpTypeImage:
+		case spv::OpTypeSampledImage:
+		case spv::OpTypeArray:
+		case spv::OpTypeStruct:
+		case spv::OpTypePointer:
+		case spv::OpTypeFunction:
+		case spv::OpConstantTrue:
+		case spv::OpConstantFalse:
+		case spv::OpConstant:
+		case spv::OpConstantComposite:
+		case spv::OpConstantNull:
+		case spv::OpSpecConstantTrue:
+		case spv::OpSpecConstantFalse:
+		case spv::OpSpecConstant:
+		case spv::OpSpecConstantComposite:
+			num_types_and_constants++;
+			break;
+		}
+
+		offset += word_count;
+	}
+
+	std::cerr << entry_point_name << ": " << code.size() << " bytes, " << num_instructions << " instructions, " << num_functions << " functions, " << num_types_and_constants << " types and constants" << std::endl;
+}
 
 static void print_usage(const char *path)
 {
@@ -23,13 +76,15 @@ Options:
   -I <path>                 Add directory to include search path.
   -P <path>                 Pre-process to file. If <path> is "-", then result is written to standard output instead.
 
-  -E <name>                 Optional entry point name to assemble code for that specific entry point.
+  -E <name>                 Optional entry point name to assemble code for that specific entry point. With --spirv, also prints a report of the module size.
   -Od                       Disable optimization.
   -O{0,1,2,3}               Optimization level (only applies to DXBC code generation).
   -Zi                       Enable debug information.
 
   -Fo <path>                Output generated code to a specific file.
   -Fe <path>                Output warnings and errors to a specific file.
+  --cache-index <path>      Record the files and macros the effect depends on in the specified effect cache index and skip compilation if none of them changed since the output file was written.
+                            This index is only used by this compiler and cannot pre-warm the effect cache of the runtime, since the runtime keys its entries on properties of the device and application.
 
   --dxbc                    Generate DXBC code.
   --hlsl                    Generate HLSL code (default).
@@ -52,6 +107,7 @@ int main(int argc, char *argv[])
 	const char *error_file = nullptr;
 	const char *output_file = nullptr;
 	const char *entry_point_name = nullptr;
+	const char *cache_index_file = nullptr;
 	const char *buffer_width = "800";
 	const char *buffer_height = "600";
 	bool generate_dxbc = false;
@@ -141,6 +197,8 @@ int main(int argc, char *argv[])
 				buffer_width = argv[++i];
 			else if (0 == std::strcmp(arg, "--height"))
 				buffer_height = argv[++i];
+			else if (0 == std::strcmp(arg, "--cache-index"))
+				cache_index_file = argv[++i];
 		}
 		else
 		{
@@ -181,6 +239,26 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
+	// Identify this invocation by all its arguments, so that the same effect compiled with different options gets a separate entry in the cache index
+	// These keys intentionally do not match those of the runtime, which include the renderer, vendor, device, application and back buffer dimensions that are unknown here
+	std::string cache_index_key;
+	for (int i = 1; i < argc; ++i)
+		cache_index_key += std::string(argv[i]) + ';';
+	cache_index_key = std::to_string(std::hash<std::string>()(cache_index_key));
+
+	reshadefx::effect_cache_index cache_index;
+	if (cache_index_file != nullptr && output_file != nullptr && cache_index.load(cache_index_file))
+	{
+		std::error_code ec;
+		size_t dependencies_hash = 0;
+		if (cache_index.validate(cache_index_key, dependencies_hash) && std::filesystem::exists(output_file, ec))
+		{
+			if (cache_index.is_modified())
+				cache_index.save(cache_index_file);
+			return 0; // Output is up to date
+		}
+	}
+
 	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
 	pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "0");
 	pp.add_macro_definition("BUFFER_WIDTH", buffer_width);
@@ -246,9 +324,24 @@ int main(int argc, char *argv[])
 		code = backend->finalize_code();
 	}
 
+	// Report size of the module that was assembled for the entry point (after unreachable code was stripped)
+	// This goes to the error stream, so that it is kept apart from the errors and warnings printed to the standard output
+	if (generate_spirv && entry_point_name != nullptr)
+		print_spirv_module_report(entry_point_name, code);
+
 	if (output_file != nullptr)
 	{
 		std::ofstream(output_file, std::ios::binary).write(code.data(), code.size());
+
+		if (cache_index_file != nullptr)
+		{
+			std::vector<std::filesystem::path> dependencies = pp.included_files();
+			dependencies.insert(dependencies.begin(), source_file);
+			cache_index.update(cache_index_key, dependencies, pp.used_macro_definitions());
+
+			if (!cache_index.save(cache_index_file))
+				std::cout << "warning: Failed to write cache index file" << std::endl;
+		}
 	}
 	else
 	{